@@ -27,6 +27,9 @@ struct thread_regs
     uint32_t eflags;
     uint32_t esp;
     uint32_t ss;
+
+    /* FXSAVE area, allocated the first time the thread uses the FPU */
+    void *fpu;
 };
 
 struct irq_regs
@@ -55,6 +58,14 @@ struct irq_regs
     uint32_t user_ss;
 };
 
+/*
+ * Whether the interrupted code was running in ring 3
+ */
+static inline int irq_regs_user(struct irq_regs *regs)
+{
+    return (regs->cs & 3) == 3;
+}
+
 static inline void cpu_invalid_page(void *address)
 {
     __asm__ __volatile__("invlpg (%0)\n"
@@ -72,6 +83,12 @@ static inline void cpu_flush_tlb(void)
                           : "memory", "eax");
 }
 
+/* FIXME: Smp get current cpu id */
+static inline int cpu_id_get(void)
+{
+    return 0;
+}
+
 static inline void cpu_irq_enable(void)
 {
     __asm__ __volatile__ ("sti\n");
@@ -82,6 +99,14 @@ static inline void cpu_irq_disable(void)
     __asm__ __volatile__ ("cli\n");
 }
 
+static inline void cpu_cpuid(uint32_t leaf, uint32_t *eax, uint32_t *ebx,
+                             uint32_t *ecx, uint32_t *edx)
+{
+    __asm__ __volatile__ ("cpuid"
+                          : "=a"(*eax), "=b"(*ebx), "=c"(*ecx), "=d"(*edx)
+                          : "a"(leaf));
+}
+
 static inline void cpu_get_msr(uint32_t msr, uint32_t *eax, uint32_t *ebx)
 {
     __asm__ __volatile__ ("rdmsr" : "=a"(*eax), "=d"(*ebx) : "c"(msr));
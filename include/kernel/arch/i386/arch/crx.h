@@ -5,8 +5,14 @@
 
 # define CR0_PAGE 0x80000000
 # define CR0_PM 0x1
+# define CR0_MP 0x2
+# define CR0_EM 0x4
+# define CR0_TS 0x8
+# define CR0_NE 0x20
 
 # define CR4_BIGPAGE 0x00000010
+# define CR4_OSFXSR 0x00000200
+# define CR4_OSXMMEXCPT 0x00000400
 
 static inline uint32_t cr0_get(void)
 {
@@ -0,0 +1,74 @@
+#ifndef ARCH_I386_FPU_H
+# define ARCH_I386_FPU_H
+
+# include <kernel/types.h>
+
+# include <arch/cpu.h>
+
+# define IRQ_DEVICE_NOT_AVAILABLE 7
+
+/* FXSAVE needs a 512 bytes area aligned on 16 bytes */
+# define FPU_STATE_SIZE 512
+# define FPU_STATE_ALIGN 16
+
+# define FPU_MXCSR_DEFAULT 0x1F80
+
+# define CPUID_EDX_FXSR (1 << 24)
+# define CPUID_EDX_SSE (1 << 25)
+
+struct cpu;
+struct thread;
+
+static inline void fpu_clts(void)
+{
+    __asm__ __volatile__("clts\n");
+}
+
+static inline void fpu_fxsave(void *area)
+{
+    __asm__ __volatile__("fxsave (%0)\n" : : "r" (area) : "memory");
+}
+
+static inline void fpu_fxrstor(void *area)
+{
+    __asm__ __volatile__("fxrstor (%0)\n" : : "r" (area) : "memory");
+}
+
+static inline void fpu_fnsave(void *area)
+{
+    __asm__ __volatile__("fnsave (%0)\n" : : "r" (area) : "memory");
+}
+
+static inline void fpu_frstor(void *area)
+{
+    __asm__ __volatile__("frstor (%0)\n" : : "r" (area) : "memory");
+}
+
+/*
+ * Enable the FPU (and SSE if available) on the cpu. The FPU is lazily
+ * switched: CR0.TS is set when a thread that does not own the FPU is
+ * scheduled, and the first FPU instruction traps into fpu_handler()
+ */
+void fpu_initialize(struct cpu *cpu);
+
+/*
+ * #NM handler, load the FPU state of the current thread
+ */
+void fpu_handler(struct irq_regs *regs);
+
+/*
+ * Called on context switch, trap the next FPU use if new is not the owner
+ */
+void fpu_switch(struct cpu *cpu, struct thread *new);
+
+/*
+ * Give to a forked thread a copy of its parent FPU state
+ */
+int fpu_duplicate(struct thread *dst, struct thread *src);
+
+/*
+ * Release the FPU state of a thread
+ */
+void fpu_release(struct thread *thread);
+
+#endif /* !ARCH_I386_FPU_H */
@@ -5,12 +5,14 @@
 
 # define MAX_IRQ_NUMBER 0xFF
 
+# define IRQ_DOUBLE_FAULT 8
 # define IRQ_PAGE_FAULT 14
 
 # define IRQ_SYSCALL 0x80
 
 # define INTERRUPT_GATE 0x8E00
 # define TRAP_GATE 0xEF00
+# define TASK_GATE 0x8500
 
 # define IRQ_USER_BEGIN 0x21
 # define IRQ_USER_END 0x2F
@@ -31,5 +33,6 @@ struct idt_entry
 } __attribute__ ((packed));
 
 void idt_initialize(void);
+void idt_add_task_gate(uint8_t num, uint16_t selector);
 
 #endif /* !I386_IDT_H */
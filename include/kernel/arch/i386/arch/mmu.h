@@ -13,6 +13,7 @@
 # define PT_USER PD_USER
 
 # define PAGE_SIZE 0x1000
+# define PAGE_SHIFT 12
 
 /* USER BEGIN IS 0x1000 so 0x0 is never mapped */
 # define USER_BEGIN 0x1000
@@ -10,6 +10,14 @@
 
 # define PIT_VALUE_MAX 65636
 
+/*
+ * System control port B: gate and output of the channel 2
+ */
+# define PIT_CTRL_PORT 0x61
+# define PIT_CTRL_GATE2 (1 << 0)
+# define PIT_CTRL_SPEAKER (1 << 1)
+# define PIT_CTRL_OUT2 (1 << 5)
+
 void pit_initialize(void);
 
 #endif /* !I386_PIT_H */
@@ -1,53 +1,281 @@
 #ifndef ARCH_I386_SPINLOCK_H
 # define ARCH_I386_SPINLOCK_H
 
+# include <kernel/config.h>
+
 # include <arch/cpu.h>
 
-# define SPINLOCK_INIT { 0, 0 }
+# ifdef CONFIG_SPINLOCK_STAT
+#  include <arch/tsc.h>
+# endif /* !CONFIG_SPINLOCK_STAT */
+
+/*
+ * Ticket lock: a cpu takes the next ticket and spins until it is served, so
+ * the lock is granted in FIFO order
+ */
+struct ticket
+{
+    volatile uint16_t owner;
+    volatile uint16_t next;
+};
+
+# define TICKET_INIT { 0, 0 }
+
+# ifdef CONFIG_SPINLOCK_STAT
+#  define SPINLOCK_STAT_FIELDS                                              \
+    const char *name;                                                       \
+    int stat;                                                               \
+    uint64_t hold_start;
+#  define SPINLOCK_STAT_INIT(name) , name, -1, 0
+# else
+#  define SPINLOCK_STAT_FIELDS
+#  define SPINLOCK_STAT_INIT(name)
+# endif /* !CONFIG_SPINLOCK_STAT */
 
 typedef struct
 {
-    int lock;
-    uint32_t eflags;
+    struct ticket ticket;
+
+    SPINLOCK_STAT_FIELDS
 } spinlock_t;
 
-static inline void spinlock_init(spinlock_t *spin)
+/*
+ * Reader/writer lock: everyone queues on the ticket so writers are not
+ * starved, readers only hold it the time to register themselves
+ */
+typedef struct
 {
-    spin->lock = 0;
-    spin->eflags = 0;
-}
+    struct ticket queue;
+    volatile int readers;
 
-static inline void spinlock_lock(spinlock_t *spin)
+    SPINLOCK_STAT_FIELDS
+} rwlock_t;
+
+# define SPINLOCK_INIT { TICKET_INIT SPINLOCK_STAT_INIT(__FILE__) }
+# define RWLOCK_INIT { TICKET_INIT, 0 SPINLOCK_STAT_INIT(__FILE__) }
+
+/*
+ * Interrupt state of a cpu. It is saved by the outermost lock and restored
+ * when the last lock is released, so locks may be released in any order
+ */
+struct spinlock_irq
+{
+    int depth;
+    uint32_t eflags;
+};
+
+extern struct spinlock_irq spinlock_irq_state[];
+
+static inline void spinlock_irq_save(void)
 {
     uint32_t eflags = eflags_get();
+    struct spinlock_irq *irq;
+
+    cpu_irq_disable();
+
+    irq = &spinlock_irq_state[cpu_id_get()];
+
+    if (!irq->depth++)
+        irq->eflags = eflags;
+}
+
+static inline void spinlock_irq_restore(int restore)
+{
+    struct spinlock_irq *irq = &spinlock_irq_state[cpu_id_get()];
+
+    if (!--irq->depth && restore)
+        eflags_set(irq->eflags);
+}
 
-    __asm__ __volatile__ ("cli\n"
-                          "1:\n"
-                          "mov $0x1, %%eax\n"
-                          "lock xchg (%0), %%eax\n"
-                          "test %%eax, %%eax\n"
-                          "jnz 1b\n"
+/*
+ * Whether the local cpu holds any lock
+ */
+static inline int spinlock_held(void)
+{
+    return spinlock_irq_state[cpu_id_get()].depth != 0;
+}
+
+static inline uint32_t ticket_lock(struct ticket *ticket)
+{
+    uint16_t mine = 1;
+    uint32_t spins = 0;
+
+    __asm__ __volatile__ ("lock xaddw %0, %1\n"
+                          : "+r" (mine), "+m" (ticket->next)
                           :
-                          : "b" (&spin->lock)
-                          : "memory", "eax");
+                          : "memory");
+
+    while (ticket->owner != mine)
+    {
+        __asm__ __volatile__ ("pause\n" : : : "memory");
+        ++spins;
+    }
 
-    spin->eflags = eflags;
+    return spins;
 }
 
-static inline void spinlock_unlock_no_restore(spinlock_t *spin)
+static inline void ticket_unlock(struct ticket *ticket)
 {
-    __asm__ __volatile__ ("mov $0x0, %%eax\n"
-                          "lock xchg (%0), %%eax\n"
+    __asm__ __volatile__ ("lock incw %0\n"
+                          : "+m" (ticket->owner)
                           :
-                          : "b" (&spin->lock)
-                          : "memory", "eax");
+                          : "memory");
+}
+
+# ifdef CONFIG_SPINLOCK_STAT
+
+/*
+ * Account an acquisition of the lock class name, after spins iterations
+ */
+void spinlock_stat_acquired(const char *name, int *stat, uint32_t spins);
+
+/*
+ * Account a lock of class stat held during cycles
+ */
+void spinlock_stat_released(int stat, uint64_t cycles);
+
+/*
+ * Print the statistics of every lock class on the console
+ */
+void spinlock_stat_dump(void);
+
+#  define spinlock_stat_lock(l, spins)                                      \
+    do {                                                                    \
+        spinlock_stat_acquired((l)->name, &(l)->stat, (spins));             \
+        (l)->hold_start = tsc_read();                                       \
+    } while (0)
+
+#  define spinlock_stat_unlock(l)                                           \
+    spinlock_stat_released((l)->stat, tsc_read() - (l)->hold_start)
+
+#  define spinlock_stat_read_lock(l, spins)                                 \
+    spinlock_stat_acquired((l)->name, &(l)->stat, (spins))
+
+#  define spinlock_init(spin) __spinlock_init((spin), __FILE__ ": " #spin)
+#  define rwlock_init(rw) __rwlock_init((rw), __FILE__ ": " #rw)
+
+# else
+
+#  define spinlock_stat_lock(l, spins) ((void)(spins))
+#  define spinlock_stat_unlock(l)
+#  define spinlock_stat_read_lock(l, spins) ((void)(spins))
+
+#  define spinlock_init(spin) __spinlock_init((spin), NULL)
+#  define rwlock_init(rw) __rwlock_init((rw), NULL)
+
+# endif /* !CONFIG_SPINLOCK_STAT */
+
+static inline void __spinlock_init(spinlock_t *spin, const char *name)
+{
+    (void)name;
+
+    spin->ticket.owner = 0;
+    spin->ticket.next = 0;
+
+# ifdef CONFIG_SPINLOCK_STAT
+    spin->name = name;
+    spin->stat = -1;
+    spin->hold_start = 0;
+# endif /* !CONFIG_SPINLOCK_STAT */
+}
+
+static inline void spinlock_lock(spinlock_t *spin)
+{
+    uint32_t spins;
+
+    spinlock_irq_save();
+
+    spins = ticket_lock(&spin->ticket);
+
+    spinlock_stat_lock(spin, spins);
+}
+
+static inline void spinlock_unlock_no_restore(spinlock_t *spin)
+{
+    spinlock_stat_unlock(spin);
+
+    ticket_unlock(&spin->ticket);
+
+    spinlock_irq_restore(0);
 }
 
 static inline void spinlock_unlock(spinlock_t *spin)
 {
-    spinlock_unlock_no_restore(spin);
+    spinlock_stat_unlock(spin);
+
+    ticket_unlock(&spin->ticket);
+
+    spinlock_irq_restore(1);
+}
+
+static inline void __rwlock_init(rwlock_t *rw, const char *name)
+{
+    (void)name;
+
+    rw->queue.owner = 0;
+    rw->queue.next = 0;
+    rw->readers = 0;
+
+# ifdef CONFIG_SPINLOCK_STAT
+    rw->name = name;
+    rw->stat = -1;
+    rw->hold_start = 0;
+# endif /* !CONFIG_SPINLOCK_STAT */
+}
+
+static inline void rwlock_read_lock(rwlock_t *rw)
+{
+    uint32_t spins;
+
+    spinlock_irq_save();
+
+    spins = ticket_lock(&rw->queue);
+
+    __asm__ __volatile__ ("lock incl %0\n"
+                          : "+m" (rw->readers)
+                          :
+                          : "memory");
+
+    ticket_unlock(&rw->queue);
+
+    spinlock_stat_read_lock(rw, spins);
+}
+
+static inline void rwlock_read_unlock(rwlock_t *rw)
+{
+    __asm__ __volatile__ ("lock decl %0\n"
+                          : "+m" (rw->readers)
+                          :
+                          : "memory");
+
+    spinlock_irq_restore(1);
+}
+
+static inline void rwlock_write_lock(rwlock_t *rw)
+{
+    uint32_t spins;
+
+    spinlock_irq_save();
+
+    spins = ticket_lock(&rw->queue);
+
+    /* New readers are queued behind us, wait for the current ones */
+    while (rw->readers)
+    {
+        __asm__ __volatile__ ("pause\n" : : : "memory");
+        ++spins;
+    }
+
+    spinlock_stat_lock(rw, spins);
+}
+
+static inline void rwlock_write_unlock(rwlock_t *rw)
+{
+    spinlock_stat_unlock(rw);
+
+    ticket_unlock(&rw->queue);
 
-    eflags_set(spin->eflags);
+    spinlock_irq_restore(1);
 }
 
 #endif /* !ARCH_I386_SPINLOCK_H */
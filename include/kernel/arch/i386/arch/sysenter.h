@@ -0,0 +1,45 @@
+#ifndef ARCH_I386_SYSENTER_H
+# define ARCH_I386_SYSENTER_H
+
+# include <arch/cpu.h>
+
+# define MSR_SYSENTER_CS 0x174
+# define MSR_SYSENTER_ESP 0x175
+# define MSR_SYSENTER_EIP 0x176
+
+# define CPUID_EDX_SEP (1 << 11)
+
+struct cpu;
+
+/*
+ * Fast system call entry point (see sysenter_entry.S for the calling convention)
+ */
+void sysenter_entry(void);
+
+/*
+ * Tell if the cpu supports sysenter/sysexit. Early Pentium Pro advertise SEP
+ * without implementing it
+ */
+static inline int sysenter_supported(void)
+{
+    uint32_t eax, ebx, ecx, edx;
+    uint32_t family, model, stepping;
+
+    cpu_cpuid(1, &eax, &ebx, &ecx, &edx);
+
+    if (!(edx & CPUID_EDX_SEP))
+        return 0;
+
+    family = (eax >> 8) & 0xF;
+    model = (eax >> 4) & 0xF;
+    stepping = eax & 0xF;
+
+    return !(family == 6 && model < 3 && stepping < 3);
+}
+
+/*
+ * Program the sysenter MSRs of the cpu
+ */
+void sysenter_initialize(struct cpu *cpu);
+
+#endif /* !ARCH_I386_SYSENTER_H */
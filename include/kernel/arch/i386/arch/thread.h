@@ -7,9 +7,10 @@
 # define THREAD_STACK_BASE 0xBFFFE000
 
 int i386_thread_create(struct process *p, struct thread *t, uintptr_t eip,
-                       int argc, char *argv[], int deep_argv_copy);
+                       int argc, char *argv[], int flags);
 int i386_thread_duplicate(struct thread *thread, struct irq_regs *regs);
 int i386_thread_current(void);
 int i386_thread_save_state(struct thread *thread, struct irq_regs *regs);
+int i386_thread_destroy(struct thread *thread);
 
 #endif /* !ARCH_I386_THREAD_H */
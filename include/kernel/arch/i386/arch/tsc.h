@@ -0,0 +1,45 @@
+#ifndef ARCH_I386_TSC_H
+# define ARCH_I386_TSC_H
+
+# include <kernel/types.h>
+
+# include <arch/cpu.h>
+
+# define CPUID_EDX_TSC (1 << 4)
+
+/*
+ * Duration of the calibration against the PIT in milliseconds
+ */
+# define TSC_CALIBRATE_MS 10
+
+static inline int tsc_supported(void)
+{
+    uint32_t eax, ebx, ecx, edx;
+
+    cpu_cpuid(1, &eax, &ebx, &ecx, &edx);
+
+    return !!(edx & CPUID_EDX_TSC);
+}
+
+static inline uint64_t tsc_read(void)
+{
+    uint32_t lo, hi;
+
+    __asm__ __volatile__ ("rdtsc" : "=a"(lo), "=d"(hi));
+
+    return ((uint64_t)hi << 32) | lo;
+}
+
+/*
+ * Measure the frequency of the TSC in kHz using the channel 2 of the PIT.
+ * The value of the TSC at the end of the measure is stored in base.
+ * Return 0 if there isn't any usable TSC
+ */
+uint32_t tsc_calibrate(uint64_t *base);
+
+/*
+ * Compute the multiplier so that ns = (cycles * mult) >> shift
+ */
+uint32_t tsc_mult(uint32_t khz, uint32_t shift);
+
+#endif /* !ARCH_I386_TSC_H */
@@ -23,6 +23,9 @@ struct cpu
 struct cpu_glue
 {
     int (*init)(struct cpu *);
+
+    /* Make a remote cpu run scheduler_preempt() (IPI) */
+    int (*resched)(struct cpu *);
 };
 
 extern struct cpu_glue cpu_glue_dispatcher;
@@ -36,10 +39,9 @@ void cpu_start(void);
  */
 struct cpu *cpu_get(int id);
 
-/* FIXME: Smp get current cpu id */
-static inline int cpu_id_get(void)
-{
-    return 0;
-}
+/*
+ * Copy the statistics of at most count cpus, return the number copied
+ */
+int cpu_stats_collect(struct sched_cpu_stats *stats, int count);
 
 #endif /* !CPU_H */
@@ -3,6 +3,7 @@
 
 # define EPERM 1 /* Operation not permitted */
 # define ENOENT 2 /* No such file or directory */
+# define ESRCH 3 /* No such process */
 # define EBADF 9 /* Bad file number */
 # define ECHILD 10 /* No child processes */
 # define EAGAIN 11 /* Try again */
@@ -17,11 +18,13 @@
 # define EINVAL 22 /* Invalid argument */
 # define EMFILE 24 /* Too many open files */
 # define ENOTTY 25 /* Not a typewriter */
+# define EPIPE 32 /* Broken pipe */
 # define ENAMETOOLONG 36 /* File name too long */
 # define ENOSYS 38 /* Function not implemented */
 # define EBADE 52 /* Invalid exchange */
 # define ENODATA 61 /* No data available */
 # define ELIBBAD 80 /* Accessing a corrupted shared library */
+# define ETIMEDOUT 110 /* Connection timed out */
 # define EDQUOT 122 /* Quota exceeded */
 
 #endif /* !ERRNO_H */
@@ -0,0 +1,293 @@
+/*
+ * zOS
+ * Copyright (C) 2015 Baptiste Covolato
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zOS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file    include/kernel/fs/aio.h
+ * \brief   Asynchronous VFS operations submitted through shared rings
+ *
+ * \author  Baptiste Covolato
+ */
+
+#ifndef FS_AIO_H
+# define FS_AIO_H
+
+# include <kernel/zos.h>
+# include <kernel/types.h>
+# include <kernel/klist.h>
+
+# include <kernel/proc/wait_queue.h>
+
+# include <arch/spinlock.h>
+# include <arch/mmu.h>
+
+/**
+ * \def AIO_OP_NOP
+ * Complete without doing anything
+ *
+ * \def AIO_OP_OPEN
+ * vfs_open(path, flags, mode)
+ *
+ * \def AIO_OP_CLOSE
+ * vfs_close(fd)
+ *
+ * \def AIO_OP_READ
+ * vfs_read(fd, buf, size)
+ *
+ * \def AIO_OP_WRITE
+ * vfs_write(fd, buf, size)
+ *
+ * \def AIO_OP_STAT
+ * vfs_stat(path, buf)
+ *
+ * \def AIO_OP_FSTAT
+ * vfs_fstat(fd, buf)
+ *
+ * \def AIO_OP_GETDIRENT
+ * vfs_getdirent(fd, buf, flags), flags is the index of the entry
+ */
+# define AIO_OP_NOP 0
+# define AIO_OP_OPEN 1
+# define AIO_OP_CLOSE 2
+# define AIO_OP_READ 3
+# define AIO_OP_WRITE 4
+# define AIO_OP_STAT 5
+# define AIO_OP_FSTAT 6
+# define AIO_OP_GETDIRENT 7
+
+/**
+ *  \brief  Number of entries of the submission queue (must be a power of 2)
+ */
+# define AIO_SQ_ENTRIES 64
+
+/**
+ *  \brief  Number of entries of the completion queue (must be a power of 2),
+ *          it also bounds the number of requests in flight
+ */
+# define AIO_CQ_ENTRIES 128
+
+/**
+ *  \brief  Size of the memory shared with the process
+ */
+# define AIO_RING_SIZE PAGE_SIZE
+
+/**
+ *  \brief  Number of kernel threads that execute the requests of a process
+ */
+# define AIO_WORKERS 4
+
+/**
+ *  \brief  Longest path of AIO_OP_OPEN and AIO_OP_STAT, with its terminating
+ *          null byte
+ */
+# define AIO_PATH_MAX PAGE_SIZE
+
+/**
+ *  \brief  Submission queue entry, written by the process
+ */
+struct aio_sqe {
+    /**
+     *  \brief  One of AIO_OP_*
+     */
+    int op;
+
+    int fd;
+
+    const char *path;
+
+    void *buf;
+
+    size_t size;
+
+    /**
+     *  \brief  Open flags, or index of the entry for AIO_OP_GETDIRENT
+     */
+    int flags;
+
+    mode_t mode;
+
+    /**
+     *  \brief  Given back untouched in the completion
+     */
+    void *data;
+};
+
+/**
+ *  \brief  Completion queue entry, written by the kernel
+ */
+struct aio_cqe {
+    /**
+     *  \brief  The data of the request
+     */
+    void *data;
+
+    /**
+     *  \brief  What the operation returned
+     */
+    int res;
+};
+
+/**
+ *  \brief  Layout of the memory shared with the process. The indexes are
+ *          free running, the entry of an index i is at i % ENTRIES
+ */
+struct aio_ring {
+    /**
+     *  \brief  Next submission read by the kernel
+     */
+    volatile uint32_t sq_head;
+
+    /**
+     *  \brief  Next submission written by the process
+     */
+    volatile uint32_t sq_tail;
+
+    /**
+     *  \brief  Next completion read by the process
+     */
+    volatile uint32_t cq_head;
+
+    /**
+     *  \brief  Next completion written by the kernel
+     */
+    volatile uint32_t cq_tail;
+
+    struct aio_sqe sq[AIO_SQ_ENTRIES];
+
+    struct aio_cqe cq[AIO_CQ_ENTRIES];
+};
+
+/**
+ *  \brief  A submission copied out of the ring
+ */
+struct aio_request {
+    struct aio_sqe sqe;
+
+    /**
+     *  \brief  List of pending or free requests
+     */
+    struct klist list;
+};
+
+/**
+ *  \brief  Asynchronous VFS context of a process
+ */
+struct aio {
+    /**
+     *  \brief  The shared ring, mapped in the kernel address space
+     */
+    struct aio_ring *ring;
+
+    /**
+     *  \brief  Address of the ring in the process
+     */
+    vaddr_t uaddr;
+
+    /**
+     *  \brief  Requests waiting for a worker
+     */
+    struct klist pending;
+
+    /**
+     *  \brief  Unused requests
+     */
+    struct klist free;
+
+    /**
+     *  \brief  Requests submitted and not completed yet
+     */
+    int inflight;
+
+    /**
+     *  \brief  References held by the process and by each worker, the
+     *          context is freed with the last one
+     */
+    int ref;
+
+    /**
+     *  \brief  Set once the process exits or executes a new program
+     */
+    int dead;
+
+    /**
+     *  \brief  Protect the lists, the counters and the kernel side indexes
+     */
+    spinlock_t lock;
+
+    /**
+     *  \brief  Where the workers wait for a request
+     */
+    struct wait_queue work;
+
+    /**
+     *  \brief  Where the threads of the process wait for completions
+     */
+    struct wait_queue complete;
+
+    struct aio_request requests[AIO_CQ_ENTRIES];
+};
+
+struct thread;
+struct process;
+
+/**
+ *  \brief  Create the rings of the process of \a t and start its workers.
+ *          The workers run in kernel mode inside the process, with the
+ *          credentials of \a t
+ *
+ *  \param  t       The calling thread
+ *  \param  uaddr   Filled with the address of the ring in the process
+ *
+ *  \return 0: Everything went well
+ *  \return -EBUSY: The process already has rings
+ *  \return -ENOMEM: Not enough memory
+ *  \return -EAGAIN: No worker could be created
+ */
+int aio_setup(struct thread *t, vaddr_t *uaddr);
+
+/**
+ *  \brief  Hand the new submissions of the ring to the workers, and wait for
+ *          completions
+ *
+ *  \param  t               The calling thread
+ *  \param  to_submit       Maximum number of submissions to take
+ *  \param  min_complete    Wait until that many completions are available
+ *                          or nothing is in flight anymore
+ *
+ *  \return The number of submissions taken, which is less than \a to_submit
+ *          if the completion queue has no room for more requests
+ *  \return -EINVAL: The process has no rings
+ */
+int aio_enter(struct thread *t, int to_submit, int min_complete);
+
+/**
+ *  \brief  Release the rings of a process whose threads are exiting, the
+ *          workers must already be zombies. The context stays until the
+ *          last worker is destroyed
+ *
+ *  \param  p   The process
+ */
+void aio_exit(struct process *p);
+
+/**
+ *  \brief  Drop a reference on a context, called when a worker is destroyed
+ *
+ *  \param  aio The context
+ */
+void aio_put(struct aio *aio);
+
+#endif /* !FS_AIO_H */
@@ -29,17 +29,128 @@
 
 # include <kernel/types.h>
 # include <kernel/klist.h>
+# include <kernel/htable.h>
 
 # include <kernel/proc/wait_queue.h>
 
 # include <arch/spinlock.h>
+# include <arch/mmu.h>
 
 /**
  *  \brief  Maximum size for a device name in bytes
  */
 # define CHANNEL_NAME_MAXL 20
 
+/**
+ *  \brief  Size of the shared memory ring of a slave, in bytes
+ */
+# define CHANNEL_RING_SIZE (2 * PAGE_SIZE)
+
+/**
+ *  \brief  Alignment of the buffers allocated in a ring
+ */
+# define CHANNEL_RING_ALIGN 16
+
+/**
+ *  \brief  Maximum number of messages of a batch
+ */
+# define CHANNEL_BATCH_MAX 16
+
+/**
+ *  \brief  Maximum number of messages and of payload bytes queued on a
+ *          master channel
+ */
+# define CHANNEL_MAX_MSGS 256
+# define CHANNEL_MAX_BYTES (64 * PAGE_SIZE)
+
+/**
+ *  \brief  Maximum number of messages and of payload bytes queued on a
+ *          slave, and share of the queue of the master a slave can use
+ */
+# define CHANNEL_SLAVE_MAX_MSGS 32
+# define CHANNEL_SLAVE_MAX_BYTES (8 * PAGE_SIZE)
+
+/**
+ *  \brief  Slave id of the messages a master sends to the kernel itself,
+ *          they are given to the control handler of the channel
+ */
+# define CHANNEL_CONTROL_ID 0xffff
+
 struct file;
+struct channel;
+struct channel_slave;
+
+/**
+ *  \brief  Handler of the control messages of a channel
+ *
+ *  \param  data    The data given to channel_control_set()
+ *  \param  buf     The message, starting with its header
+ *  \param  size    The size of the message
+ */
+typedef void (*channel_control_t)(void *data, void *buf, size_t size);
+
+/**
+ *  \brief  Bounds and accounting of the messages queued on a channel or a
+ *          slave. A message bigger than the byte limit is accepted when
+ *          nothing is queued, so that it can always make progress
+ */
+struct channel_limit {
+    /**
+     *  \brief  Maximum number of messages queued
+     */
+    size_t max_msgs;
+
+    /**
+     *  \brief  Maximum number of payload bytes queued
+     */
+    size_t max_bytes;
+
+    /**
+     *  \brief  Number of messages queued
+     */
+    size_t msgs;
+
+    /**
+     *  \brief  Number of payload bytes queued
+     */
+    size_t bytes;
+
+    /**
+     *  \brief  Highest number of messages queued so far
+     */
+    size_t high_msgs;
+
+    /**
+     *  \brief  Highest number of payload bytes queued so far
+     */
+    size_t high_bytes;
+
+    /**
+     *  \brief  Number of sends that found the queue full
+     */
+    uint32_t full;
+
+    /**
+     *  \brief  Senders waiting for room
+     */
+    struct wait_queue space;
+};
+
+/**
+ *  \brief  A message buffer of a batch
+ */
+struct channel_iovec {
+    /**
+     *  \brief  The message
+     */
+    void *buf;
+
+    /**
+     *  \brief  The size of the message, or of the buffer when receiving. It
+     *          is updated with the size received
+     */
+    size_t size;
+};
 
 /**
  *  \brief  File operation to manipulate a slave channel
@@ -70,12 +181,125 @@ struct channel_message {
      */
     size_t off;
 
+    /**
+     *  \brief  The payload, stored right after the message unless the
+     *          message is the request of a channel_call()
+     */
+    void *data;
+
+    /**
+     *  \brief  Set when the message belongs to a channel_call(), it lives on
+     *          the stack of the caller and must not be freed
+     */
+    int call;
+
+    /**
+     *  \brief  The queue the message is accounted in, NULL if it is not
+     */
+    struct channel_limit *limit;
+
+    /**
+     *  \brief  The slave whose share of the master queue the message uses,
+     *          NULL if it is sent by the master or if the slave is closed
+     */
+    struct channel_slave *sender;
+
     /**
      *  \brief  List of message
      */
     struct klist list;
 };
 
+/**
+ *  \brief  Shared memory of a slave, mapped in the kernel and in the process
+ *          of the master. Payloads are written there in place and the master
+ *          reads them, or writes its results, in place. The buffers are
+ *          released in the order they were allocated, like a SPSC ring
+ */
+struct channel_ring {
+    /**
+     *  \brief  Address of the ring in the kernel
+     */
+    char *kaddr;
+
+    /**
+     *  \brief  Address of the ring in the master process
+     */
+    vaddr_t uaddr;
+
+    /**
+     *  \brief  The address space of the master the ring is mapped in, NULL
+     *          once the master closed the channel, exited or executed a new
+     *          program. Protected by the lock of the ring
+     */
+    struct as *as;
+
+    /**
+     *  \brief  Next free byte
+     */
+    size_t head;
+
+    /**
+     *  \brief  First byte still in use
+     */
+    size_t tail;
+
+    /**
+     *  \brief  End of the used bytes when head wrapped around
+     */
+    size_t wrap;
+
+    /**
+     *  \brief  Number of buffers in use
+     */
+    int used;
+
+    /**
+     *  \brief  Protects the ring indexes
+     */
+    spinlock_t lock;
+};
+
+/**
+ *  \brief  A synchronous request of a slave waiting for its reply
+ */
+struct channel_call {
+    /**
+     *  \brief  The request, queued on the master channel
+     */
+    struct channel_message request;
+
+    /**
+     *  \brief  The thread waiting for the reply
+     */
+    struct thread *thread;
+
+    /**
+     *  \brief  The reply is copied there
+     */
+    void *reply;
+
+    /**
+     *  \brief  Size of the reply buffer
+     */
+    size_t reply_size;
+
+    /**
+     *  \brief  Size of the reply, or a negative error code
+     */
+    int ret;
+
+    /**
+     *  \brief  Set once the call is completed
+     */
+    volatile int done;
+
+    /**
+     *  \brief  List of pending calls of the slave, in request order
+     */
+    struct klist list;
+};
+
 /**
  *  \brief  Represents a master channel
  */
@@ -95,6 +319,12 @@ struct channel {
      */
     struct process *proc;
 
+    /**
+     *  \brief  Set once the address space of the owner is gone, no ring can
+     *          be mapped in it anymore. Protected by the channel table lock
+     */
+    int detached;
+
     /**
      *  \brief  Used by a master to wait on the channel
      */
@@ -110,16 +340,51 @@ struct channel {
      */
     struct klist input;
 
+    /**
+     *  \brief  Bounds of the input, slaves block when it is full
+     */
+    struct channel_limit limit;
+
+    /**
+     *  \brief  Number of slaves blocked until the input has room, the
+     *          channel is freed once it is closed and unused
+     */
+    int users;
+
+    /**
+     *  \brief  Set when the master closes the channel, protected by the lock
+     *          of the master
+     */
+    int closed;
+
     /**
      *  \brief  List of slaves
      */
     struct klist slaves;
 
     /**
-     *  \brief  List of channel
+     *  \brief  Node in the table of channels, indexed by name
      */
-    struct klist list;
+    struct htable_node hash;
 
+    /**
+     *  \brief  Handler of the messages sent to CHANNEL_CONTROL_ID, or NULL
+     */
+    channel_control_t control;
+
+    void *control_data;
+
+    /**
+     *  \brief  Poll events of the device served by the channel, as last
+     *          announced by its driver
+     */
+    volatile uint32_t ready;
+
+    /**
+     *  \brief  Notified when the driver announces its readiness, watched by
+     *          the sets polling the device
+     */
+    struct wait_queue ready_wait;
 };
 
 /**
@@ -156,6 +421,28 @@ struct channel_slave {
      */
     struct klist input;
 
+    /**
+     *  \brief  Bounds of the input, the master gets -EAGAIN when it is full.
+     *          Replies that do not complete a call are bounded as well
+     */
+    struct channel_limit limit;
+
+    /**
+     *  \brief  Share of the input of the master used by the slave, protected
+     *          by the lock of the master
+     */
+    struct channel_limit credit;
+
+    /**
+     *  \brief  Calls waiting for a reply, the master replies in order
+     */
+    struct klist calls;
+
+    /**
+     *  \brief  Shared memory with the master, NULL if none
+     */
+    struct channel_ring *ring;
+
     /**
      *  \brief  List of slaves related to a channel
      */
@@ -211,9 +498,61 @@ int channel_master_read(struct channel *channel, void *buf, size_t size);
  *
  *  \return The size written if everything went well
  *  \return -ENOMEM: Not enough memory
+ *  \return -EAGAIN: The input of the slave is full, the master never waits
+ *          for a slave
  */
 int channel_master_write(struct channel *channel, void *buf, size_t size);
 
+/**
+ *  \brief  Reply to a slave, then wait for the next message of a master
+ *          channel. When the reply wakes up a slave blocked in
+ *          channel_call(), the rest of the timeslice is handed to it
+ *
+ *  \param  channel     The channel
+ *  \param  reply       The reply, starting with a msg_header. Nothing is
+ *                      sent if \a reply_size is 0, the reply is dropped if
+ *                      the slave is closed or if it completes no call
+ *                      and the input of the slave is full
+ *  \param  reply_size  The size of the reply
+ *  \param  buf         This buffer will be filled with the next message
+ *  \param  size        The size of \a buf
+ *
+ *  \return The size read if everything went well
+ *  \return -EINVAL: Invalid reply
+ */
+int channel_master_reply_wait(struct channel *channel, void *reply,
+                              size_t reply_size, void *buf, size_t size);
+
+/**
+ *  \brief  Send several replies, then receive every message queued on a
+ *          master channel, blocking only if there is none
+ *
+ *  \param  channel The channel
+ *  \param  replies The replies, each starting with a msg_header. Replies to
+ *                  closed slaves or to full slaves are dropped
+ *  \param  nreply  The number of replies
+ *  \param  msgs    The buffers filled with one message each
+ *  \param  nmsg    The number of buffers, at least 1
+ *
+ *  \return The number of messages received if everything went well
+ *  \return -EINVAL: Invalid reply or number of buffers
+ */
+int channel_master_reply_wait_batch(struct channel *channel,
+                                    struct channel_iovec *replies,
+                                    int nreply, struct channel_iovec *msgs,
+                                    int nmsg);
+
+/**
+ *  \brief  Let the kernel handle the messages the master of \a channel sends
+ *          to CHANNEL_CONTROL_ID
+ *
+ *  \param  channel The channel
+ *  \param  control The handler, NULL to reject these messages again
+ *  \param  data    Given to the handler
+ */
+void channel_control_set(struct channel *channel, channel_control_t control,
+                         void *data);
+
 /**
  *  \brief  Close a master channel
  *
@@ -265,7 +604,8 @@ int channel_open_from_name(const char *name, struct file *file,
 int channel_slave_read(struct channel_slave *slave, void *buf, size_t size);
 
 /**
- *  \brief  Write to a slave channel
+ *  \brief  Write to a slave channel, wait while the input of the master or
+ *          the share of the slave is full
  *
  *  \param  slave   The slave channel you want to write to
  *  \param  buf     The data you want to write
@@ -273,9 +613,71 @@ int channel_slave_read(struct channel_slave *slave, void *buf, size_t size);
  *
  *  \return The size written if everything went well
  *  \return -ENOMEM: Not enough memory
+ *  \return -EPIPE: The channel has been closed
  */
 int channel_slave_write(struct channel_slave *slave, void *buf, size_t size);
 
+/**
+ *  \brief  Send a request on a slave channel and wait for the reply of the
+ *          master. Neither the request nor the reply is allocated or
+ *          queued: the master reads the request from \a buf and replies
+ *          straight into \a reply. If the master waits for a message, it
+ *          runs right away for the rest of the caller's timeslice
+ *
+ *  \param  slave       The slave channel
+ *  \param  buf         The request
+ *  \param  size        The size of the request
+ *  \param  reply       This buffer will be filled with the reply
+ *  \param  reply_size  The size of \a reply
+ *
+ *  \return The size of the reply if everything went well
+ *  \return -EPIPE: The channel has been closed
+ */
+int channel_call(struct channel_slave *slave, void *buf, size_t size,
+                 void *reply, size_t reply_size);
+
+/**
+ *  \brief  Create the shared memory ring of a slave
+ *
+ *  \param  slave   The slave
+ *
+ *  \return 0: Everything went well
+ *  \return -ENOMEM: Not enough memory
+ *  \return -EPIPE: The master is gone
+ */
+int channel_ring_create(struct channel_slave *slave);
+
+/**
+ *  \brief  Forget the rings mapped in a process that exits or executes a new
+ *          program, their mappings go away with its address space
+ *
+ *  \param  p   The process
+ */
+void channel_process_exit(struct process *p);
+
+/**
+ *  \brief  Allocate a buffer in the ring of a slave
+ *
+ *  \param  slave   The slave
+ *  \param  size    The size of the buffer
+ *  \param  uaddr   Filled with the address of the buffer for the master
+ *
+ *  \return The kernel address of the buffer, NULL if the slave has no ring
+ *          or the ring is full
+ */
+void *channel_ring_alloc(struct channel_slave *slave, size_t size,
+                         void **uaddr);
+
+/**
+ *  \brief  Release a buffer allocated in the ring of a slave
+ *
+ *  \param  slave   The slave
+ *  \param  buf     The buffer returned by channel_ring_alloc()
+ *  \param  size    The size of the buffer
+ */
+void channel_ring_release(struct channel_slave *slave, void *buf,
+                          size_t size);
+
 /**
  *  \brief  Close a slave channel
  *
@@ -4,12 +4,39 @@
 # include <kernel/types.h>
 
 # include <kernel/fs/vfs.h>
+# include <kernel/fs/vfs/dcache.h>
+# include <kernel/fs/vfs/acache.h>
+
+# include <arch/spinlock.h>
+
+/**
+ *  \brief  Number of idle slaves kept by a file system instance
+ */
+# define FIU_SLAVE_POOL_SIZE 8
+
+/**
+ *  \brief  Readahead window of a file, in pages, after its first sequential
+ *          read. It doubles on each sequential read up to FIU_RA_MAX
+ */
+# define FIU_RA_MIN 4
+# define FIU_RA_MAX 32
+
+/**
+ *  \brief  Maximum number of pages waiting to be read ahead
+ */
+# define FIU_RA_QUEUE 64
+
+/**
+ *  \brief  The last page of a file is not known
+ */
+# define FIU_RA_NO_EOF ((uint32_t)-1)
 
 extern struct fs_super_operation fiu_fs_super_ops;
 extern struct fs_operation fiu_fs_ops;
 extern struct file_operation fiu_f_ops;
 
 struct channel;
+struct channel_slave;
 
 /**
  *  \brief  Private data used for FIU registered file systems
@@ -34,6 +61,35 @@ struct fiu_fs_instance {
      *  \brief  The channel used to communicate with the fs instance
      */
     struct channel *channel;
+
+    /**
+     *  \brief  Idle slaves of the channel, used for the operations that are
+     *          not bound to a file. A slave is used by one request at a
+     *          time so its id identifies the request
+     */
+    struct channel_slave *pool[FIU_SLAVE_POOL_SIZE];
+
+    /**
+     *  \brief  Number of slaves in the pool
+     */
+    int pool_count;
+
+    /**
+     *  \brief  Protects the pool
+     */
+    spinlock_t pool_lock;
+
+    /**
+     *  \brief  Lookups already answered by the instance, it invalidates them
+     *          with VFS_INVALIDATE
+     */
+    struct dcache dcache;
+
+    /**
+     *  \brief  Attributes of the inodes, kept for the lease granted by the
+     *          instance or until VFS_INVALIDATE
+     */
+    struct acache acache;
 };
 
 /**
@@ -55,6 +111,49 @@ struct fiu_file_private {
      *  \brief  Private data use reference counting for deallocation
      */
     int ref;
+
+    /**
+     *  \brief  Offset following the last read, a read starting there is
+     *          sequential
+     */
+    uint64_t ra_next;
+
+    /**
+     *  \brief  Number of pages read ahead of the offset, 0 while the reads
+     *          are random
+     */
+    uint32_t ra_window;
+
+    /**
+     *  \brief  First page that has not been queued for readahead
+     */
+    uint32_t ra_end;
+
+    /**
+     *  \brief  Last page of the file, the last one read shorter than a page,
+     *          or FIU_RA_NO_EOF. Used when the attributes are not cached
+     */
+    uint32_t ra_eof;
+
+    /**
+     *  \brief  Pages found in the cache thanks to readahead, and pages read
+     *          synchronously while reading sequentially
+     */
+    uint32_t ra_hits;
+    uint32_t ra_misses;
+};
+
+/**
+ *  \brief  A page waiting to be read ahead
+ */
+struct fiu_ra_request {
+    struct klist list;
+
+    struct fs_instance *fi;
+
+    ino_t inode;
+
+    uint32_t index;
 };
 
 /**
@@ -0,0 +1,262 @@
+/*
+ * zOS
+ * Copyright (C) 2015 Baptiste Covolato
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zOS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file    include/kernel/fs/poll.h
+ * \brief   Readiness notification over channels and user interrupts
+ *
+ * \author  Baptiste Covolato
+ */
+
+#ifndef FS_POLL_H
+# define FS_POLL_H
+
+# include <kernel/types.h>
+# include <kernel/klist.h>
+
+# include <kernel/proc/wait_queue.h>
+
+/**
+ * \def POLL_ADD
+ * Watch a new source
+ *
+ * \def POLL_DEL
+ * Stop watching a source
+ */
+# define POLL_ADD 1
+# define POLL_DEL 2
+
+/**
+ * \def POLL_SRC_FD
+ * The source is a file descriptor: a master or a slave channel, or a device
+ * whose driver announces its readiness
+ *
+ * \def POLL_SRC_IRQ
+ * The source is a user interrupt registered by the calling thread
+ */
+# define POLL_SRC_FD 0
+# define POLL_SRC_IRQ 1
+
+/**
+ * \def POLLIN
+ * A message can be read, the device has data, or the interrupt fired
+ *
+ * \def POLLHUP
+ * The source is gone
+ *
+ * \def POLLET
+ * Report the source once each time it is notified (edge triggered) instead
+ * of as long as it is ready (level triggered)
+ */
+# define POLLIN (1 << 0)
+# define POLLHUP (1 << 1)
+# define POLLET (1 << 31)
+
+/**
+ *  \brief  Maximum number of events returned by a wait
+ */
+# define POLL_MAX_EVENTS 32
+
+/**
+ *  \brief  Event exchanged with user space
+ */
+struct poll_event {
+    /**
+     *  \brief  Events watched, or events that occurred
+     */
+    uint32_t events;
+
+    /**
+     *  \brief  Value given back with the events of the source
+     */
+    void *data;
+};
+
+/**
+ *  \brief  A set of watched sources
+ */
+struct poll {
+    /**
+     *  \brief  Where the threads wait for an event
+     */
+    struct wait_queue wait;
+
+    /**
+     *  \brief  Set when a source is notified, cleared before a scan
+     */
+    volatile int notified;
+
+    /**
+     *  \brief  The sources watched
+     */
+    struct klist entries;
+
+    /**
+     *  \brief  Number of files referring to the set
+     */
+    int ref;
+
+    /**
+     *  \brief  Number of calls using the set, it is freed once it is closed
+     *          and unused
+     */
+    int users;
+
+    /**
+     *  \brief  Set when the last file referring to the set is closed
+     */
+    int closed;
+};
+
+/**
+ * \def POLL_KIND_SLAVE
+ * The entry watches a slave channel
+ *
+ * \def POLL_KIND_MASTER
+ * The entry watches a master channel
+ *
+ * \def POLL_KIND_DEVICE
+ * The entry watches a device, through the master channel of its driver
+ *
+ * \def POLL_KIND_IRQ
+ * The entry watches a user interrupt
+ */
+# define POLL_KIND_SLAVE 0
+# define POLL_KIND_MASTER 1
+# define POLL_KIND_DEVICE 2
+# define POLL_KIND_IRQ 3
+
+/**
+ *  \brief  A source watched by a set
+ */
+struct poll_entry {
+    /**
+     *  \brief  Hooked on the wait queue of the source
+     */
+    struct wait_queue_poller poller;
+
+    /**
+     *  \brief  The set
+     */
+    struct poll *poll;
+
+    /**
+     *  \brief  POLL_SRC_FD or POLL_SRC_IRQ
+     */
+    int type;
+
+    /**
+     *  \brief  The file descriptor or the interrupt number
+     */
+    int id;
+
+    /**
+     *  \brief  The channel, the slave or the thread that owns the interrupt
+     */
+    void *source;
+
+    /**
+     *  \brief  What the source is, one of the POLL_KIND_*
+     */
+    int kind;
+
+    /**
+     *  \brief  The event watched
+     */
+    struct poll_event event;
+
+    /**
+     *  \brief  Set by a notification, consumed by an edge triggered report
+     */
+    volatile int pending;
+
+    /**
+     *  \brief  List of entries of the set
+     */
+    struct klist list;
+};
+
+extern struct file_operation poll_f_ops;
+
+/**
+ *  \brief  Create a set of watched sources
+ *
+ *  \param  file    The file that will refer to the set
+ *
+ *  \return 0: Everything went well
+ *  \return -ENOMEM: Not enough memory
+ */
+int poll_create(struct file *file);
+
+/**
+ *  \brief  Add or remove a source of a set
+ *
+ *  \param  poll    The set
+ *  \param  op      POLL_ADD or POLL_DEL
+ *  \param  type    POLL_SRC_FD or POLL_SRC_IRQ
+ *  \param  id      The file descriptor or the interrupt number
+ *  \param  event   The events watched, for POLL_ADD
+ *
+ *  \return 0: Everything went well
+ *  \return -EBADF: The descriptor is neither a channel nor a device, or the
+ *                  set is closed
+ *  \return -EINVAL: The interrupt is not registered by the calling thread
+ *  \return -EEXIST: The source is already watched
+ *  \return -ENOENT: The source is not watched
+ */
+int poll_ctl(struct poll *poll, int op, int type, int id,
+             struct poll_event *event);
+
+/**
+ *  \brief  Wait for sources of a set to be ready
+ *
+ *  \param  poll    The set
+ *  \param  events  Filled with the ready sources
+ *  \param  max     The size of \a events
+ *  \param  block   Wait if no source is ready
+ *
+ *  \return The number of events filled
+ *  \return -EBADF: The set was closed
+ */
+int poll_wait(struct poll *poll, struct poll_event *events, int max,
+              int block);
+
+/**
+ *  \brief  Keep a set while a call uses it, must be called with the lock of
+ *          the descriptor table that holds the set
+ *
+ *  \param  poll    The set
+ */
+void poll_get(struct poll *poll);
+
+/**
+ *  \brief  Release a set kept by poll_get()
+ *
+ *  \param  poll    The set
+ */
+void poll_put(struct poll *poll);
+
+/**
+ *  \brief  Detach the sets watching a wait queue that is about to be
+ *          destroyed, they report POLLHUP for it
+ *
+ *  \param  queue   The wait queue
+ */
+void poll_detach(struct wait_queue *queue);
+
+#endif /* !FS_POLL_H */
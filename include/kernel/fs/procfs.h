@@ -0,0 +1,59 @@
+/*
+ * zOS
+ * Copyright (C) 2015 Baptiste Covolato
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zOS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file    include/kernel/fs/procfs.h
+ * \brief   Definition of function and structure related to the procfs file
+ *          system
+ *
+ * \author  Baptiste Covolato
+ */
+
+#ifndef FS_PROCFS_H
+# define FS_PROCFS_H
+
+#include <arch/spinlock.h>
+
+/**
+ *  \brief  Maximum size of a procfs file, longer contents are truncated
+ */
+# define PROCFS_BUF_SIZE 0x4000
+
+/**
+ *  \brief  General information about the procfs
+ */
+struct procfs {
+    /**
+     *  \brief  The procfs can be mounted only once
+     */
+    int mounted;
+
+    /**
+     *  \brief  Avoid races on the mounted field
+     */
+    spinlock_t lock;
+};
+
+/**
+ *  \brief  Initialize and register the procfs file system
+ *
+ *  \return 0: Everything went well
+ */
+int procfs_initialize(void);
+
+#endif /* !FS_PROCFS_H */
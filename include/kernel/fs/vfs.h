@@ -28,6 +28,7 @@
 # define FS_VFS_H
 
 # include <kernel/klist.h>
+# include <kernel/htable.h>
 # include <kernel/types.h>
 
 # include <arch/spinlock.h>
@@ -77,6 +78,20 @@
  *
  * \def VFS_FS_CREATE
  * VFS fs create message identifier
+ *
+ * \def VFS_INVALIDATE
+ * Sent by a file system instance to the kernel when the lookups it answered
+ * may have changed
+ *
+ * \def VFS_INVALIDATE_DATA
+ * Sent by a file system instance to the kernel when the content of a file
+ * changed
+ *
+ * \def VFS_GETDENTS
+ * VFS getdents message identifier, reads many entries of a directory
+ *
+ * \def VFS_READY
+ * Sent by a driver to the kernel when the readiness of its device changes
  */
 # define VFS_OPEN 1
 # define VFS_READ 2
@@ -91,6 +106,10 @@
 # define VFS_IOCTL 11
 # define VFS_GETDIRENT 12
 # define VFS_FS_CREATE 13
+# define VFS_INVALIDATE 14
+# define VFS_INVALIDATE_DATA 15
+# define VFS_GETDENTS 16
+# define VFS_READY 17
 
 /**
  * \def VFS_OPS_OPEN
@@ -131,6 +150,16 @@
  *
  * \def VFS_OPS_FS_CREATE
  * VFS fs create capability
+ *
+ * \def VFS_OPS_RING
+ * read and write payloads can be exchanged through a shared memory ring
+ *
+ * \def VFS_OPS_CACHE
+ * the kernel may keep the content of the files, the file system sends
+ * VFS_INVALIDATE_DATA when it changes
+ *
+ * \def VFS_OPS_GETDENTS
+ * VFS getdents capability
  */
 # define VFS_OPS_OPEN (1 << 0)
 # define VFS_OPS_READ (1 << 1)
@@ -145,6 +174,9 @@
 # define VFS_OPS_IOCTL (1 << 10)
 # define VFS_OPS_GETDIRENT (1 << 11)
 # define VFS_OPS_FS_CREATE (1 << 12)
+# define VFS_OPS_RING (1 << 13)
+# define VFS_OPS_CACHE (1 << 14)
+# define VFS_OPS_GETDENTS (1 << 15)
 
 /**
  * \def VFS_PERM_OTHER_R
@@ -359,6 +391,8 @@ struct fs_operation {
     int (*stat)(struct mount_entry *, uid_t, gid_t, ino_t, struct stat *);
     int (*mount)(struct mount_entry *, ino_t, int);
     int (*getdirent)(struct mount_entry *, ino_t, struct dirent *, int);
+    int (*getdents)(struct mount_entry *, uid_t, gid_t, ino_t, void *, int,
+                    int, uint32_t *);
 };
 
 /**
@@ -428,9 +462,9 @@ struct fs {
     struct klist instances;
 
     /**
-     *  \brief  List of registered file systems
+     *  \brief  Node in the table of registered file systems
      */
-    struct klist list;
+    struct htable_node hash;
 };
 
 /**
@@ -0,0 +1,122 @@
+/*
+ * zOS
+ * Copyright (C) 2015 Baptiste Covolato
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zOS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file    include/kernel/fs/vfs/acache.h
+ * \brief   Cache of the attributes of the inodes of a file system instance
+ *
+ * \author  Baptiste Covolato
+ */
+
+#ifndef FS_VFS_ACACHE_H
+# define FS_VFS_ACACHE_H
+
+# include <kernel/types.h>
+# include <kernel/klist.h>
+
+# include <kernel/fs/vfs/vops.h>
+
+# include <kernel/fs/vfs/lru.h>
+
+# include <arch/spinlock.h>
+
+/**
+ *  \brief  Maximum number of entries of a cache, the least recently used one
+ *          is recycled beyond that
+ */
+# define ACACHE_MAX_ENTRIES 128
+
+/**
+ *  \brief  Number of buckets of a cache, a power of 2
+ */
+# define ACACHE_BUCKETS 32
+
+/**
+ *  \brief  Lease of attributes that stay valid until they are invalidated
+ */
+# define ACACHE_LEASE_INFINITE 0xffffffff
+
+/**
+ *  \brief  The attributes of an inode
+ */
+struct acache_entry {
+    struct lru_node node;
+
+    ino_t inode;
+
+    /**
+     *  \brief  Tick at which the lease ends
+     */
+    tick_t expire;
+
+    /**
+     *  \brief  Set if the lease never ends
+     */
+    int infinite;
+
+    struct stat stat;
+};
+
+struct acache {
+    struct klist buckets[ACACHE_BUCKETS];
+
+    struct lru lru;
+
+    /**
+     *  \brief  Incremented by each invalidation, attributes obtained before
+     *          one are not added
+     */
+    uint32_t generation;
+
+    spinlock_t lock;
+};
+
+/**
+ *  \brief  Initialize an empty cache
+ */
+void acache_initialize(struct acache *ac);
+
+/**
+ *  \brief  Look for the attributes of \a inode whose lease is still running
+ *
+ *  \return 1: Found, \a buf is filled
+ *  \return 0: Not in the cache or expired
+ */
+int acache_lookup(struct acache *ac, ino_t inode, struct stat *buf);
+
+/**
+ *  \brief  Generation of the cache, to be read before asking the file system
+ *          and given to acache_add()
+ */
+uint32_t acache_generation(struct acache *ac);
+
+/**
+ *  \brief  Add the attributes of \a inode granted for \a lease milliseconds,
+ *          or ACACHE_LEASE_INFINITE. Nothing is added if \a lease is 0 or if
+ *          the cache has been invalidated since \a generation
+ */
+void acache_add(struct acache *ac, uint32_t generation, ino_t inode,
+                const struct stat *buf, uint32_t lease);
+
+/**
+ *  \brief  Drop the attributes of \a inode, or every attribute if \a inode
+ *          is 0
+ */
+void acache_invalidate(struct acache *ac, ino_t inode);
+
+#endif /* !FS_VFS_ACACHE_H */
@@ -0,0 +1,133 @@
+/*
+ * zOS
+ * Copyright (C) 2015 Baptiste Covolato
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zOS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file    include/kernel/fs/vfs/dcache.h
+ * \brief   Cache of the lookups answered by a file system instance
+ *
+ * \author  Baptiste Covolato
+ */
+
+#ifndef FS_VFS_DCACHE_H
+# define FS_VFS_DCACHE_H
+
+# include <kernel/types.h>
+# include <kernel/klist.h>
+
+# include <kernel/fs/vfs/message.h>
+
+# include <kernel/fs/vfs/lru.h>
+
+# include <arch/spinlock.h>
+
+/**
+ *  \brief  Maximum number of entries of a cache, the least recently used one
+ *          is recycled beyond that
+ */
+# define DCACHE_MAX_ENTRIES 128
+
+/**
+ *  \brief  Number of buckets of a cache, a power of 2
+ */
+# define DCACHE_BUCKETS 32
+
+/**
+ *  \brief  Longest path cached, in bytes with the terminating null byte
+ */
+# define DCACHE_PATH_MAX 64
+
+/**
+ *  \brief  The answer of a file system to the lookup of a path
+ */
+struct dcache_entry {
+    struct lru_node node;
+
+    /**
+     *  \brief  Hash of the path and of the credentials
+     */
+    uint32_t key;
+
+    /**
+     *  \brief  Credentials of the lookup, the file system checks the search
+     *          permission of the directories with them
+     */
+    uid_t uid;
+    gid_t gid;
+
+    /**
+     *  \brief  The answer, a negative entry has res.ret set to -ENOENT
+     */
+    struct resp_lookup res;
+
+    /**
+     *  \brief  The path, relative to the root of the instance
+     */
+    char path[DCACHE_PATH_MAX];
+};
+
+struct dcache {
+    struct klist buckets[DCACHE_BUCKETS];
+
+    struct lru lru;
+
+    /**
+     *  \brief  Incremented by each invalidation, an answer obtained before
+     *          one is not added
+     */
+    uint32_t generation;
+
+    spinlock_t lock;
+};
+
+/**
+ *  \brief  Initialize an empty cache
+ */
+void dcache_initialize(struct dcache *dc);
+
+/**
+ *  \brief  Look for the answer to the lookup of \a path with the credentials
+ *          \a uid and \a gid
+ *
+ *  \return 1: Found, \a res is filled
+ *  \return 0: Not in the cache
+ */
+int dcache_lookup(struct dcache *dc, const char *path, uid_t uid, gid_t gid,
+                  struct resp_lookup *res);
+
+/**
+ *  \brief  Generation of the cache, to be read before asking the file system
+ *          and given to dcache_add()
+ */
+uint32_t dcache_generation(struct dcache *dc);
+
+/**
+ *  \brief  Add the answer of the file system to the lookup of \a path. It is
+ *          ignored if the cache has been invalidated since \a generation, if
+ *          the path is too long or if it is an error other than -ENOENT
+ */
+void dcache_add(struct dcache *dc, uint32_t generation, const char *path,
+                uid_t uid, gid_t gid, const struct resp_lookup *res);
+
+/**
+ *  \brief  Drop the entries that resolve to \a inode, the entries of the paths
+ *          under them and all the negative entries. Everything is dropped if
+ *          \a inode is 0
+ */
+void dcache_invalidate(struct dcache *dc, ino_t inode);
+
+#endif /* !FS_VFS_DCACHE_H */
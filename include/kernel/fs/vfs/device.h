@@ -29,6 +29,7 @@
 
 # include <kernel/types.h>
 # include <kernel/zos.h>
+# include <kernel/htable.h>
 
 /**
  * \brief   The maximum number of devices that can be registered in the system
@@ -74,8 +75,20 @@ struct device {
      *  \brief  Private data for the driver
      */
     void *private;
+
+    /**
+     *  \brief  Node in the table of devices, indexed by name
+     */
+    struct htable_node hash;
 };
 
+/**
+ * \brief   Initialize the device registry
+ *
+ * \return  0: Success
+ */
+int device_initialize(void);
+
 /**
  * \brief   Create a new device
  *
@@ -0,0 +1,116 @@
+/*
+ * zOS
+ * Copyright (C) 2015 Baptiste Covolato
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zOS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file    include/kernel/fs/vfs/lru.h
+ * \brief   Bounded least recently used lists, shared by the VFS caches
+ *
+ * \author  Baptiste Covolato
+ */
+
+#ifndef FS_VFS_LRU_H
+# define FS_VFS_LRU_H
+
+# include <kernel/types.h>
+# include <kernel/klist.h>
+
+/**
+ *  \brief  Links of a cache entry, it must be the first field of the entry
+ *          so that the entry can be freed through it
+ */
+struct lru_node {
+    /**
+     *  \brief  Node in its bucket
+     */
+    struct klist hash;
+
+    /**
+     *  \brief  Node in the LRU list of the cache
+     */
+    struct klist lru;
+};
+
+/**
+ *  \brief  The entries of a cache, protected by the lock of the cache
+ */
+struct lru {
+    /**
+     *  \brief  Entries, the most recently used first
+     */
+    struct klist entries;
+
+    /**
+     *  \brief  Number of entries allocated
+     */
+    int count;
+
+    /**
+     *  \brief  Maximum number of entries, the least recently used one is
+     *          recycled beyond that
+     */
+    int max;
+};
+
+/**
+ *  \brief  Initialize an empty list of at most \a max entries
+ */
+void lru_initialize(struct lru *lru, int max);
+
+/**
+ *  \brief  Allocate an entry of \a size bytes, before the lock of the cache
+ *          is taken
+ *
+ *  \return The entry, NULL if the cache looks full or if there is no memory
+ */
+struct lru_node *lru_alloc(struct lru *lru, size_t size);
+
+/**
+ *  \brief  Pick the entry to fill for a key, the lock of the cache held
+ *
+ *  \param  lru     The list
+ *  \param  found   The entry already cached for the key, or NULL
+ *  \param  new     The entry returned by lru_alloc(), freed if it is not used
+ *
+ *  \return The entry, out of the lists, NULL if there is nothing to recycle
+ */
+struct lru_node *lru_claim(struct lru *lru, struct lru_node *found,
+                           struct lru_node *new);
+
+/**
+ *  \brief  Insert an entry filled after lru_claim(), the lock of the cache
+ *          held
+ *
+ *  \param  lru     The list
+ *  \param  bucket  The bucket of the key of the entry
+ *  \param  node    The entry
+ */
+void lru_insert(struct lru *lru, struct klist *bucket, struct lru_node *node);
+
+/**
+ *  \brief  Mark an entry as the most recently used, the lock of the cache
+ *          held
+ */
+void lru_touch(struct lru *lru, struct lru_node *node);
+
+/**
+ *  \brief  Remove an entry from the lists and free it, the lock of the cache
+ *          held
+ */
+void lru_drop(struct lru *lru, struct lru_node *node);
+
+#endif /* !FS_VFS_LRU_H */
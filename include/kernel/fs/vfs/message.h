@@ -80,6 +80,12 @@ struct resp_stat {
     int ret;
 
     struct stat stat;
+
+    /*
+     * Milliseconds during which the kernel may reuse the attributes without
+     * asking, 0 for never and ACACHE_LEASE_INFINITE until VFS_INVALIDATE
+     */
+    uint32_t lease;
 };
 
 /* Open request */
@@ -170,6 +176,39 @@ struct resp_getdirent {
     struct dirent dirent;
 };
 
+/*
+ * Getdents request, at most count entries from cookie are written in data, as
+ * struct dirent_plus if flags has GETDENTS_STAT
+ */
+struct req_getdents {
+    struct msg_header hdr;
+
+    ino_t inode;
+
+    uid_t uid;
+    gid_t gid;
+
+    uint32_t cookie;
+
+    int count;
+
+    int flags;
+
+    void *data;
+};
+
+/*
+ * Getdents response, ret is the number of entries, 0 at the end. The
+ * attributes are granted for lease milliseconds as in struct resp_stat
+ */
+struct resp_getdents {
+    int ret;
+
+    uint32_t cookie;
+
+    uint32_t lease;
+};
+
 /* Mount request */
 struct req_mount {
     struct msg_header hdr;
@@ -184,4 +223,41 @@ struct resp_mount {
     int ret;
 };
 
+/*
+ * Invalidation, sent by an instance on its channel to CHANNEL_CONTROL_ID.
+ * The lookups that resolve to inode, or go through it, are forgotten, with
+ * the failed ones, and so are the attributes and the content of inode.
+ * Everything is forgotten if inode is 0
+ */
+struct req_invalidate {
+    struct msg_header hdr;
+
+    ino_t inode;
+};
+
+/*
+ * Invalidation of the content of inode from off, on size bytes or up to the
+ * end of the file if size is 0
+ */
+struct req_invalidate_data {
+    struct msg_header hdr;
+
+    ino_t inode;
+
+    uint64_t off;
+
+    uint64_t size;
+};
+
+/*
+ * Readiness of a device, sent by its driver to CHANNEL_CONTROL_ID. events
+ * are the poll events the device reports until the next one, POLLIN when
+ * a read would not block
+ */
+struct req_ready {
+    struct msg_header hdr;
+
+    uint32_t events;
+};
+
 #endif /* !FS_VFS_MESSAGE_H */
@@ -22,5 +22,7 @@ int vfs_mount(struct thread *t, const char *fs_name, const char *device,
               const char *mount_pt);
 struct mount_entry *vfs_root_get(void);
 struct mount_entry *vfs_mount_pt_get(const char *path);
+/* Mount point of the first len characters of path */
+struct mount_entry *vfs_mount_pt_get_n(const char *path, size_t len);
 
 #endif /* !FS_VFS_MOUNT_H */
@@ -0,0 +1,148 @@
+/*
+ * zOS
+ * Copyright (C) 2015 Baptiste Covolato
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zOS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file    include/kernel/fs/vfs/pcache.h
+ * \brief   Cache of the pages of the files, shared by every file system
+ *          instance
+ *
+ * A page is pinned by a reference while its data is copied. Invalidating a
+ * pinned page removes it from the cache, it is released by its last user.
+ *
+ * \author  Baptiste Covolato
+ */
+
+#ifndef FS_VFS_PCACHE_H
+# define FS_VFS_PCACHE_H
+
+# include <kernel/types.h>
+# include <kernel/klist.h>
+
+# include <arch/mmu.h>
+
+/**
+ *  \brief  Maximum number of pages of the cache
+ */
+# define PCACHE_MAX_PAGES 256
+
+/**
+ *  \brief  Number of buckets of the cache, a power of 2
+ */
+# define PCACHE_BUCKETS 64
+
+struct fs_instance;
+
+struct pcache_page {
+    /**
+     *  \brief  Node in its bucket
+     */
+    struct klist hash;
+
+    /**
+     *  \brief  Node in the LRU list of the cache
+     */
+    struct klist lru;
+
+    /**
+     *  \brief  The file system instance of the file
+     */
+    struct fs_instance *fi;
+
+    ino_t inode;
+
+    /**
+     *  \brief  Offset of the page in the file, in pages
+     */
+    uint32_t index;
+
+    /**
+     *  \brief  Number of valid bytes, less than PAGE_SIZE if the file ends
+     *          in the page
+     */
+    size_t size;
+
+    /**
+     *  \brief  Number of users of the page
+     */
+    int ref;
+
+    /**
+     *  \brief  Set once the page is out of the cache
+     */
+    int dead;
+
+    /**
+     *  \brief  Set if the page was read ahead and nobody read it yet
+     */
+    int readahead;
+
+    /**
+     *  \brief  The content, mapped in the kernel address space
+     */
+    void *data;
+};
+
+/**
+ *  \brief  Initialize the page cache
+ */
+void pcache_initialize(void);
+
+/**
+ *  \brief  Find a page of a file and pin it
+ *
+ *  \return The page, NULL if it is not in the cache
+ */
+struct pcache_page *pcache_get(struct fs_instance *fi, ino_t inode,
+                               uint32_t index);
+
+/**
+ *  \brief  Generation of the cache, to be read before reading a page from the
+ *          file system and given to pcache_insert()
+ */
+uint32_t pcache_generation(void);
+
+/**
+ *  \brief  Get a pinned page out of the cache to be filled, the least
+ *          recently used page is recycled when the cache is full
+ *
+ *  \return The page, NULL if every page is pinned or memory is exhausted
+ */
+struct pcache_page *pcache_page_new(void);
+
+/**
+ *  \brief  Put a page obtained with pcache_page_new() in the cache, it stays
+ *          pinned. It is only released by pcache_put() if the cache was
+ *          invalidated since \a generation or if the page is already cached
+ */
+void pcache_insert(struct pcache_page *page, uint32_t generation,
+                   struct fs_instance *fi, ino_t inode, uint32_t index,
+                   size_t size);
+
+/**
+ *  \brief  Unpin a page
+ */
+void pcache_put(struct pcache_page *page);
+
+/**
+ *  \brief  Drop the pages of \a inode from \a first to \a last included, or
+ *          every page of \a fi if \a inode is 0
+ */
+void pcache_invalidate(struct fs_instance *fi, ino_t inode, uint32_t first,
+                       uint32_t last);
+
+#endif /* !FS_VFS_PCACHE_H */
@@ -9,6 +9,12 @@
 
 # define NAME_MAX 256
 
+/* Flag of vfs_getdents(), the entries are struct dirent_plus */
+# define GETDENTS_STAT (1 << 0)
+
+/* Maximum number of entries returned by one vfs_getdents() */
+# define GETDENTS_MAX 64
+
 struct resp_lookup;
 struct mount_entry;
 struct thread;
@@ -35,6 +41,12 @@ struct dirent {
     char d_name[NAME_MAX];
 };
 
+/* st.st_ino is 0 if the attributes of the entry could not be read */
+struct dirent_plus {
+    struct dirent d;
+    struct stat st;
+};
+
 int vfs_lookup(struct thread *t, const char *path, struct resp_lookup *res,
                struct mount_entry **mount_pt);
 int vfs_mkdir(struct thread *t, const char *path, mode_t mode);
@@ -52,5 +64,7 @@ int vfs_ioctl(struct thread *t, int fd, int req, int *argp);
 int vfs_dup(struct thread *t, int oldfd);
 int vfs_dup2(struct thread *t, int oldfd, int newfd);
 int vfs_getdirent(struct thread *t, int fd, struct dirent *dirent, int index);
+int vfs_getdents(struct thread *t, int fd, void *buf, size_t size,
+                 uint32_t *cookie, int flags);
 
 #endif /* !FS_VFS_VOPS_H */
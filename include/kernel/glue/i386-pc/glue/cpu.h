@@ -4,10 +4,17 @@
 # include <arch/tss.h>
 
 struct cpu;
+struct thread;
 
 struct cpu_glue_data
 {
     struct tss tss;
+
+    /* Task used to handle double faults on a known good stack */
+    struct tss df_tss;
+
+    /* Thread whose state is loaded in the FPU, NULL if none */
+    struct thread *fpu_owner;
 };
 
 int i386_pc_cpu_initialize(struct cpu *cpu);
@@ -0,0 +1,107 @@
+/*
+ * zOS
+ * Copyright (C) 2015 Baptiste Covolato
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zOS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file    include/kernel/htable.h
+ * \brief   Hash table of objects indexed by a name
+ *
+ * The nodes are embedded in the objects, like klist, and the table does not
+ * lock anything: the users protect it with the lock of their registry
+ *
+ * \author  Baptiste Covolato
+ */
+
+#ifndef HTABLE_H
+# define HTABLE_H
+
+# include <kernel/types.h>
+# include <kernel/klist.h>
+
+struct htable_node {
+    /**
+     *  \brief  Used to link the node in its bucket
+     */
+    struct klist list;
+
+    /**
+     *  \brief  The name of the object, it must live as long as the node is
+     *          in a table
+     */
+    const char *key;
+
+    /**
+     *  \brief  Hash of the key
+     */
+    uint32_t hash;
+};
+
+struct htable {
+    /**
+     *  \brief  The buckets
+     */
+    struct klist *buckets;
+
+    /**
+     *  \brief  Number of buckets, a power of 2
+     */
+    int size;
+
+    /**
+     *  \brief  Keys are compared on at most this number of characters
+     */
+    size_t key_max;
+};
+
+/**
+ *  \brief  Initialize a hash table
+ *
+ *  \param  table   The table to initialize
+ *  \param  buckets Storage of the buckets, \a size entries
+ *  \param  size    Number of buckets, must be a power of 2
+ *  \param  key_max Keys are compared on at most this number of characters
+ */
+void htable_initialize(struct htable *table, struct klist *buckets, int size,
+                       size_t key_max);
+
+/**
+ *  \brief  Add a node to a table, the key must not be in the table already
+ */
+void htable_add(struct htable *table, struct htable_node *node,
+                const char *key);
+
+/**
+ *  \brief  Remove a node from its table
+ */
+void htable_del(struct htable_node *node);
+
+/**
+ *  \brief  Find the node of a key
+ *
+ *  \return The node, NULL if the key is not in the table
+ */
+struct htable_node *htable_get(struct htable *table, const char *key);
+
+/**
+ *  \brief  Find the object of a key, or NULL
+ */
+# define htable_get_elem(table, key, type, field)  ({                       \
+    struct htable_node *node_ = htable_get((table), (key));                 \
+    node_ ? klist_elem(node_, type, field) : NULL;                          \
+})
+
+#endif /* !HTABLE_H */
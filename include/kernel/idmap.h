@@ -0,0 +1,106 @@
+/*
+ * zOS
+ * Copyright (C) 2015 Baptiste Covolato
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zOS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file    include/kernel/idmap.h
+ * \brief   Bitmap based allocator of integer identifiers
+ *
+ * \author  Baptiste Covolato
+ */
+
+#ifndef IDMAP_H
+# define IDMAP_H
+
+# include <kernel/types.h>
+
+# include <arch/spinlock.h>
+
+/**
+ *  \brief  Number of 32 bits words needed to store \a size ids
+ */
+# define IDMAP_WORDS(size) (((size) + 31) / 32)
+
+/**
+ * \def IDMAP_FIRST_FIT
+ * Always allocate the lowest free id
+ *
+ * \def IDMAP_CYCLIC
+ * Allocate the next free id after the last allocated one, so that a freed id
+ * is not reused right away
+ */
+# define IDMAP_FIRST_FIT 0
+# define IDMAP_CYCLIC 1
+
+struct idmap {
+    /**
+     *  \brief  Lock protecting the bitmap
+     */
+    spinlock_t lock;
+
+    /**
+     *  \brief  One bit per id, set when the id is used
+     */
+    uint32_t *bitmap;
+
+    /**
+     *  \brief  Number of ids managed by the map
+     */
+    int size;
+
+    /**
+     *  \brief  IDMAP_FIRST_FIT or IDMAP_CYCLIC
+     */
+    int policy;
+
+    /**
+     *  \brief  Where the next search starts when the map is cyclic
+     */
+    int next;
+};
+
+/**
+ *  \brief  Initialize an id map
+ *
+ *  \param  map     The map to initialize
+ *  \param  bitmap  Storage of the bitmap, at least IDMAP_WORDS(size) words
+ *  \param  size    Number of ids, from 0 to size - 1
+ *  \param  policy  IDMAP_FIRST_FIT or IDMAP_CYCLIC
+ */
+void idmap_initialize(struct idmap *map, uint32_t *bitmap, int size,
+                      int policy);
+
+/**
+ *  \brief  Allocate an id
+ *
+ *  \return The id, -1 if every id is in use
+ */
+int idmap_alloc(struct idmap *map);
+
+/**
+ *  \brief  Allocate a specific id
+ *
+ *  \return 0 on success, -1 if the id is already in use or out of range
+ */
+int idmap_reserve(struct idmap *map, int id);
+
+/**
+ *  \brief  Release an id
+ */
+void idmap_free(struct idmap *map, int id);
+
+#endif /* !IDMAP_H */
@@ -69,6 +69,25 @@ int interrupt_register(int irq, int type, void (*callback)(struct irq_regs *));
 
 void interrupt_unregister(int irq);
 
+struct thread;
+struct wait_queue;
+
+/*
+ * Wait queue notified when the user irq fires, NULL if the irq is not
+ * registered by the thread
+ */
+struct wait_queue *interrupt_user_queue(struct thread *t, int irq_num);
+
+/*
+ * Test and clear the fired state of a user irq registered by the thread
+ */
+int interrupt_user_ack(struct thread *t, int irq_num);
+
+/*
+ * Release a user irq registered by the thread
+ */
+void interrupt_user_unregister(struct thread *t, int irq_num);
+
 /*
  * Mask an IRQ
  */
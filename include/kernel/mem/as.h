@@ -32,7 +32,7 @@ struct as
     spinlock_t region_lock;
     struct klist regions;
 
-    spinlock_t map_lock;
+    rwlock_t map_lock;
     struct klist mapping;
 
     struct glue_as arch;
@@ -83,6 +83,16 @@ struct as_mapping *as_mapping_locate(struct as *as, vaddr_t vaddr);
 vaddr_t as_map(struct as *as, vaddr_t vaddr, paddr_t paddr, size_t size,
                int flags);
 
+/*
+ * Share the kernel memory at kaddr with as, at vaddr or anywhere if
+ * vaddr == 0. The mapping holds a reference on the pages, it is released
+ * when the mapping is unmapped with AS_UNMAP_RELEASE or with the address space
+ *
+ * Return the address in as if everything went well 0 otherwise
+ */
+vaddr_t as_map_kernel(struct as *as, vaddr_t vaddr, const void *kaddr,
+                      size_t size, int flags);
+
 /*
  * Duplicate an entire address space relying on COW technique
  */
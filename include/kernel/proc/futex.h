@@ -0,0 +1,145 @@
+/*
+ * zOS
+ * Copyright (C) 2015 Baptiste Covolato
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zOS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file    include/kernel/proc/futex.h
+ * \brief   Definition of functions and structures related to futexes
+ *
+ * \author  Baptiste Covolato
+ */
+
+#ifndef PROC_FUTEX_H
+# define PROC_FUTEX_H
+
+# include <kernel/types.h>
+# include <kernel/klist.h>
+
+# include <arch/spinlock.h>
+
+/**
+ *  \brief  Number of buckets in the futex hash table (must be a power of 2)
+ */
+# define FUTEX_HASH_SIZE 64
+
+/**
+ * \def FUTEX_STATE_WAITING
+ * The waiter is queued and its thread is (or is about to be) blocked
+ *
+ * \def FUTEX_STATE_WOKEN
+ * The waiter has been woken up by futex_wake()
+ *
+ * \def FUTEX_STATE_TIMEDOUT
+ * The timeout of the waiter expired before anyone woke it up
+ *
+ * \def FUTEX_STATE_CANCELED
+ * The thread of the waiter exited while it was waiting
+ */
+# define FUTEX_STATE_WAITING 0
+# define FUTEX_STATE_WOKEN 1
+# define FUTEX_STATE_TIMEDOUT 2
+# define FUTEX_STATE_CANCELED 3
+
+struct thread;
+
+/**
+ *  \brief  Represent a thread waiting on a futex. It lives on the kernel
+ *          stack of the waiting thread
+ */
+struct futex_waiter {
+    /**
+     *  \brief  Physical address of the futex word, used as the key
+     */
+    paddr_t key;
+
+    /**
+     *  \brief  The waiting thread
+     */
+    struct thread *thread;
+
+    /**
+     *  \brief  One of FUTEX_STATE_*
+     */
+    int state;
+
+    /**
+     *  \brief  Timer used for the timeout, -1 if there isn't any
+     */
+    int timer;
+
+    /**
+     *  \brief  List of waiters in the same bucket
+     */
+    struct klist list;
+};
+
+/**
+ *  \brief  A bucket of the futex hash table
+ */
+struct futex_bucket {
+    /**
+     *  \brief  Lock protecting the bucket
+     */
+    spinlock_t lock;
+
+    /**
+     *  \brief  Waiters whose key hash to this bucket, in FIFO order
+     */
+    struct klist waiters;
+};
+
+/**
+ *  \brief  Initialize the futex hash table
+ */
+void futex_initialize(void);
+
+/**
+ *  \brief  Block \a thread while the futex word at \a uaddr contains \a val
+ *
+ *  \param  thread  The thread that waits (must be the current thread)
+ *  \param  uaddr   Userland address of the futex word
+ *  \param  val     The value the futex word is expected to contain
+ *  \param  timeout Timeout in ticks, 0 to wait forever. The system call
+ *                  converts the timeout given by userland in milliseconds
+ *
+ *  \return 0: The thread has been woken up by futex_wake()
+ *  \return -EFAULT: \a uaddr is not a valid aligned userland address
+ *  \return -EAGAIN: The futex word did not contain \a val
+ *  \return -ETIMEDOUT: The timeout expired
+ */
+int futex_wait(struct thread *thread, uint32_t *uaddr, uint32_t val,
+               size_t timeout);
+
+/**
+ *  \brief  Wake up to \a count threads waiting on the futex word at \a uaddr
+ *
+ *  \param  thread  The thread that issues the wake up (current thread)
+ *  \param  uaddr   Userland address of the futex word
+ *  \param  count   Maximum number of threads to wake up
+ *
+ *  \return The number of threads woken up, -EFAULT if \a uaddr is invalid
+ */
+int futex_wake(struct thread *thread, uint32_t *uaddr, int count);
+
+/**
+ *  \brief  Remove \a thread from the futex it is waiting on, if any
+ *
+ *  \param  thread  The thread that is exiting
+ */
+void futex_cancel(struct thread *thread);
+
+#endif /* !PROC_FUTEX_H */
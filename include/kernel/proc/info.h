@@ -0,0 +1,126 @@
+/*
+ * zOS
+ * Copyright (C) 2015 Baptiste Covolato
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zOS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file    include/kernel/proc/info.h
+ * \brief   Definition of the read-only information page shared with userland
+ *
+ * \author  Baptiste Covolato
+ */
+
+#ifndef PROC_INFO_H
+# define PROC_INFO_H
+
+# include <kernel/types.h>
+
+/**
+ *  \brief  Userland address of the information page. It is the last page
+ *          before the kernel, right above the stack of the first thread
+ */
+# define PROCESS_INFO_ADDR 0xBFFFF000
+
+/**
+ *  \brief  Shift applied to the product of a cycle count by \a clock_mult
+ */
+# define PROCESS_INFO_CLOCK_SHIFT 24
+
+struct process;
+struct thread;
+
+/**
+ *  \brief  Content of the information page. Its layout is part of the ABI,
+ *          userland has its own copy in zos/info.h
+ */
+struct process_info {
+    /**
+     *  \brief  The pid of the process
+     */
+    int32_t pid;
+
+    /**
+     *  \brief  The tid of the thread currently running in the process
+     */
+    int32_t tid;
+
+    /**
+     *  \brief  Copy of the kernel tick counter
+     */
+    tick_t ticks;
+
+    /**
+     *  \brief  Frequency of the tick counter
+     */
+    uint32_t tick_per_sec;
+
+    /**
+     *  \brief  Frequency of the cycle counter in kHz, 0 if there isn't any
+     */
+    uint32_t clock_khz;
+
+    /**
+     *  \brief  Nanoseconds = (cycles * clock_mult) >> clock_shift
+     */
+    uint32_t clock_mult;
+    uint32_t clock_shift;
+
+    /**
+     *  \brief  Value of the cycle counter when the kernel calibrated it
+     */
+    uint64_t clock_base;
+};
+
+/**
+ *  \brief  Register the calibrated cycle counter exported to userland
+ *
+ *  \param  khz     The frequency of the counter in kHz
+ *  \param  mult    Multiplier converting cycles to nanoseconds
+ *  \param  base    Value of the counter at calibration time
+ */
+void process_info_clock_set(uint32_t khz, uint32_t mult, uint64_t base);
+
+/**
+ *  \brief  Allocate the information page of \a process and map it in its
+ *          address space. Nothing must be mapped at PROCESS_INFO_ADDR, fork
+ *          unmaps the page inherited from the parent first
+ *
+ *  \return 0 on success, -ENOMEM if no memory is available or if the
+ *          address is taken
+ */
+int process_info_create(struct process *process);
+
+/**
+ *  \brief  Map back the information page of \a process in its address space,
+ *          used after the address space has been cleaned by exec
+ *
+ *  \return 0 on success, -ENOMEM if the address is taken or the mapping
+ *          failed
+ */
+int process_info_map(struct process *process);
+
+/**
+ *  \brief  Release the information page of \a process
+ */
+void process_info_destroy(struct process *process);
+
+/**
+ *  \brief  Refresh the information page of the process of \a thread, called
+ *          on every tick and when \a thread is elected
+ */
+void process_info_update(struct thread *thread);
+
+#endif /* !PROC_INFO_H */
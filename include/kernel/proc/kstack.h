@@ -0,0 +1,78 @@
+/*
+ * zOS
+ * Copyright (C) 2015 Baptiste Covolato
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zOS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file    include/kernel/proc/kstack.h
+ * \brief   Allocation of kernel stacks
+ *
+ * \author  Baptiste Covolato
+ */
+
+#ifndef PROC_KSTACK_H
+# define PROC_KSTACK_H
+
+# include <kernel/types.h>
+
+# include <arch/spinlock.h>
+
+/**
+ *  \brief  Number of free stacks kept mapped by each cpu
+ */
+# define KSTACK_CACHE_SIZE 16
+
+/**
+ *  \brief  Number of unmapped pages below each stack, an overflow faults on
+ *          them instead of silently corrupting the memory below
+ */
+# define KSTACK_GUARD_PAGES 1
+
+/**
+ *  \brief  Per cpu cache of free kernel stacks
+ */
+struct kstack_cache {
+    spinlock_t lock;
+
+    int count;
+
+    /**
+     *  \brief  Base addresses of the cached stacks (one page each)
+     */
+    vaddr_t stacks[KSTACK_CACHE_SIZE];
+};
+
+/**
+ *  \brief  Initialize the kernel stack caches
+ */
+void kstack_initialize(void);
+
+/**
+ *  \brief  Get a one page kernel stack, preceded by its guard pages
+ *
+ *  \return The base address of the stack page, 0 if out of memory
+ */
+vaddr_t kstack_alloc(void);
+
+/**
+ *  \brief  Give back a stack returned by kstack_alloc(). It is kept in the
+ *          cache of the current cpu if there is room for it
+ *
+ *  \param  stack   Base address of the stack page
+ */
+void kstack_free(vaddr_t stack);
+
+#endif /* !PROC_KSTACK_H */
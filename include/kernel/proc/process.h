@@ -27,11 +27,14 @@
 # define PROCESS_H
 
 # include <kernel/types.h>
+# include <kernel/idmap.h>
 
 # include <kernel/mem/as.h>
 
 # include <kernel/fs/vfs.h>
 
+# include <kernel/proc/info.h>
+
 # include <arch/cpu.h>
 # include <arch/spinlock.h>
 
@@ -41,9 +44,17 @@
  *
  * \def PROCESS_MAX_OPEN_FD
  * Maximum number of open file descriptors per process
+ *
+ * \def PROCESS_HASH_SIZE
+ * Number of buckets of the pid hash table (must be a power of 2)
+ *
+ * \def THREAD_MAX_PER_PROCESS
+ * Maximum number of thread per process
  */
-# define PROCESS_MAX_PID 0xFF
+# define PROCESS_MAX_PID 0x1000
 # define PROCESS_MAX_OPEN_FD 255
+# define PROCESS_HASH_SIZE 256
+# define THREAD_MAX_PER_PROCESS 10
 
 /**
  * \def PROCESS_TYPE_KERNEL
@@ -74,7 +85,13 @@
  */
 # define PROCESS_CODE_SEGV 128
 
+/**
+ * \brief   Size of the name of a process (including the terminating nul)
+ */
+# define PROCESS_NAME_MAX 16
+
 struct thread;
+struct aio;
 
 /**
  * \brief   Represents a process in the kernel
@@ -91,6 +108,11 @@ struct process
      */
     struct process *parent;
 
+    /**
+     * \brief   Name of the program the process runs
+     */
+    char name[PROCESS_NAME_MAX];
+
     /**
      * \brief   The current state of the process (alive/zombie)
      */
@@ -112,6 +134,17 @@ struct process
      */
     struct as *as;
 
+    /**
+     * \brief   Kernel mapping of the information page shared with userland,
+     *          NULL for the kernel process
+     */
+    struct process_info *info;
+
+    /**
+     * \brief   Asynchronous VFS rings of the process, NULL until aio_setup()
+     */
+    struct aio *aio;
+
     /**
      * \brief   The number of thread the process has
      */
@@ -138,6 +171,12 @@ struct process
      */
     struct klist threads;
 
+    /**
+     * \brief   Allocator of the thread ids of the process
+     */
+    struct idmap tids;
+    uint32_t tid_bitmap[IDMAP_WORDS(THREAD_MAX_PER_PROCESS)];
+
     /**
      * \brief   The list of children
      */
@@ -152,6 +191,11 @@ struct process
      * \brief   Used to link process in the list of process
      */
     struct klist list;
+
+    /**
+     * \brief   Used to link process in its bucket of the pid hash table
+     */
+    struct klist hash;
 };
 
 /**
@@ -182,6 +226,41 @@ struct process *process_create(int type, uintptr_t code, int flags,
  */
 struct process *process_get(pid_t pid);
 
+/**
+ * \brief   Remove a reaped process from the process table and release its
+ *          pid
+ *
+ * \param   process The process to remove
+ */
+void process_release(struct process *process);
+
+/**
+ * \brief   Run \a cb on the process \a pid. The process cannot be removed
+ *          from the process table meanwhile, \a cb must not sleep
+ *
+ * \param   pid     The PID of the process
+ * \param   cb      The callback, its return value is returned
+ * \param   data    Passed to \a cb
+ *
+ * \return  -ESRCH: The process does not exist
+ */
+int process_call(pid_t pid, int (*cb)(struct process *, void *), void *data);
+
+/**
+ * \brief   Get the PID of the \a index th process of the process table
+ *
+ * \return  The PID, -1 if there are less than \a index + 1 processes
+ */
+pid_t process_pid_at(int index);
+
+/**
+ * \brief   Name a process after the base name of \a path
+ *
+ * \param   process The process to name
+ * \param   path    The path of the program the process runs
+ */
+void process_set_name(struct process *process, const char *path);
+
 /**
  * \brief   Create a child process from the process \a process
  *
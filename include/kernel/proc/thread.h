@@ -33,16 +33,21 @@
 
 # include <kernel/proc/process.h>
 # include <kernel/scheduler/event.h>
+# include <kernel/scheduler/policy.h>
+# include <kernel/scheduler/stats.h>
+# include <kernel/proc/futex.h>
 
 # include <arch/cpu.h>
 
 # define THREAD_CREATEF_NOSTART_THREAD (1 << 0)
 # define THREAD_CREATEF_DEEP_ARGV_COPY (1 << 1)
+# define THREAD_CREATEF_KERNEL (1 << 2)
 
 /**
- * \brief   Maxium number of thread per process
+ * \brief   Number of buckets of the (pid, tid) hash table (must be a power
+ *          of 2)
  */
-# define THREAD_MAX_PER_PROCESS 10
+# define THREAD_HASH_SIZE 256
 
 /**
  * \def THREAD_STATE_RUNNING
@@ -93,11 +98,38 @@ struct thread
      */
     int cpu;
 
+    /**
+     * \brief   Scheduling class, priority and cpu affinity of the thread
+     */
+    struct sched_attr sattr;
+
+    /**
+     * \brief   Set when the thread blocked before using half of its timeslice
+     *          the last time it ran, such threads preempt cpu bound ones
+     */
+    int interactive;
+
+    /**
+     * \brief   Cpu time and context switches of the thread
+     */
+    struct sched_thread_stats stats;
+
     /**
      * \brief   Used to store the event the thread is waiting on
      */
     struct scheduler_event event;
 
+    /**
+     * \brief   The futex the thread is waiting on, if any
+     */
+    struct futex_waiter *futex;
+
+    /**
+     * \brief   The asynchronous context the thread works for, it is released
+     *          when the thread is destroyed. NULL for other threads
+     */
+    struct aio *aio;
+
     /**
      * \brief   Interrupts the thread is listening to
      */
@@ -132,6 +164,11 @@ struct thread
      *  \brief  List of thread that belongs to a wait_queue
      */
     struct klist wait;
+
+    /**
+     *  \brief  Used to link thread in its bucket of the thread hash table
+     */
+    struct klist hash;
 };
 
 /**
@@ -141,10 +178,11 @@ struct thread
 struct thread_glue
 {
     /**
-     * \brief   Create a new thread
+     * \brief   Create a new thread, \a flags are the THREAD_CREATEF_* flags
+     *          that change the setup of its stack and privilege level
      */
     int (*create)(struct process *p, struct thread *t, uintptr_t ip, int argc,
-                  char *argv[], int copy);
+                  char *argv[], int flags);
 
     /**
      * \brief   Duplicate a thread
@@ -160,6 +198,11 @@ struct thread_glue
      * \brief   Save thread state (registers)
      */
     int (*save_state)(struct thread *, struct irq_regs *);
+
+    /**
+     * \brief   Release architecture dependent resources of a thread
+     */
+    int (*destroy)(struct thread *);
 };
 
 /**
@@ -167,6 +210,11 @@ struct thread_glue
  */
 extern struct thread_glue thread_glue_dispatcher;
 
+/**
+ * \brief   Initialize the thread hash table
+ */
+void thread_initialize(void);
+
 /**
  * \brief   Create a new thread inside a process
  * \todo    Use regular error code (ERRNO)
@@ -276,4 +324,14 @@ void thread_exit(struct thread *thread);
  */
 void thread_destroy(struct thread *thread);
 
+/**
+ * \brief   Fill \a info with the statistics of every thread of the system
+ *
+ * \param   info    Array of at least \a count entries
+ * \param   count   The maximum number of entries to fill
+ *
+ * \return  The number of entries filled
+ */
+int thread_stats_collect(struct sched_thread_info *info, int count);
+
 #endif /* !THREAD_H */
@@ -31,6 +31,29 @@
 
 # include <arch/spinlock.h>
 
+struct wait_queue;
+
+/**
+ *  \brief  Watches a wait queue without blocking on it, it is called each
+ *          time the queue is notified
+ */
+struct wait_queue_poller {
+    /**
+     *  \brief  Called with the lock of the queue held
+     */
+    void (*notify)(struct wait_queue_poller *poller);
+
+    /**
+     *  \brief  The queue watched, NULL once the queue is gone
+     */
+    struct wait_queue *queue;
+
+    /**
+     *  \brief  List of pollers of the queue
+     */
+    struct klist list;
+};
+
 /**
  *  \brief  Represent a wait queue
  */
@@ -44,6 +67,11 @@ struct wait_queue {
      *  \brief List of threads waiting on the queue
      */
     struct klist threads;
+
+    /**
+     *  \brief  List of pollers watching the queue
+     */
+    struct klist pollers;
 };
 
 /**
@@ -54,6 +82,7 @@ struct wait_queue {
 static inline void wait_queue_init(struct wait_queue *queue)
 {
     klist_head_init(&queue->threads);
+    klist_head_init(&queue->pollers);
     spinlock_init(&queue->lock);
 }
 
@@ -70,6 +99,7 @@ static inline void wait_queue_init(struct wait_queue *queue)
         if (!(cond)) {                                              \
             struct cpu *cpu = cpu_get((thread)->cpu);               \
             thread->state = THREAD_STATE_BLOCKED;                   \
+            (thread)->event.event = SCHED_EV_NONE;                  \
             klist_add_back(&(queue)->threads, &(thread)->wait);     \
             spinlock_unlock(&(queue)->lock);                        \
             spinlock_lock(&cpu->scheduler.sched_lock);              \
@@ -84,10 +114,13 @@ static inline void wait_queue_init(struct wait_queue *queue)
  *  \brief  Wake up the first thread waiting on a queue
  *
  *  \param  queue   The queue you want to notify
+ *
+ *  \return The thread woken up, NULL if no thread was waiting
  */
-static inline void wait_queue_notify(struct wait_queue *queue)
+static inline struct thread *wait_queue_notify(struct wait_queue *queue)
 {
     struct thread *thread;
+    struct wait_queue_poller *poller;
 
     spinlock_lock(&(queue)->lock);
 
@@ -98,7 +131,47 @@ static inline void wait_queue_notify(struct wait_queue *queue)
         klist_del(&thread->wait);
     }
 
+    klist_for_each_elem(&(queue)->pollers, poller, list)
+        poller->notify(poller);
+
+    spinlock_unlock(&(queue)->lock);
+
+    return thread;
+}
+
+/**
+ *  \brief  Wake up \a thread if it waits on a queue
+ *
+ *  \param  queue   The queue the thread may wait on
+ *  \param  thread  The thread to wake up, it is only dereferenced if it is
+ *                  found on the queue
+ *
+ *  \return 1 if the thread was waiting, 0 otherwise
+ */
+static inline int wait_queue_notify_thread(struct wait_queue *queue,
+                                           struct thread *thread)
+{
+    struct thread *t;
+    int found = 0;
+
+    spinlock_lock(&(queue)->lock);
+
+    klist_for_each_elem(&(queue)->threads, t, wait) {
+        if (t == thread) {
+            found = 1;
+            break;
+        }
+    }
+
+    if (found) {
+        thread->state = THREAD_STATE_RUNNING;
+        cpu_add_thread(thread);
+        klist_del(&thread->wait);
+    }
+
     spinlock_unlock(&(queue)->lock);
+
+    return found;
 }
 
 #endif /* !PROC_WAIT_QUEUE_H */
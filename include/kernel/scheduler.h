@@ -5,6 +5,8 @@
 # include <kernel/time.h>
 
 # include <kernel/proc/thread.h>
+# include <kernel/scheduler/policy.h>
+# include <kernel/scheduler/stats.h>
 
 # include <arch/cpu.h>
 # include <arch/spinlock.h>
@@ -14,11 +16,25 @@
  */
 # define SCHEDULER_TIME 10
 
+/**
+ *  \brief  Time given to a SCHED_FIFO thread, it only leaves the cpu when it
+ *          blocks or when a thread of higher priority becomes ready
+ */
+# define SCHEDULER_TIME_RT 0x7FFFFFFF
+
+/**
+ *  \brief  Affinity bits that stand for an existing cpu
+ */
+# define SCHEDULER_AFFINITY_MASK ((1U << CPU_COUNT) - 1)
+
 struct scheduler
 {
     /* Time left for the running task */
     size_t time;
 
+    /* A woken thread must take the cpu at the next interrupt or syscall exit */
+    int need_resched;
+
     struct thread *running;
 
     /* Idle thread to elect when nothing runs */
@@ -29,7 +45,24 @@ struct scheduler
 
     spinlock_t sched_lock;
 
+    /* Round robin queue of SCHED_NORMAL and SCHED_BATCH threads */
     struct klist threads;
+
+    /* SCHED_FIFO threads, sorted by decreasing priority */
+    struct klist rt_threads;
+
+    /* Time spent by the cpu and number of context switches */
+    struct sched_cpu_stats stats;
+
+    /* Thread elected when handoff_from blocks, see scheduler_handoff() */
+    struct thread *handoff;
+    struct thread *handoff_from;
+
+    /*
+     * Thread switched out because its affinity excludes this cpu, it is
+     * given to another cpu on the next update, once its stack is not used
+     */
+    struct thread *migrating;
 };
 
 struct scheduler_glue
@@ -50,9 +83,10 @@ void scheduler_initialize(struct scheduler *sched);
  */
 void scheduler_add_idle(struct scheduler *sched, struct thread *idle);
 /*
- * Add a thread to a specific scheduler
+ * Add a thread to a specific scheduler, return 1 if it must preempt the
+ * running thread
  */
-void scheduler_add_thread(struct scheduler *sched, struct thread *thread);
+int scheduler_add_thread(struct scheduler *sched, struct thread *thread);
 
 /*
  * Start a scheduler
@@ -66,6 +100,37 @@ void scheduler_start(struct scheduler *sched);
  */
 void scheduler_update(struct irq_regs *regs, int force);
 
+/*
+ * Charge the current tick to the running thread, or to idle time. Called by
+ * the timer before scheduler_update()
+ */
+void scheduler_tick(struct irq_regs *regs);
+
+/*
+ * Reschedule the local cpu if a woken thread asked for it. Called on the way
+ * out of interrupts and syscalls, where no lock is held
+ */
+void scheduler_preempt(struct irq_regs *regs);
+
 void scheduler_remove_thread(struct thread *t, struct scheduler *sched);
 
+/*
+ * The running thread is about to block waiting for thread: elect thread
+ * right away when it does, for the rest of the running thread's timeslice.
+ * Ignored if thread is not runnable on the local cpu by then
+ */
+void scheduler_handoff(struct thread *thread);
+
+/*
+ * Number of ticks the thread runs before the scheduler elects another one
+ */
+size_t scheduler_timeslice(struct thread *thread);
+
+/*
+ * Change the scheduling attributes of a thread and move it to the queue, or
+ * the cpu, they select. A running thread that is not allowed on its cpu
+ * anymore migrates the next time it is woken up
+ */
+int scheduler_set_attr(struct thread *thread, const struct sched_attr *attr);
+
 #endif /* !SCHEDULER_H */
@@ -0,0 +1,42 @@
+#ifndef SCHEDULER_POLICY_H
+# define SCHEDULER_POLICY_H
+
+# include <kernel/types.h>
+
+/* Time shared thread */
+# define SCHED_NORMAL 0
+
+/* Time shared thread that favours throughput: longer slices, no preemption */
+# define SCHED_BATCH 1
+
+/* Realtime thread, runs until it blocks or a higher priority one is ready */
+# define SCHED_FIFO 2
+
+# define SCHED_NICE_MIN (-20)
+# define SCHED_NICE_MAX 19
+
+# define SCHED_RT_PRIO_MIN 1
+# define SCHED_RT_PRIO_MAX 99
+
+/* Every cpu, bit n of an affinity mask stands for the cpu n */
+# define SCHED_AFFINITY_ALL 0xFFFFFFFF
+
+/*
+ * Scheduling attributes of a thread, also the structure exchanged with
+ * userland by sched_getattr()/sched_setattr()
+ */
+struct sched_attr {
+    int policy;
+
+    /* Used by SCHED_NORMAL and SCHED_BATCH */
+    int nice;
+
+    /* Used by SCHED_FIFO */
+    int rt_priority;
+
+    uint32_t affinity;
+};
+
+# define SCHED_ATTR_INIT { SCHED_NORMAL, 0, 0, SCHED_AFFINITY_ALL }
+
+#endif /* !SCHEDULER_POLICY_H */
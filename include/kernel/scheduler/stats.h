@@ -0,0 +1,55 @@
+#ifndef SCHEDULER_STATS_H
+# define SCHEDULER_STATS_H
+
+# include <kernel/types.h>
+
+# define SCHED_STATS_NAME_MAX 16
+
+/*
+ * Cpu usage of a thread, times are in timer ticks
+ */
+struct sched_thread_stats {
+    uint32_t user_ticks;
+    uint32_t kernel_ticks;
+
+    /* Number of times the thread has been elected */
+    uint32_t switches;
+
+    /* The thread left the cpu because it blocked, exited or yielded */
+    uint32_t voluntary;
+
+    /* The thread was preempted */
+    uint32_t involuntary;
+};
+
+/*
+ * Cpu usage of a cpu, times are in timer ticks
+ */
+struct sched_cpu_stats {
+    uint32_t user_ticks;
+    uint32_t kernel_ticks;
+    uint32_t idle_ticks;
+    uint32_t switches;
+};
+
+/*
+ * Entry filled by the thread_stats() syscall
+ */
+struct sched_thread_info {
+    int32_t pid;
+    int32_t tid;
+    int32_t state;
+    int32_t cpu;
+    int32_t policy;
+    int32_t nice;
+
+    /* Name of the process */
+    char name[SCHED_STATS_NAME_MAX];
+
+    struct sched_thread_stats stats;
+};
+
+/* Maximum number of entries returned by one thread_stats() call */
+# define SCHED_STATS_MAX 256
+
+#endif /* !SCHEDULER_STATS_H */
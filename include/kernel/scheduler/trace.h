@@ -0,0 +1,69 @@
+#ifndef SCHEDULER_TRACE_H
+# define SCHEDULER_TRACE_H
+
+# include <kernel/config.h>
+# include <kernel/types.h>
+
+/* Events kept per cpu, must be a power of 2 */
+# define SCHED_TRACE_SIZE 2048
+
+/*
+ * Event types, the meaning of arg0 and arg1 depends on it:
+ *  - SWITCH_OUT/SWITCH_IN: reason the previous thread left the cpu
+ *  - BLOCK: event and data the thread waits on
+ *  - WAKEUP: pid and tid of the waker (-1 if none)
+ *  - TIMER: timer id and callback data
+ *  - IRQ_ENTRY/IRQ_EXIT: irq number
+ */
+# define SCHED_TRACE_SWITCH_OUT 1
+# define SCHED_TRACE_SWITCH_IN 2
+# define SCHED_TRACE_BLOCK 3
+# define SCHED_TRACE_WAKEUP 4
+# define SCHED_TRACE_TIMER 5
+# define SCHED_TRACE_IRQ_ENTRY 6
+# define SCHED_TRACE_IRQ_EXIT 7
+
+/* Reasons of a context switch */
+# define SCHED_TRACE_TIMESLICE 0
+# define SCHED_TRACE_PREEMPT 1
+# define SCHED_TRACE_BLOCKED 2
+# define SCHED_TRACE_EXIT 3
+# define SCHED_TRACE_YIELD 4
+
+/*
+ * Record read from /dev/schedtrace. The timestamp is in TSC cycles, or in
+ * timer ticks when the cpu has no TSC
+ */
+struct sched_trace_event {
+    uint64_t tsc;
+    uint16_t type;
+    uint16_t cpu;
+    int32_t pid;
+    int32_t tid;
+    int32_t arg0;
+    int32_t arg1;
+};
+
+struct thread;
+
+# ifdef CONFIG_SCHED_TRACE
+
+/*
+ * Record an event of the local cpu about thread (may be NULL). Lock free and
+ * safe to call from interrupt context
+ */
+void sched_trace(int type, struct thread *thread, int32_t arg0, int32_t arg1);
+
+/*
+ * Create the /dev/schedtrace device
+ */
+int sched_trace_initialize(void);
+
+# else
+
+/* Only arg0 is evaluated, the thread is often looked up for the trace */
+#  define sched_trace(type, thread, arg0, arg1) ((void)(arg0))
+
+# endif /* !CONFIG_SCHED_TRACE */
+
+#endif /* !SCHEDULER_TRACE_H */
@@ -50,6 +50,16 @@ int sys_thread_create(struct syscall *interface);
 int sys_thread_exit(struct syscall *interface);
 int sys_gettid(struct syscall *interface);
 
+/* Scheduling */
+int sys_sched_setattr(struct syscall *interface);
+int sys_sched_getattr(struct syscall *interface);
+int sys_thread_stats(struct syscall *interface);
+int sys_cpu_stats(struct syscall *interface);
+
+/* Futex */
+int sys_futex_wait(struct syscall *interface);
+int sys_futex_wake(struct syscall *interface);
+
 /* Interrupt */
 int sys_interrupt_register(struct syscall *interface);
 int sys_interrupt_listen(struct syscall *interface);
@@ -87,6 +97,20 @@ int sys_vfs_open_device(struct syscall *interface);
 /* Fs - channel */
 int sys_fs_channel_create(struct syscall *interface);
 int sys_fs_channel_open(struct syscall *interface);
+int sys_fs_channel_reply_wait(struct syscall *interface);
+int sys_fs_channel_reply_wait_batch(struct syscall *interface);
+
+/* Fs - poll */
+int sys_fs_poll_create(struct syscall *interface);
+int sys_fs_poll_ctl(struct syscall *interface);
+int sys_fs_poll_wait(struct syscall *interface);
+
+/* Fs - aio */
+int sys_fs_aio_setup(struct syscall *interface);
+int sys_fs_aio_enter(struct syscall *interface);
+
+/* Vfs - getdents */
+int sys_vfs_getdents(struct syscall *interface);
 
 /* Fs */
 int sys_fs_register(struct syscall *interface);
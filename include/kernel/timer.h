@@ -104,10 +104,24 @@ void timer_handler(struct irq_regs *regs);
  *  \param  callback    The callback to call when the timer expires
  *  \param  data        The data to pass to the callback
  *
- *  \return 0: Everything went well
+ *  \return The timer id (>= 0): Everything went well
  *  \return -EINVAL: Invalid argument
+ *  \return -EAGAIN: No timer available
  */
 int timer_register(int type, tick_t time, timer_callback_t callback,
                    long data);
 
+/**
+ *  \brief  Unregister a timer before it expires
+ *
+ *  \param  timer       The timer id returned by timer_register()
+ *  \param  callback    The callback the timer was registered with
+ *  \param  data        The data the timer was registered with
+ *
+ *  \return 0: Everything went well
+ *  \return -EINVAL: The timer already expired (\a callback and \a data are
+ *          used to detect that its id has been reused)
+ */
+int timer_unregister(int timer, timer_callback_t callback, long data);
+
 #endif /* !TIMER_H */
@@ -0,0 +1,158 @@
+#include <string.h>
+
+#include <kernel/zos.h>
+#include <kernel/panic.h>
+#include <kernel/cpu.h>
+#include <kernel/interrupt.h>
+
+#include <kernel/mem/kmalloc.h>
+
+#include <kernel/proc/thread.h>
+
+#include <arch/fpu.h>
+
+static int has_fxsr;
+static int has_sse;
+
+static void *fpu_area(struct thread *thread)
+{
+    return (void *)align((uintptr_t)thread->regs.fpu, FPU_STATE_ALIGN);
+}
+
+static void fpu_save(struct thread *thread)
+{
+    if (has_fxsr)
+        fpu_fxsave(fpu_area(thread));
+    else
+        fpu_fnsave(fpu_area(thread));
+}
+
+static void fpu_restore(struct thread *thread)
+{
+    if (has_fxsr)
+        fpu_fxrstor(fpu_area(thread));
+    else
+        fpu_frstor(fpu_area(thread));
+}
+
+static void fpu_reset(void)
+{
+    uint32_t mxcsr = FPU_MXCSR_DEFAULT;
+
+    __asm__ __volatile__("fninit\n");
+
+    /* fninit does not touch SSE state, do not leak the previous owner one */
+    if (has_sse)
+        __asm__ __volatile__("ldmxcsr %0\n" : : "m" (mxcsr));
+}
+
+void fpu_initialize(struct cpu *cpu)
+{
+    uint32_t eax, ebx, ecx, edx;
+    uint32_t cr4;
+
+    cpu_cpuid(1, &eax, &ebx, &ecx, &edx);
+
+    has_fxsr = !!(edx & CPUID_EDX_FXSR);
+    has_sse = has_fxsr && (edx & CPUID_EDX_SSE);
+
+    /* Native FPU error reporting, and trap on FPU use when TS is set */
+    cr0_set((cr0_get() & ~CR0_EM) | CR0_MP | CR0_NE | CR0_TS);
+
+    if (has_fxsr) {
+        cr4 = cr4_get() | CR4_OSFXSR;
+
+        if (has_sse)
+            cr4 |= CR4_OSXMMEXCPT;
+
+        cr4_set(cr4);
+    }
+
+    cpu->arch.fpu_owner = NULL;
+
+    if (interrupt_register(IRQ_DEVICE_NOT_AVAILABLE, INTERRUPT_CALLBACK,
+                           fpu_handler) < 0)
+        kernel_panic("Fail to register the FPU handler");
+}
+
+void fpu_handler(struct irq_regs *regs)
+{
+    struct cpu *cpu = cpu_get(cpu_id_get());
+    struct thread *thread = thread_current();
+
+    (void)regs;
+
+    fpu_clts();
+
+    if (cpu->arch.fpu_owner == thread)
+        return;
+
+    if (cpu->arch.fpu_owner)
+        fpu_save(cpu->arch.fpu_owner);
+
+    cpu->arch.fpu_owner = thread;
+
+    if (thread->regs.fpu) {
+        fpu_restore(thread);
+        return;
+    }
+
+    /* First FPU instruction of the thread, start with a clean state */
+    thread->regs.fpu = kmalloc(FPU_STATE_SIZE + FPU_STATE_ALIGN);
+    if (!thread->regs.fpu)
+        kernel_panic("FPU: Out of memory");
+
+    fpu_reset();
+}
+
+void fpu_switch(struct cpu *cpu, struct thread *new)
+{
+    if (cpu->arch.fpu_owner == new)
+        fpu_clts();
+    else
+        cr0_set(cr0_get() | CR0_TS);
+}
+
+int fpu_duplicate(struct thread *dst, struct thread *src)
+{
+    struct cpu *cpu = cpu_get(cpu_id_get());
+
+    dst->regs.fpu = NULL;
+
+    if (!src->regs.fpu)
+        return 1;
+
+    dst->regs.fpu = kmalloc(FPU_STATE_SIZE + FPU_STATE_ALIGN);
+    if (!dst->regs.fpu)
+        return 0;
+
+    /* Flush the live registers if the parent owns the FPU */
+    if (cpu->arch.fpu_owner == src) {
+        fpu_clts();
+        fpu_save(src);
+
+        /* fnsave reinitializes the FPU, reload the parent state */
+        if (!has_fxsr)
+            fpu_restore(src);
+    }
+
+    memcpy(fpu_area(dst), fpu_area(src), FPU_STATE_SIZE);
+
+    return 1;
+}
+
+void fpu_release(struct thread *thread)
+{
+    struct cpu *cpu = cpu_get(cpu_id_get());
+
+    /* Make sure the next FPU use traps instead of reusing the stale state */
+    if (cpu->arch.fpu_owner == thread) {
+        cpu->arch.fpu_owner = NULL;
+        cr0_set(cr0_get() | CR0_TS);
+    }
+
+    if (thread->regs.fpu) {
+        kfree(thread->regs.fpu);
+        thread->regs.fpu = NULL;
+    }
+}
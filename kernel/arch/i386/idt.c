@@ -24,6 +24,16 @@ void idt_add_entry(uint8_t num, uint32_t address, uint16_t type)
     entry->type = type;
 }
 
+void idt_add_task_gate(uint8_t num, uint16_t selector)
+{
+    struct idt_entry *entry = &idt_entries[num];
+
+    entry->offsetl = 0;
+    entry->offseth = 0;
+    entry->select = selector;
+    entry->type = TASK_GATE;
+}
+
 void idt_initialize(void)
 {
     /* Add each isr in the IDT */
@@ -3,6 +3,7 @@
 
 #include <arch/scheduler.h>
 #include <arch/pm.h>
+#include <arch/fpu.h>
 
 void i386_switch(struct irq_regs *regs, struct thread *new,
                  struct thread *old, spinlock_t *sched_lock)
@@ -12,6 +13,8 @@ void i386_switch(struct irq_regs *regs, struct thread *new,
 
     thread_save_state(old, regs);
 
+    fpu_switch(cpu, new);
+
     /* We manually unlock the mutex to avoid interrupt to occur here */
     spinlock_unlock_no_restore(sched_lock);
 
@@ -0,0 +1,114 @@
+#include <kernel/config.h>
+#include <kernel/cpu.h>
+
+#include <arch/spinlock.h>
+
+#ifdef CONFIG_SPINLOCK_STAT
+# include <kernel/console.h>
+#endif /* !CONFIG_SPINLOCK_STAT */
+
+struct spinlock_irq spinlock_irq_state[CPU_COUNT];
+
+#ifdef CONFIG_SPINLOCK_STAT
+
+/*
+ * Statistics are kept per lock class (the place where the lock has been
+ * initialized) rather than per lock, as locks embedded in freed objects
+ * would otherwise leave dangling entries
+ */
+# define SPINLOCK_STAT_MAX 64
+
+struct spinlock_stat
+{
+    const char *name;
+
+    uint32_t acquired;
+    uint32_t contended;
+    uint32_t spins;
+    uint32_t hold_max;
+};
+
+static struct spinlock_stat stats[SPINLOCK_STAT_MAX];
+static struct ticket stats_lock = TICKET_INIT;
+
+static int spinlock_stat_class(const char *name)
+{
+    int i;
+
+    ticket_lock(&stats_lock);
+
+    for (i = 0; i < SPINLOCK_STAT_MAX && stats[i].name; ++i)
+    {
+        if (stats[i].name == name)
+            break;
+    }
+
+    if (i == SPINLOCK_STAT_MAX)
+        i = -1;
+    else
+        stats[i].name = name;
+
+    ticket_unlock(&stats_lock);
+
+    return i;
+}
+
+void spinlock_stat_acquired(const char *name, int *stat, uint32_t spins)
+{
+    struct spinlock_stat *s;
+
+    if (*stat < 0)
+    {
+        if (!name)
+            name = "<unnamed>";
+
+        *stat = spinlock_stat_class(name);
+
+        if (*stat < 0)
+            return;
+    }
+
+    s = &stats[*stat];
+
+    ++s->acquired;
+
+    if (spins)
+    {
+        ++s->contended;
+        s->spins += spins;
+    }
+}
+
+void spinlock_stat_released(int stat, uint64_t cycles)
+{
+    if (stat < 0)
+        return;
+
+    if (cycles > stats[stat].hold_max)
+        stats[stat].hold_max = cycles > 0xFFFFFFFF ? 0xFFFFFFFF : cycles;
+}
+
+void spinlock_stat_dump(void)
+{
+    struct spinlock_stat copy[SPINLOCK_STAT_MAX];
+
+    /* Take a snapshot, printing with the lock held would account itself */
+    spinlock_irq_save();
+    ticket_lock(&stats_lock);
+
+    for (int i = 0; i < SPINLOCK_STAT_MAX; ++i)
+        copy[i] = stats[i];
+
+    ticket_unlock(&stats_lock);
+    spinlock_irq_restore(1);
+
+    console_message(T_INF, "Lock statistics (acquired/contended/spins/"
+                    "max hold cycles)");
+
+    for (int i = 0; i < SPINLOCK_STAT_MAX && copy[i].name; ++i)
+        console_message(T_INF, "%s: %u %u %u %u", copy[i].name,
+                        copy[i].acquired, copy[i].contended, copy[i].spins,
+                        copy[i].hold_max);
+}
+
+#endif /* !CONFIG_SPINLOCK_STAT */
@@ -0,0 +1,21 @@
+#include <kernel/cpu.h>
+
+#include <arch/sysenter.h>
+#include <arch/pm.h>
+
+void sysenter_initialize(struct cpu *cpu)
+{
+    if (!sysenter_supported())
+        return;
+
+    cpu_set_msr(MSR_SYSENTER_CS, KERNEL_CS, 0);
+
+    /*
+     * sysenter does not switch to the kernel stack of the running thread,
+     * so esp points to tss.esp0 which is updated on every context switch
+     * and sysenter_entry loads the real stack from there
+     */
+    cpu_set_msr(MSR_SYSENTER_ESP, (uint32_t)&cpu->arch.tss.esp0, 0);
+
+    cpu_set_msr(MSR_SYSENTER_EIP, (uint32_t)sysenter_entry, 0);
+}
@@ -9,6 +9,7 @@
 #include <arch/thread.h>
 #include <arch/pm.h>
 #include <arch/mmu.h>
+#include <arch/fpu.h>
 
 /* FIXME: Disgusting */
 /* FIXME: If deep_argv_copy is set we modify argv, don't do that ! */
@@ -132,9 +133,14 @@ static int i386_setup_stack(char *stack, paddr_t phy_stack, int argc,
 }
 
 int i386_thread_create(struct process *p, struct thread *t, uintptr_t eip,
-                       int argc, char *argv[], int deep_argv_copy)
+                       int argc, char *argv[], int flags)
 {
-    if (p->type == PROCESS_TYPE_KERNEL)
+    int deep_argv_copy = flags & THREAD_CREATEF_DEEP_ARGV_COPY;
+
+    /* A new program (execv) starts with a clean FPU state */
+    fpu_release(t);
+
+    if (p->type == PROCESS_TYPE_KERNEL || flags & THREAD_CREATEF_KERNEL)
     {
         t->regs.cs = KERNEL_CS;
         t->regs.ds = KERNEL_DS;
@@ -229,7 +235,7 @@ int i386_thread_duplicate(struct thread *thread, struct irq_regs *regs)
     /* Called by fork, configuration the son, must return 0 */
     thread->regs.eax = 0;
 
-    return 1;
+    return fpu_duplicate(thread, thread_current());
 }
 
 int i386_thread_current(void)
@@ -249,6 +255,13 @@ int i386_thread_current(void)
     return esp;
 }
 
+int i386_thread_destroy(struct thread *thread)
+{
+    fpu_release(thread);
+
+    return 1;
+}
+
 int i386_thread_save_state(struct thread *thread, struct irq_regs *regs)
 {
     if (!thread || !regs)
@@ -0,0 +1,55 @@
+#include <kernel/time.h>
+
+#include <arch/tsc.h>
+#include <arch/pit.h>
+#include <arch/io.h>
+
+#define NSEC_PER_MSEC 1000000
+
+uint32_t tsc_calibrate(uint64_t *base)
+{
+    uint32_t latch = PIT_RATE / (MSEC_PER_SEC / TSC_CALIBRATE_MS);
+    uint64_t start;
+    uint64_t end;
+
+    if (!tsc_supported())
+        return 0;
+
+    /* Enable the gate of channel 2 but keep the speaker quiet */
+    outb(PIT_CTRL_PORT, (inb(PIT_CTRL_PORT) & ~PIT_CTRL_SPEAKER) |
+                        PIT_CTRL_GATE2);
+
+    /* Channel 2, lobyte/hibyte, mode 0 (interrupt on terminal count) */
+    outb(PIT_CMD, 0xB0);
+    outb(PIT2_DATA, latch & 0xFF);
+    outb(PIT2_DATA, (latch >> 8) & 0xFF);
+
+    start = tsc_read();
+
+    while (!(inb(PIT_CTRL_PORT) & PIT_CTRL_OUT2))
+        ;
+
+    end = tsc_read();
+
+    *base = end;
+
+    /* The delta fits on 32 bits for any frequency below 400 GHz */
+    return (uint32_t)(end - start) / TSC_CALIBRATE_MS;
+}
+
+uint32_t tsc_mult(uint32_t khz, uint32_t shift)
+{
+    uint64_t dividend = (uint64_t)NSEC_PER_MSEC << shift;
+    uint32_t mult;
+
+    /* The quotient must fit in 32 bits for divl */
+    if (!khz || (uint32_t)(dividend >> 32) >= khz)
+        return 0;
+
+    __asm__ ("divl %3"
+             : "=a"(mult)
+             : "a"((uint32_t)dividend), "d"((uint32_t)(dividend >> 32)),
+               "rm"(khz));
+
+    return mult;
+}
@@ -1,11 +1,78 @@
 #include <string.h>
 
 #include <kernel/cpu.h>
+#include <kernel/panic.h>
+#include <kernel/console.h>
+
+#include <kernel/proc/kstack.h>
 
 #include <arch/tss.h>
 #include <arch/gdt.h>
+#include <arch/idt.h>
+#include <arch/mmu.h>
 #include <arch/pm.h>
 
+static uint8_t df_stacks[CPU_COUNT][PAGE_SIZE] __attribute__((aligned(16)));
+
+/*
+ * Entry point of the double fault task. The state of the faulting code has
+ * been saved in the main TSS by the task switch
+ */
+static void double_fault_task(void)
+{
+    struct cpu *cpu = cpu_get(cpu_id_get());
+    struct thread *thread = cpu->scheduler.running;
+    uint32_t esp = cpu->arch.tss.esp;
+
+    if (thread)
+    {
+        vaddr_t stack = align(thread->kstack, PAGE_SIZE) - PAGE_SIZE;
+        vaddr_t guard = stack - KSTACK_GUARD_PAGES * PAGE_SIZE;
+
+        /* The fault happened while pushing on or below the guard pages */
+        if (esp >= guard && esp < stack + 64)
+            console_message(T_ERR, "Kernel stack overflow (pid %i, tid %i)",
+                            thread->parent->pid, thread->tid);
+    }
+
+    console_message(T_ERR, "Double fault at eip 0x%x, esp 0x%x",
+                    cpu->arch.tss.eip, esp);
+
+    kernel_panic("Double fault");
+}
+
+static void df_tss_initialize(struct cpu *cpu)
+{
+    struct tss *tss = &cpu->arch.df_tss;
+
+    memset(tss, 0, sizeof (struct tss));
+
+    tss->cr3 = cr3_get();
+    tss->eip = (uint32_t)double_fault_task;
+    tss->eflags = 0x2;
+    tss->esp = (uint32_t)&df_stacks[cpu->id][PAGE_SIZE];
+    tss->esp0 = tss->esp;
+    tss->ss0 = KERNEL_DS;
+
+    tss->cs = KERNEL_CS;
+    tss->ss = KERNEL_DS;
+    tss->ds = KERNEL_DS;
+    tss->es = KERNEL_DS;
+    tss->fs = KERNEL_DS;
+    tss->gs = KERNEL_DS;
+
+    tss->io = sizeof (struct tss);
+
+    gdt_add_entry(GDT_DF_TSS_BASE + cpu->id, (uint32_t)tss,
+                  sizeof (struct tss) - 1, TSS(0), 0);
+
+    /*
+     * A stack overflow hits the guard page, and the page fault cannot be
+     * delivered on the same stack. The task gate switches to a fresh stack
+     */
+    idt_add_task_gate(IRQ_DOUBLE_FAULT, DF_TSS_SELECTOR(cpu->id));
+}
+
 void tss_initialize(struct cpu *cpu)
 {
     int16_t tss_sel = TSS_SELECTOR(cpu->id);
@@ -19,6 +86,8 @@ void tss_initialize(struct cpu *cpu)
 
     cpu->arch.tss.ss0 = KERNEL_DS;
 
+    df_tss_initialize(cpu);
+
     __asm__ __volatile__ ("mov %0, %%ax\n"
                           "ltr %%ax\n"
                           :
@@ -8,6 +8,8 @@
 #include <kernel/proc/process.h>
 #include <kernel/proc/kthread.h>
 
+#include <kernel/scheduler/trace.h>
+
 static struct cpu *cpus;
 
 static void idle_thread(void)
@@ -50,22 +52,48 @@ void cpu_initialize(void)
     }
 
     console_message(T_OK, "Kernel idle process initialized");
+
+#ifdef CONFIG_SCHED_TRACE
+    if (sched_trace_initialize() < 0)
+        console_message(T_ERR, "Cannot create the scheduler trace device");
+#endif /* !CONFIG_SCHED_TRACE */
 }
 
 void cpu_add_thread(struct thread *thread)
 {
-    struct cpu *cpu = &cpus[0];
-    size_t num_thread = cpus[0].scheduler.thread_num;
+    struct cpu *cpu = NULL;
 
-    for (int i = 1; i < CPU_COUNT; ++i)
+    /* Least loaded cpu the thread is allowed to run on */
+    for (int i = 0; i < CPU_COUNT; ++i)
     {
-        if (cpus[i].scheduler.thread_num < num_thread)
+        if (!(thread->sattr.affinity & (1U << cpus[i].id)))
+            continue;
+
+        if (!cpu || cpus[i].scheduler.thread_num < cpu->scheduler.thread_num)
             cpu = &cpus[i];
     }
 
+    if (!cpu)
+        cpu = &cpus[0];
+
     thread->cpu = cpu->id;
 
-    scheduler_add_thread(&cpu->scheduler, thread);
+#ifdef CONFIG_SCHED_TRACE
+    {
+        struct thread *waker = thread_current();
+
+        sched_trace(SCHED_TRACE_WAKEUP, thread,
+                    waker ? waker->parent->pid : -1, waker ? waker->tid : -1);
+    }
+#endif /* !CONFIG_SCHED_TRACE */
+
+    /*
+     * The local cpu reschedules on its way out of the current interrupt or
+     * syscall, a remote one has to be kicked
+     */
+    if (scheduler_add_thread(&cpu->scheduler, thread) &&
+        cpu->id != cpu_id_get())
+        glue_call(cpu, resched, cpu);
 }
 
 void cpu_start(void)
@@ -98,3 +126,13 @@ struct cpu *cpu_get(int id)
 
     return cpu;
 }
+
+int cpu_stats_collect(struct sched_cpu_stats *stats, int count)
+{
+    int n = 0;
+
+    for (; n < CPU_COUNT && n < count; ++n)
+        stats[n] = cpus[n].scheduler.stats;
+
+    return n;
+}
@@ -0,0 +1,397 @@
+/*
+ * zOS
+ * Copyright (C) 2015 Baptiste Covolato
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zOS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file    kernel/core/fs/aio.c
+ * \brief   Implementation of the asynchronous VFS operations
+ *
+ * aio_enter() copies the submissions out of the ring and queues them, a pool
+ * of workers executes them with the regular vfs_*() functions and posts the
+ * completions. The workers are kernel mode threads of the process itself:
+ * they share its file descriptors and address space, so the buffers of the
+ * requests are used in place, exactly like during a system call.
+ *
+ * \author  Baptiste Covolato
+ */
+
+#include <string.h>
+
+#include <kernel/errno.h>
+#include <kernel/cpu.h>
+#include <kernel/scheduler.h>
+
+#include <kernel/mem/as.h>
+#include <kernel/mem/segment.h>
+#include <kernel/mem/kmalloc.h>
+
+#include <kernel/proc/process.h>
+#include <kernel/proc/thread.h>
+
+#include <kernel/fs/aio.h>
+#include <kernel/fs/vfs/vops.h>
+
+/* The entries written by one side must be visible before the index */
+#define aio_barrier() __asm__ __volatile__("" : : : "memory")
+
+static void aio_free(struct aio *aio)
+{
+    as_unmap(&kernel_as, (vaddr_t)aio->ring, AS_UNMAP_RELEASE);
+
+    kfree(aio);
+}
+
+void aio_put(struct aio *aio)
+{
+    int last;
+
+    spinlock_lock(&aio->lock);
+    last = !--aio->ref;
+    spinlock_unlock(&aio->lock);
+
+    if (last)
+        aio_free(aio);
+}
+
+static void aio_worker_exit(struct thread *t)
+{
+    struct cpu *cpu = cpu_get(cpu_id_get());
+
+    thread_exit(t);
+
+    cpu->scheduler.time = 1;
+
+    scheduler_update(NULL, 1);
+}
+
+/*
+ * The path is checked page by page up to its terminating byte, vfs_open() and
+ * vfs_stat() read it with strlen()
+ */
+static int aio_path_check(struct as *as, const char *path)
+{
+    for (size_t len = 0; len < AIO_PATH_MAX; ++len, ++path) {
+        if ((!len || !((vaddr_t)path & (PAGE_SIZE - 1))) &&
+            !as_is_mapped(as, (vaddr_t)path, 1))
+            return -EFAULT;
+
+        if (!*path)
+            return 0;
+    }
+
+    return -ENAMETOOLONG;
+}
+
+static int aio_execute(struct thread *t, struct aio_sqe *sqe)
+{
+    int ret;
+    struct as *as = t->parent->as;
+
+    switch (sqe->op) {
+    case AIO_OP_NOP:
+        return 0;
+
+    case AIO_OP_OPEN:
+        ret = aio_path_check(as, sqe->path);
+        if (ret < 0)
+            return ret;
+
+        return vfs_open(t, sqe->path, sqe->flags, sqe->mode);
+
+    case AIO_OP_CLOSE:
+        return vfs_close(t, sqe->fd);
+
+    case AIO_OP_READ:
+        if (!as_is_mapped(as, (vaddr_t)sqe->buf, sqe->size))
+            return -EFAULT;
+
+        return vfs_read(t, sqe->fd, sqe->buf, sqe->size);
+
+    case AIO_OP_WRITE:
+        if (!as_is_mapped(as, (vaddr_t)sqe->buf, sqe->size))
+            return -EFAULT;
+
+        return vfs_write(t, sqe->fd, sqe->buf, sqe->size);
+
+    case AIO_OP_STAT:
+        ret = aio_path_check(as, sqe->path);
+        if (ret < 0)
+            return ret;
+
+        if (!as_is_mapped(as, (vaddr_t)sqe->buf, sizeof (struct stat)))
+            return -EFAULT;
+
+        return vfs_stat(t, sqe->path, sqe->buf);
+
+    case AIO_OP_FSTAT:
+        if (!as_is_mapped(as, (vaddr_t)sqe->buf, sizeof (struct stat)))
+            return -EFAULT;
+
+        return vfs_fstat(t, sqe->fd, sqe->buf);
+
+    case AIO_OP_GETDIRENT:
+        if (!as_is_mapped(as, (vaddr_t)sqe->buf, sizeof (struct dirent)))
+            return -EFAULT;
+
+        return vfs_getdirent(t, sqe->fd, sqe->buf, sqe->flags);
+
+    default:
+        return -EINVAL;
+    }
+}
+
+static void aio_worker(void)
+{
+    int ret;
+    struct thread *t = thread_current();
+    struct aio *aio = t->aio;
+    struct aio_request *req;
+    struct aio_cqe *cqe;
+
+    /* The process went away before the worker ran for the first time */
+    if (aio->dead)
+        aio_worker_exit(t);
+
+    for (;;) {
+        wait_queue_wait(&aio->work, t, !klist_empty(&aio->pending));
+
+        spinlock_lock(&aio->lock);
+
+        req = klist_first_elem(&aio->pending, struct aio_request, list);
+        if (!req) {
+            spinlock_unlock(&aio->lock);
+            continue;
+        }
+
+        klist_del(&req->list);
+
+        spinlock_unlock(&aio->lock);
+
+        ret = aio_execute(t, &req->sqe);
+
+        spinlock_lock(&aio->lock);
+
+        /* Its reference is dropped when the thread is destroyed */
+        if (aio->dead) {
+            spinlock_unlock(&aio->lock);
+
+            aio_worker_exit(t);
+        }
+
+        cqe = &aio->ring->cq[aio->ring->cq_tail & (AIO_CQ_ENTRIES - 1)];
+        cqe->data = req->sqe.data;
+        cqe->res = ret;
+
+        aio_barrier();
+
+        ++aio->ring->cq_tail;
+        --aio->inflight;
+
+        klist_add(&aio->free, &req->list);
+
+        spinlock_unlock(&aio->lock);
+
+        wait_queue_notify(&aio->complete);
+    }
+}
+
+int aio_setup(struct thread *t, vaddr_t *uaddr)
+{
+    int tid;
+    int workers = 0;
+    struct process *p = t->parent;
+    struct thread *worker;
+    struct aio *aio;
+
+    if (p->aio)
+        return -EBUSY;
+
+    aio = kmalloc(sizeof (struct aio));
+    if (!aio)
+        return -ENOMEM;
+
+    aio->ring = (void *)as_map(&kernel_as, 0, 0, AIO_RING_SIZE, AS_MAP_WRITE);
+    if (!aio->ring) {
+        kfree(aio);
+        return -ENOMEM;
+    }
+
+    memset(aio->ring, 0, AIO_RING_SIZE);
+
+    aio->uaddr = as_map_kernel(p->as, 0, aio->ring, AIO_RING_SIZE,
+                               AS_MAP_USER | AS_MAP_WRITE);
+    if (!aio->uaddr) {
+        aio_free(aio);
+        return -ENOMEM;
+    }
+
+    klist_head_init(&aio->pending);
+    klist_head_init(&aio->free);
+
+    for (int i = 0; i < AIO_CQ_ENTRIES; ++i)
+        klist_add(&aio->free, &aio->requests[i].list);
+
+    aio->inflight = 0;
+    aio->ref = 1;
+    aio->dead = 0;
+
+    spinlock_init(&aio->lock);
+    wait_queue_init(&aio->work);
+    wait_queue_init(&aio->complete);
+
+    spinlock_lock(&p->plock);
+
+    if (p->aio) {
+        spinlock_unlock(&p->plock);
+
+        as_unmap(p->as, aio->uaddr, AS_UNMAP_RELEASE);
+        aio_free(aio);
+
+        return -EBUSY;
+    }
+
+    p->aio = aio;
+
+    spinlock_unlock(&p->plock);
+
+    for (int i = 0; i < AIO_WORKERS; ++i) {
+        tid = thread_create(p, (uintptr_t)aio_worker, 0, NULL,
+                            THREAD_CREATEF_KERNEL |
+                            THREAD_CREATEF_NOSTART_THREAD);
+        if (tid < 0)
+            break;
+
+        worker = thread_get(p, tid);
+
+        worker->uid = t->uid;
+        worker->gid = t->gid;
+
+        spinlock_lock(&aio->lock);
+        ++aio->ref;
+        spinlock_unlock(&aio->lock);
+
+        worker->aio = aio;
+
+        cpu_add_thread(worker);
+
+        ++workers;
+    }
+
+    if (!workers) {
+        p->aio = NULL;
+
+        as_unmap(p->as, aio->uaddr, AS_UNMAP_RELEASE);
+        aio_put(aio);
+
+        return -EAGAIN;
+    }
+
+    *uaddr = aio->uaddr;
+
+    return 0;
+}
+
+int aio_enter(struct thread *t, int to_submit, int min_complete)
+{
+    int submitted = 0;
+    struct aio *aio = t->parent->aio;
+    struct aio_ring *ring;
+    struct aio_request *req;
+
+    if (!aio)
+        return -EINVAL;
+
+    ring = aio->ring;
+
+    if (min_complete > AIO_CQ_ENTRIES)
+        min_complete = AIO_CQ_ENTRIES;
+
+    spinlock_lock(&aio->lock);
+
+    while (submitted < to_submit && ring->sq_head != ring->sq_tail) {
+        /* Every request in flight must find room for its completion */
+        if (aio->inflight + ring->cq_tail - ring->cq_head >= AIO_CQ_ENTRIES)
+            break;
+
+        req = klist_first_elem(&aio->free, struct aio_request, list);
+        if (!req)
+            break;
+
+        aio_barrier();
+
+        req->sqe = ring->sq[ring->sq_head & (AIO_SQ_ENTRIES - 1)];
+        ++ring->sq_head;
+
+        klist_del(&req->list);
+        klist_add_back(&aio->pending, &req->list);
+
+        ++aio->inflight;
+        ++submitted;
+    }
+
+    spinlock_unlock(&aio->lock);
+
+    for (int i = 0; i < submitted; ++i) {
+        if (!wait_queue_notify(&aio->work))
+            break;
+    }
+
+    if (min_complete > 0)
+        wait_queue_wait(&aio->complete, t,
+                        ring->cq_tail - ring->cq_head >=
+                        (uint32_t)min_complete || !aio->inflight);
+
+    return submitted;
+}
+
+void aio_exit(struct process *p)
+{
+    struct aio *aio = p->aio;
+    struct thread *t;
+
+    if (!aio)
+        return;
+
+    p->aio = NULL;
+
+    /*
+     * The workers waiting for a request are zombies, put them back in the
+     * scheduler so that they get destroyed. Each worker, idle or not, drops
+     * its reference on the context when it is destroyed
+     */
+    spinlock_lock(&aio->work.lock);
+
+    klist_for_each(&aio->work.threads, tlist, wait) {
+        t = klist_elem(tlist, struct thread, wait);
+
+        klist_del(&t->wait);
+
+        cpu_add_thread(t);
+    }
+
+    spinlock_unlock(&aio->work.lock);
+
+    spinlock_lock(&aio->lock);
+
+    aio->dead = 1;
+
+    spinlock_unlock(&aio->lock);
+
+    as_unmap(p->as, aio->uaddr, AS_UNMAP_RELEASE);
+
+    aio_put(aio);
+}
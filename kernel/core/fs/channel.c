@@ -28,15 +28,26 @@
 #include <kernel/errno.h>
 
 #include <kernel/mem/kmalloc.h>
+#include <kernel/mem/as.h>
+#include <kernel/mem/segment.h>
+
+#include <kernel/proc/process.h>
 
 #include <kernel/fs/vfs.h>
 #include <kernel/fs/channel.h>
+#include <kernel/fs/poll.h>
 
 #include <kernel/fs/vfs/message.h>
 
 #define MIN(x, y) (((x) < (y)) ? (x) : (y))
 
-static struct klist channels;
+/**
+ *  \brief  Number of buckets of the channel table (must be a power of 2)
+ */
+#define CHANNEL_HASH_SIZE 32
+
+static struct klist channel_buckets[CHANNEL_HASH_SIZE];
+static struct htable channels;
 static spinlock_t clock;
 
 static inline void channel_lock(void)
@@ -51,7 +62,8 @@ static inline void channel_unlock(void)
 
 int channel_initialize(void)
 {
-    klist_head_init(&channels);
+    htable_initialize(&channels, channel_buckets, CHANNEL_HASH_SIZE,
+                      CHANNEL_NAME_MAXL);
 
     spinlock_init(&clock);
 
@@ -79,16 +91,7 @@ static struct channel_slave *channel_get_slave(struct channel *channel,
 
 static struct channel *channel_from_name_nolock(const char *name)
 {
-    struct channel *channel;
-
-    klist_for_each_elem(&channels, channel, list) {
-        if (!strncmp(channel->name, name, CHANNEL_NAME_MAXL)) {
-            channel_unlock();
-            return channel;
-        }
-    }
-
-    return NULL;
+    return htable_get_elem(&channels, name, struct channel, hash);
 }
 
 struct channel *channel_from_name(const char *name)
@@ -104,31 +107,88 @@ struct channel *channel_from_name(const char *name)
     return channel;
 }
 
-static int channel_read_message(struct wait_queue *queue, struct klist *input,
-                                spinlock_t *lock, size_t size, void *buf)
+static void channel_limit_init(struct channel_limit *limit, size_t max_msgs,
+                               size_t max_bytes)
+{
+    limit->max_msgs = max_msgs;
+    limit->max_bytes = max_bytes;
+    limit->msgs = 0;
+    limit->bytes = 0;
+    limit->high_msgs = 0;
+    limit->high_bytes = 0;
+    limit->full = 0;
+
+    wait_queue_init(&limit->space);
+}
+
+static int channel_limit_room(struct channel_limit *limit, size_t size)
+{
+    return !limit->msgs || (limit->msgs < limit->max_msgs &&
+                            limit->bytes + size <= limit->max_bytes);
+}
+
+static void channel_limit_take(struct channel_limit *limit, size_t size)
+{
+    ++limit->msgs;
+    limit->bytes += size;
+
+    if (limit->msgs > limit->high_msgs)
+        limit->high_msgs = limit->msgs;
+    if (limit->bytes > limit->high_bytes)
+        limit->high_bytes = limit->bytes;
+}
+
+static void channel_limit_give(struct channel_limit *limit, size_t size)
+{
+    --limit->msgs;
+    limit->bytes -= size;
+}
+
+static struct channel_message *channel_pop_message(struct klist *input,
+                                                   spinlock_t *lock)
 {
-    size_t to_read;
     struct channel_message *message;
+    struct channel_limit *limit = NULL;
 
-    do {
-        /* Wait for a message to be received. If there is already a message
-         * on the first try, the function won't block
-         */
-        wait_queue_wait(queue, thread_current(), !klist_empty(input));
+    spinlock_lock(lock);
 
-        spinlock_lock(lock);
+    message = klist_first_elem(input, struct channel_message, list);
 
-        message = klist_first_elem(input, struct channel_message, list);
+    if (message) {
+        klist_del(&message->list);
 
-        if (message)
-            klist_del(&message->list);
+        /* The message leaves the queue, give its room back to the senders */
+        limit = message->limit;
+        if (limit) {
+            channel_limit_give(limit, message->size);
 
-        spinlock_unlock(lock);
-    } while (!message);
+            if (message->sender)
+                channel_limit_give(&message->sender->credit, message->size);
+
+            message->limit = NULL;
+        }
+    }
+
+    spinlock_unlock(lock);
+
+    /* Each sender checks its own share, wake them all up */
+    if (limit) {
+        while (wait_queue_notify(&limit->space))
+            ;
+    }
+
+    return message;
+}
+
+static int channel_copy_message(struct channel_message *message,
+                                struct klist *input, spinlock_t *lock,
+                                size_t size, void *buf)
+{
+    size_t to_read;
 
     to_read = MIN(message->size - message->off, size);
 
-    memcpy(buf, (char *)(message + 1) + message->off, to_read);
+    memcpy(buf, (char *)message->data + message->off, to_read);
 
     if (size < message->size) {
         message->off = message->size;
@@ -138,40 +198,170 @@ static int channel_read_message(struct wait_queue *queue, struct klist *input,
         klist_add(input, &message->list);
 
         spinlock_unlock(lock);
-    } else {
+    } else if (!message->call) {
         kfree(message);
     }
 
     return to_read;
 }
 
-static int channel_write_message(struct wait_queue *queue, struct klist *input,
-                                 spinlock_t *lock, uint16_t cid, size_t size,
-                                 void *buf)
+static int channel_read_message(struct wait_queue *queue, struct klist *input,
+                                spinlock_t *lock, size_t size, void *buf)
+{
+    struct channel_message *message;
+
+    do {
+        /* Wait for a message to be received. If there is already a message
+         * on the first try, the function won't block
+         */
+        wait_queue_wait(queue, thread_current(), !klist_empty(input));
+
+        message = channel_pop_message(input, lock);
+    } while (!message);
+
+    return channel_copy_message(message, input, lock, size, buf);
+}
+
+static struct channel_message *channel_new_message(uint16_t cid, size_t size,
+                                                   void *buf)
 {
     struct channel_message *message;
 
     message = kmalloc(sizeof (struct channel_message) + size);
     if (!message)
-        return -ENOMEM;
+        return NULL;
 
     message->cid = cid;
     message->size = size;
     message->off = 0;
+    message->data = message + 1;
+    message->call = 0;
+    message->limit = NULL;
+    message->sender = NULL;
 
-    memcpy(message + 1, buf, size);
+    memcpy(message->data, buf, size);
 
-    spinlock_lock(lock);
+    return message;
+}
 
-    klist_add_back(input, &message->list);
+/*
+ * Queue a message on a slave. Replies are bounded too: the share of the
+ * slave is given back as soon as the master reads a request, so a slave that
+ * never reads would otherwise grow its input without bound
+ */
+static int channel_write_slave(struct channel_slave *slave, void *buf,
+                               size_t size)
+{
+    struct channel_message *message;
 
-    spinlock_unlock(lock);
+    message = channel_new_message(slave->id, size, buf);
+    if (!message)
+        return -ENOMEM;
+
+    spinlock_lock(&slave->lock);
 
-    wait_queue_notify(queue);
+    if (!channel_limit_room(&slave->limit, size)) {
+        ++slave->limit.full;
+
+        spinlock_unlock(&slave->lock);
+
+        kfree(message);
+
+        return -EAGAIN;
+    }
+
+    channel_limit_take(&slave->limit, size);
+    message->limit = &slave->limit;
+
+    klist_add_back(&slave->input, &message->list);
+
+    spinlock_unlock(&slave->lock);
+
+    wait_queue_notify(&slave->wait);
 
     return size;
 }
 
+/*
+ * Complete the oldest pending call of a slave with a reply, or with an error
+ * if reply is NULL. Return the thread woken up, if it was blocked
+ */
+static struct thread *channel_call_complete(struct channel_slave *slave,
+                                            void *reply, size_t size,
+                                            int error)
+{
+    struct channel_call *call;
+    struct thread *thread;
+
+    spinlock_lock(&slave->lock);
+
+    call = klist_first_elem(&slave->calls, struct channel_call, list);
+    if (call)
+        klist_del(&call->list);
+
+    spinlock_unlock(&slave->lock);
+
+    if (!call)
+        return NULL;
+
+    if (reply) {
+        call->ret = MIN(size, call->reply_size);
+
+        memcpy(call->reply, reply, call->ret);
+    } else {
+        call->ret = error;
+    }
+
+    /* The caller may return as soon as done is set, call is invalid after */
+    thread = call->thread;
+    call->done = 1;
+
+    if (!wait_queue_notify_thread(&slave->wait, thread))
+        return NULL;
+
+    return thread;
+}
+
+/*
+ * Fail all the pending calls of a slave, the requests not read yet by the
+ * master are removed from its input
+ */
+static void channel_call_abort(struct channel_slave *slave)
+{
+    struct channel_call *call;
+    struct channel *channel = slave->parent;
+
+    spinlock_lock(&channel->lock);
+
+    spinlock_lock(&slave->lock);
+
+    klist_for_each_elem(&slave->calls, call, list)
+        klist_del(&call->request.list);
+
+    spinlock_unlock(&slave->lock);
+
+    spinlock_unlock(&channel->lock);
+
+    while (!klist_empty(&slave->calls))
+        channel_call_complete(slave, NULL, 0, -EPIPE);
+}
+
+/*
+ * Drop the mapping of a ring in the master. It is unmapped only if the
+ * address space lives on, otherwise it is released along with it
+ */
+static void channel_ring_detach(struct channel_ring *ring, int unmap)
+{
+    spinlock_lock(&ring->lock);
+
+    if (ring->as && unmap)
+        as_unmap(ring->as, ring->uaddr, AS_UNMAP_RELEASE);
+
+    ring->as = NULL;
+
+    spinlock_unlock(&ring->lock);
+}
+
 static int __channel_slave_read(struct file *file, struct process *p,
                                 struct req_rdwr *req, void *buf)
 {
@@ -276,7 +466,6 @@ int channel_create(const char *name, struct file *file,
                    struct channel **channel)
 {
     struct channel *new_channel;
-    struct channel *tmp;
 
     new_channel = kmalloc(sizeof (struct channel));
     if (!new_channel)
@@ -284,24 +473,33 @@ int channel_create(const char *name, struct file *file,
 
     channel_lock();
 
-    klist_for_each_elem(&channels, tmp, list) {
-        if (!strncmp(tmp->name, name, CHANNEL_NAME_MAXL)) {
-            channel_unlock();
-            kfree(new_channel);
-            return -EEXIST;
-        }
+    if (channel_from_name_nolock(name)) {
+        channel_unlock();
+        kfree(new_channel);
+        return -EEXIST;
     }
 
-    klist_add(&channels, &new_channel->list);
+    /* The name is the key of the channel, it must be set before the add */
+    strncpy(new_channel->name, name, CHANNEL_NAME_MAXL);
+
+    htable_add(&channels, &new_channel->hash, new_channel->name);
 
     channel_unlock();
 
-    strncpy(new_channel->name, name, CHANNEL_NAME_MAXL);
     new_channel->slave_id = 0;
+    new_channel->control = NULL;
+    new_channel->control_data = NULL;
+    new_channel->ready = 0;
+    wait_queue_init(&new_channel->ready_wait);
     new_channel->proc = thread_current()->parent;
     wait_queue_init(&new_channel->wait);
     klist_head_init(&new_channel->slaves);
     klist_head_init(&new_channel->input);
+    channel_limit_init(&new_channel->limit, CHANNEL_MAX_MSGS,
+                       CHANNEL_MAX_BYTES);
+    new_channel->users = 0;
+    new_channel->closed = 0;
+    new_channel->detached = 0;
     spinlock_init(&new_channel->lock);
 
     file->inode = NULL;
@@ -321,42 +519,207 @@ int channel_master_read(struct channel *channel, void *buf, size_t size)
                                 &channel->lock, size, buf);
 }
 
-int channel_master_write(struct channel *channel, void *buf, size_t size)
+/*
+ * The driver behind the channel announces the readiness of its device
+ */
+static int channel_ready_set(struct channel *channel, void *buf, size_t size)
+{
+    struct req_ready *req = buf;
+
+    if (size < sizeof (struct req_ready))
+        return -EINVAL;
+
+    channel->ready = req->events;
+
+    wait_queue_notify(&channel->ready_wait);
+
+    return size;
+}
+
+/*
+ * Send a message to a slave: it is the reply of the oldest pending call of
+ * the slave if there is one, otherwise it is queued
+ */
+static int channel_master_send(struct channel *channel, void *buf,
+                               size_t size, struct thread **woken)
 {
     struct channel_slave *slave;
     struct msg_header *hdr = buf;
 
+    *woken = NULL;
+
     if (size < sizeof (struct msg_header))
         return -EINVAL;
 
+    if (hdr->slave_id == CHANNEL_CONTROL_ID) {
+        if (hdr->op == VFS_READY)
+            return channel_ready_set(channel, buf, size);
+
+        if (!channel->control)
+            return -EINVAL;
+
+        channel->control(channel->control_data, buf, size);
+
+        return size;
+    }
+
     slave = channel_get_slave(channel, hdr->slave_id);
     if (!slave)
         return -EINVAL;
 
-    return channel_write_message(&slave->wait, &slave->input, &slave->lock,
-                                 slave->id, size - sizeof (struct msg_header),
-                                 hdr + 1);
+    size -= sizeof (struct msg_header);
+
+    if (klist_empty(&slave->calls))
+        return channel_write_slave(slave, hdr + 1, size);
+
+    *woken = channel_call_complete(slave, hdr + 1, size, 0);
+
+    return size;
+}
+
+int channel_master_write(struct channel *channel, void *buf, size_t size)
+{
+    struct thread *woken;
+
+    return channel_master_send(channel, buf, size, &woken);
+}
+
+int channel_master_reply_wait(struct channel *channel, void *reply,
+                              size_t reply_size, void *buf, size_t size)
+{
+    struct thread *woken = NULL;
+
+    /* Like a write, except that a reply that cannot be queued is dropped */
+    if (reply_size) {
+        if (reply_size < sizeof (struct msg_header))
+            return -EINVAL;
+
+        channel_master_send(channel, reply, reply_size, &woken);
+    }
+
+    /* Let the caller run right away if we are about to block */
+    if (woken && klist_empty(&channel->input))
+        scheduler_handoff(woken);
+
+    return channel_master_read(channel, buf, size);
+}
+
+int channel_master_reply_wait_batch(struct channel *channel,
+                                    struct channel_iovec *replies,
+                                    int nreply, struct channel_iovec *msgs,
+                                    int nmsg)
+{
+    struct channel_message *message;
+    struct thread *woken = NULL;
+    struct thread *last = NULL;
+    int ret;
+    int i;
+
+    if (nreply < 0 || nmsg <= 0)
+        return -EINVAL;
+
+    for (i = 0; i < nreply; ++i) {
+        if (replies[i].size < sizeof (struct msg_header))
+            return -EINVAL;
+    }
+
+    for (i = 0; i < nreply; ++i) {
+        channel_master_send(channel, replies[i].buf, replies[i].size,
+                            &woken);
+
+        if (woken)
+            last = woken;
+    }
+
+    /* Only the last caller woken up can be handed the timeslice */
+    if (last && klist_empty(&channel->input))
+        scheduler_handoff(last);
+
+    ret = channel_master_read(channel, msgs[0].buf, msgs[0].size);
+    if (ret < 0)
+        return ret;
+
+    msgs[0].size = ret;
+
+    /* Take the messages already queued, without blocking again */
+    for (i = 1; i < nmsg; ++i) {
+        message = channel_pop_message(&channel->input, &channel->lock);
+        if (!message)
+            break;
+
+        msgs[i].size = channel_copy_message(message, &channel->input,
+                                            &channel->lock, msgs[i].size,
+                                            msgs[i].buf);
+    }
+
+    return i;
+}
+
+void channel_control_set(struct channel *channel, channel_control_t control,
+                         void *data)
+{
+    spinlock_lock(&channel->lock);
+
+    channel->control_data = data;
+    channel->control = control;
+
+    spinlock_unlock(&channel->lock);
 }
 
 int channel_master_close(struct channel *channel)
 {
+    struct channel_slave *slave;
+    int last;
+
     channel_lock();
 
-    klist_del(&channel->list);
+    htable_del(&channel->hash);
 
-    channel_unlock();
+    /* Slaves cannot write or call past this point */
+    spinlock_lock(&channel->lock);
+    channel->closed = 1;
+    spinlock_unlock(&channel->lock);
 
-    /* XXX: We need to notify slaves if any */
+    /*
+     * Slaves blocked in channel_call() would never get their reply, the
+     * slaves blocked in channel_slave_write() are woken up below
+     */
+    klist_for_each_elem(&channel->slaves, slave, list) {
+        channel_call_abort(slave);
+
+        if (slave->ring)
+            channel_ring_detach(slave->ring, 1);
+    }
+
+    channel->detached = 1;
+
+    channel_unlock();
 
     klist_for_each(&channel->input, data, list) {
         struct channel_message *msg = klist_elem(data, struct channel_message,
                                                  list);
 
         klist_del(&msg->list);
-        kfree(msg);
+
+        if (!msg->call)
+            kfree(msg);
     }
 
-    kfree(channel);
+    poll_detach(&channel->wait);
+    poll_detach(&channel->ready_wait);
+
+    spinlock_lock(&channel->lock);
+
+    /* The slaves waiting for room return, the last one frees the channel */
+    while (wait_queue_notify(&channel->limit.space))
+        continue;
+
+    last = !channel->users;
+
+    spinlock_unlock(&channel->lock);
+
+    if (last)
+        kfree(channel);
 
     return 0;
 }
@@ -376,12 +739,22 @@ int channel_open(struct channel *channel, struct file *file,
 
     new_slave->id = channel->slave_id++;
 
+    /* That id addresses the kernel */
+    if (new_slave->id == CHANNEL_CONTROL_ID)
+        new_slave->id = channel->slave_id++;
+
     channel_unlock();
 
     new_slave->parent = channel;
     new_slave->proc = thread_current()->parent;
     wait_queue_init(&new_slave->wait);
     klist_head_init(&new_slave->input);
+    channel_limit_init(&new_slave->limit, CHANNEL_SLAVE_MAX_MSGS,
+                       CHANNEL_SLAVE_MAX_BYTES);
+    channel_limit_init(&new_slave->credit, CHANNEL_SLAVE_MAX_MSGS,
+                       CHANNEL_SLAVE_MAX_BYTES);
+    klist_head_init(&new_slave->calls);
+    new_slave->ring = NULL;
     spinlock_init(&new_slave->lock);
 
     if (file) {
@@ -428,24 +801,321 @@ int channel_slave_read(struct channel_slave *slave, void *buf, size_t size)
                                 size, buf);
 }
 
+static int channel_slave_room(struct channel_slave *slave, size_t size)
+{
+    return channel_limit_room(&slave->parent->limit, size) &&
+           channel_limit_room(&slave->credit, size);
+}
+
 int channel_slave_write(struct channel_slave *slave, void *buf, size_t size)
 {
-    struct channel *cparent;
+    struct channel *channel = slave->parent;
+    struct channel_message *message;
+    int last;
+
+    /* A blocked sender holds at most this message */
+    message = channel_new_message(slave->id, size, buf);
+    if (!message)
+        return -ENOMEM;
+
+    spinlock_lock(&channel->lock);
+
+    if (!channel->closed && !channel_slave_room(slave, size)) {
+        if (!channel_limit_room(&channel->limit, size))
+            ++channel->limit.full;
+        else
+            ++slave->credit.full;
+
+        ++channel->users;
+
+        do {
+            spinlock_unlock(&channel->lock);
+
+            wait_queue_wait(&channel->limit.space, thread_current(),
+                            channel->closed ||
+                            channel_slave_room(slave, size));
+
+            spinlock_lock(&channel->lock);
+        } while (!channel->closed && !channel_slave_room(slave, size));
+
+        --channel->users;
+    }
+
+    if (channel->closed) {
+        last = !channel->users;
+
+        spinlock_unlock(&channel->lock);
+
+        kfree(message);
+
+        if (last)
+            kfree(channel);
+
+        return -EPIPE;
+    }
+
+    channel_limit_take(&channel->limit, size);
+    channel_limit_take(&slave->credit, size);
+
+    message->limit = &channel->limit;
+    message->sender = slave;
+
+    klist_add_back(&channel->input, &message->list);
+
+    spinlock_unlock(&channel->lock);
+
+    wait_queue_notify(&channel->wait);
+
+    return size;
+}
+
+int channel_call(struct channel_slave *slave, void *buf, size_t size,
+                 void *reply, size_t reply_size)
+{
+    struct channel *channel = slave->parent;
+    struct channel_call call;
+    struct thread *master;
+
+    call.request.cid = slave->id;
+    call.request.size = size;
+    call.request.off = 0;
+    call.request.data = buf;
+    call.request.call = 1;
+    call.request.limit = NULL;
+    call.request.sender = NULL;
+
+    call.thread = thread_current();
+    call.reply = reply;
+    call.reply_size = reply_size;
+    call.ret = 0;
+    call.done = 0;
+
+    /* The call must be pending before the master can see the request */
+    spinlock_lock(&slave->lock);
+
+    klist_add_back(&slave->calls, &call.list);
+
+    spinlock_unlock(&slave->lock);
+
+    spinlock_lock(&channel->lock);
+
+    /* The master is gone, nobody would ever reply */
+    if (channel->closed) {
+        spinlock_unlock(&channel->lock);
+
+        spinlock_lock(&slave->lock);
+        klist_del(&call.list);
+        spinlock_unlock(&slave->lock);
+
+        return -EPIPE;
+    }
+
+    klist_add_back(&channel->input, &call.request.list);
+
+    spinlock_unlock(&channel->lock);
+
+    master = wait_queue_notify(&channel->wait);
+    if (master)
+        scheduler_handoff(master);
+
+    wait_queue_wait(&slave->wait, call.thread, call.done);
+
+    return call.ret;
+}
+
+int channel_ring_create(struct channel_slave *slave)
+{
+    struct channel_ring *ring;
+
+    ring = kmalloc(sizeof (struct channel_ring));
+    if (!ring)
+        return -ENOMEM;
+
+    ring->kaddr = (void *)as_map(&kernel_as, 0, 0, CHANNEL_RING_SIZE,
+                                 AS_MAP_WRITE);
+    if (!ring->kaddr) {
+        kfree(ring);
+        return -ENOMEM;
+    }
+
+    ring->head = 0;
+    ring->tail = 0;
+    ring->wrap = CHANNEL_RING_SIZE;
+    ring->used = 0;
+    spinlock_init(&ring->lock);
+
+    /* The master cannot go away while its address space is looked at */
+    channel_lock();
+
+    if (slave->parent->detached) {
+        channel_unlock();
+        as_unmap(&kernel_as, (vaddr_t)ring->kaddr, AS_UNMAP_RELEASE);
+        kfree(ring);
+        return -EPIPE;
+    }
+
+    ring->as = slave->parent->proc->as;
+    ring->uaddr = as_map_kernel(ring->as, 0, ring->kaddr, CHANNEL_RING_SIZE,
+                                AS_MAP_USER | AS_MAP_WRITE);
+    if (!ring->uaddr) {
+        channel_unlock();
+        as_unmap(&kernel_as, (vaddr_t)ring->kaddr, AS_UNMAP_RELEASE);
+        kfree(ring);
+        return -ENOMEM;
+    }
+
+    slave->ring = ring;
+
+    channel_unlock();
+
+    return 0;
+}
+
+void channel_process_exit(struct process *p)
+{
+    struct channel *channel;
+    struct channel_slave *slave;
+
+    channel_lock();
 
-    cparent = slave->parent;
+    for (int i = 0; i < CHANNEL_HASH_SIZE; ++i) {
+        klist_for_each_elem(&channel_buckets[i], channel, hash.list) {
+            if (channel->proc != p)
+                continue;
 
-    return channel_write_message(&cparent->wait, &cparent->input,
-                                 &cparent->lock, slave->id, size, buf);
+            channel->detached = 1;
+
+            klist_for_each_elem(&channel->slaves, slave, list) {
+                if (slave->ring)
+                    channel_ring_detach(slave->ring, 0);
+            }
+        }
+    }
+
+    channel_unlock();
+}
+
+static void channel_ring_destroy(struct channel_slave *slave)
+{
+    struct channel_ring *ring = slave->ring;
+
+    if (!ring)
+        return;
+
+    channel_ring_detach(ring, 1);
+
+    as_unmap(&kernel_as, (vaddr_t)ring->kaddr, AS_UNMAP_RELEASE);
+
+    kfree(ring);
+
+    slave->ring = NULL;
+}
+
+void *channel_ring_alloc(struct channel_slave *slave, size_t size,
+                         void **uaddr)
+{
+    struct channel_ring *ring = slave->ring;
+    size_t off;
+
+    if (!ring || !size || size > CHANNEL_RING_SIZE)
+        return NULL;
+
+    size = align(size, CHANNEL_RING_ALIGN);
+
+    spinlock_lock(&ring->lock);
+
+    /* The master cannot see the ring anymore */
+    if (!ring->as) {
+        spinlock_unlock(&ring->lock);
+        return NULL;
+    }
+
+    if (!ring->used) {
+        ring->head = 0;
+        ring->tail = 0;
+        ring->wrap = CHANNEL_RING_SIZE;
+    }
+
+    if (ring->wrap == CHANNEL_RING_SIZE &&
+        CHANNEL_RING_SIZE - ring->head >= size) {
+        /* Room at the end */
+        off = ring->head;
+    } else if (ring->wrap == CHANNEL_RING_SIZE && ring->tail >= size) {
+        /* Wrap around, the end of the ring is skipped */
+        ring->wrap = ring->head;
+        off = 0;
+    } else if (ring->wrap != CHANNEL_RING_SIZE &&
+               ring->tail - ring->head >= size) {
+        /* Room between the last buffer and the oldest one */
+        off = ring->head;
+    } else {
+        spinlock_unlock(&ring->lock);
+        return NULL;
+    }
+
+    ring->head = off + size;
+    ++ring->used;
+
+    spinlock_unlock(&ring->lock);
+
+    *uaddr = (void *)(ring->uaddr + off);
+
+    return ring->kaddr + off;
+}
+
+void channel_ring_release(struct channel_slave *slave, void *buf,
+                          size_t size)
+{
+    struct channel_ring *ring = slave->ring;
+    size_t off = (char *)buf - ring->kaddr;
+
+    spinlock_lock(&ring->lock);
+
+    /*
+     * Only the oldest buffer moves the tail, a buffer released out of order
+     * is reclaimed when the ring becomes empty
+     */
+    if (off == ring->tail) {
+        ring->tail = off + align(size, CHANNEL_RING_ALIGN);
+
+        if (ring->tail == ring->wrap) {
+            ring->tail = 0;
+            ring->wrap = CHANNEL_RING_SIZE;
+        }
+    }
+
+    --ring->used;
+
+    spinlock_unlock(&ring->lock);
 }
 
 int channel_slave_close(struct channel_slave *slave)
 {
+    struct channel *channel = slave->parent;
+    struct channel_message *msg;
+
     channel_lock();
 
     klist_del(&slave->list);
 
     channel_unlock();
 
+    channel_call_abort(slave);
+
+    /* The messages already sent stay queued, without a share to give back */
+    spinlock_lock(&channel->lock);
+
+    klist_for_each_elem(&channel->input, msg, list) {
+        if (msg->sender == slave)
+            msg->sender = NULL;
+    }
+
+    spinlock_unlock(&channel->lock);
+
+    channel_ring_destroy(slave);
+
+    poll_detach(&slave->wait);
+
     klist_for_each(&slave->input, data, list) {
         struct channel_message *msg = klist_elem(data, struct channel_message,
                                                  list);
@@ -148,6 +148,50 @@ static int devfs_getdirent(struct mount_entry __unused *mount, ino_t inode,
     return 1;
 }
 
+/*
+ * The cookie is the slot of the next device, so that listing the directory is
+ * a single walk of the device table
+ */
+static int devfs_getdents(struct mount_entry *mount, uid_t uid, gid_t gid,
+                          ino_t inode, void *buf, int count, int flags,
+                          uint32_t *cookie)
+{
+    struct device *device;
+    struct dirent_plus *rec;
+    size_t rec_size;
+    uint32_t slot;
+    int n = 0;
+
+    if (inode != DEVFS_INODE_ROOT)
+        return -EINVAL;
+
+    if (flags & GETDENTS_STAT)
+        rec_size = sizeof (struct dirent_plus);
+    else
+        rec_size = sizeof (struct dirent);
+
+    for (slot = *cookie; slot < VFS_MAX_DEVICE && n < count; ++slot) {
+        device = device_get(slot);
+        if (!device)
+            continue;
+
+        rec = (void *)((char *)buf + n * rec_size);
+
+        rec->d.d_ino = device->id;
+        strncpy(rec->d.d_name, device->name, VFS_DEV_MAX_NAMEL);
+        rec->d.d_name[VFS_DEV_MAX_NAMEL] = '\0';
+
+        if (flags & GETDENTS_STAT)
+            devfs_stat(mount, uid, gid, device->id, &rec->st);
+
+        ++n;
+    }
+
+    *cookie = slot;
+
+    return n;
+}
+
 static int devfs_create(struct fs_instance *fi, const char __unused *device,
                         const char __unused *mount_pt)
 {
@@ -176,6 +220,7 @@ static struct fs_operation devfs_ops = {
     .lookup = devfs_lookup,
     .stat = devfs_stat,
     .getdirent = devfs_getdirent,
+    .getdents = devfs_getdents,
 };
 
 static struct fs_super_operation devfs_sup_ops = {
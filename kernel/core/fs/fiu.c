@@ -4,8 +4,12 @@
 
 #include <kernel/mem/kmalloc.h>
 
+#include <kernel/cpu.h>
+
 #include <kernel/proc/process.h>
 #include <kernel/proc/thread.h>
+#include <kernel/proc/kthread.h>
+#include <kernel/proc/wait_queue.h>
 
 #include <kernel/fs/fiu.h>
 #include <kernel/fs/channel.h>
@@ -13,34 +17,85 @@
 
 #include <kernel/fs/vfs/message.h>
 #include <kernel/fs/vfs/mount.h>
+#include <kernel/fs/vfs/pcache.h>
 
 static int fiu_channel_read_rw(struct channel_slave *slave, void *buf_in,
                                size_t size_in, void *buf_out, size_t size_out)
 {
     int ret;
 
-    ret = channel_slave_write(slave, buf_in, size_in);
-    if (ret < 0)
-        return ret;
-
-    ret = channel_slave_read(slave, buf_out, size_out);
+    ret = channel_call(slave, buf_in, size_in, buf_out, size_out);
     if (ret < 0)
         return ret;
 
     return 0;
 }
 
+/*
+ * Take an idle slave of the instance, a new one is opened when the pool is
+ * empty. This keeps the global channel lock and allocations off the path of
+ * metadata operations
+ */
+static int fiu_slave_get(struct fiu_fs_instance *fi,
+                         struct channel_slave **slave)
+{
+    spinlock_lock(&fi->pool_lock);
+
+    if (fi->pool_count) {
+        *slave = fi->pool[--fi->pool_count];
+
+        spinlock_unlock(&fi->pool_lock);
+
+        return 0;
+    }
+
+    spinlock_unlock(&fi->pool_lock);
+
+    return channel_open(fi->channel, NULL, slave);
+}
+
+/*
+ * Give a slave back to the pool once its request is completed. It is closed
+ * if the pool is full or if the call failed, the master may be gone
+ */
+static void fiu_slave_put(struct fiu_fs_instance *fi,
+                          struct channel_slave *slave, int error)
+{
+    if (!error) {
+        spinlock_lock(&fi->pool_lock);
+
+        if (fi->pool_count < FIU_SLAVE_POOL_SIZE) {
+            fi->pool[fi->pool_count++] = slave;
+
+            spinlock_unlock(&fi->pool_lock);
+
+            return;
+        }
+
+        spinlock_unlock(&fi->pool_lock);
+    }
+
+    channel_slave_close(slave);
+}
+
 static int fiu_lookup(struct mount_entry *root, const char *path, uid_t uid,
                       gid_t gid, struct resp_lookup *resp)
 {
     int ret;
     int path_empty = 0;
+    uint32_t generation;
+    const char *key = path;
     struct req_lookup req;
     struct channel_slave *slave;
     struct process *pdevice;
     struct fiu_fs_instance *fi = root->fi->private;
 
-    ret = channel_open(fi->channel, NULL, &slave);
+    if (dcache_lookup(&fi->dcache, key, uid, gid, resp))
+        return resp->ret < 0 ? resp->ret : 0;
+
+    generation = dcache_generation(&fi->dcache);
+
+    ret = fiu_slave_get(fi, &slave);
     if (ret < 0)
         return ret;
 
@@ -74,13 +129,15 @@ static int fiu_lookup(struct mount_entry *root, const char *path, uid_t uid,
     if (ret < 0)
         goto error_unmap;
 
-    channel_slave_close(slave);
+    fiu_slave_put(fi, slave, 0);
 
     if (path_empty)
         resp->processed = 0;
 
     as_unmap(pdevice->as, (vaddr_t)req.path, AS_UNMAP_RELEASE);
 
+    dcache_add(&fi->dcache, generation, key, uid, gid, resp);
+
     if (resp->ret < 0)
         return resp->ret;
 
@@ -89,7 +146,7 @@ static int fiu_lookup(struct mount_entry *root, const char *path, uid_t uid,
 error_unmap:
     as_unmap(pdevice->as, (vaddr_t)req.path, AS_UNMAP_RELEASE);
 error:
-    channel_slave_close(slave);
+    fiu_slave_put(fi, slave, ret);
     return ret;
 }
 
@@ -97,6 +154,7 @@ static int fiu_stat(struct mount_entry *root, uid_t uid, gid_t gid,
                     ino_t inode, struct stat *buf)
 {
     int ret;
+    uint32_t generation;
     struct channel_slave *slave;
     struct req_stat req;
     struct resp_stat resp;
@@ -106,7 +164,13 @@ static int fiu_stat(struct mount_entry *root, uid_t uid, gid_t gid,
     if (!(fs->ops & VFS_OPS_GETDIRENT))
         return -ENOSYS;
 
-    ret = channel_open(fi->channel, NULL, &slave);
+    /* The attributes do not depend on the caller, the lookup checked it */
+    if (acache_lookup(&fi->acache, inode, buf))
+        return 0;
+
+    generation = acache_generation(&fi->acache);
+
+    ret = fiu_slave_get(fi, &slave);
     if (ret < 0)
         return ret;
 
@@ -118,12 +182,11 @@ static int fiu_stat(struct mount_entry *root, uid_t uid, gid_t gid,
     req.hdr.slave_id = slave->id;
 
     ret = fiu_channel_read_rw(slave, &req, sizeof (req), &resp, sizeof (resp));
-    if (ret < 0) {
-        channel_slave_close(slave);
-        return ret;
-    }
 
-    channel_slave_close(slave);
+    fiu_slave_put(fi, slave, ret);
+
+    if (ret < 0)
+        return ret;
 
     ret = resp.ret;
 
@@ -132,6 +195,8 @@ static int fiu_stat(struct mount_entry *root, uid_t uid, gid_t gid,
 
     memcpy(buf, &resp.stat, sizeof (struct stat));
 
+    acache_add(&fi->acache, generation, inode, buf, resp.lease);
+
     return ret;
 }
 
@@ -147,7 +212,7 @@ static int fiu_mount(struct mount_entry *root, ino_t inode, int mount_nb)
     if (!(fs->ops & VFS_OPS_MOUNT))
         return -ENOSYS;
 
-    ret = channel_open(fi->channel, NULL, &slave);
+    ret = fiu_slave_get(fi, &slave);
     if (ret < 0)
         return ret;
 
@@ -159,11 +224,15 @@ static int fiu_mount(struct mount_entry *root, ino_t inode, int mount_nb)
 
     ret = fiu_channel_read_rw(slave, &req, sizeof (req), &resp, sizeof (resp));
 
-    channel_slave_close(slave);
+    fiu_slave_put(fi, slave, ret);
 
     if (ret < 0)
         return ret;
 
+    /* The lookups going through the mount point now enter the new mount */
+    if (!resp.ret)
+        dcache_invalidate(&fi->dcache, 0);
+
     return resp.ret;
 }
 
@@ -180,7 +249,7 @@ static int fiu_getdirent(struct mount_entry *root, ino_t inode,
     if (!(fs->ops & VFS_OPS_GETDIRENT))
         return -ENOSYS;
 
-    ret = channel_open(fi->channel, NULL, &slave);
+    ret = fiu_slave_get(fi, &slave);
     if (ret < 0)
         return ret;
 
@@ -192,7 +261,7 @@ static int fiu_getdirent(struct mount_entry *root, ino_t inode,
 
     ret = fiu_channel_read_rw(slave, &req, sizeof (req), &resp, sizeof (resp));
 
-    channel_slave_close(slave);
+    fiu_slave_put(fi, slave, ret);
 
     if (ret < 0)
         return ret;
@@ -205,6 +274,108 @@ static int fiu_getdirent(struct mount_entry *root, ino_t inode,
     return resp.ret;
 }
 
+static int fiu_getdents(struct mount_entry *root, uid_t uid, gid_t gid,
+                        ino_t inode, void *buf, int count, int flags,
+                        uint32_t *cookie)
+{
+    int ret;
+    size_t size;
+    size_t rec_size;
+    uint32_t generation;
+    struct req_getdents req;
+    struct resp_getdents resp;
+    struct channel_slave *slave;
+    struct process *pdevice;
+    struct fiu_fs *fs = root->fi->parent->private;
+    struct fiu_fs_instance *fi = root->fi->private;
+
+    /* The VFS falls back on getdirent */
+    if (!(fs->ops & VFS_OPS_GETDENTS))
+        return -ENOSYS;
+
+    if (flags & GETDENTS_STAT)
+        rec_size = sizeof (struct dirent_plus);
+    else
+        rec_size = sizeof (struct dirent);
+
+    size = count * rec_size;
+
+    generation = acache_generation(&fi->acache);
+
+    ret = fiu_slave_get(fi, &slave);
+    if (ret < 0)
+        return ret;
+
+    pdevice = fi->channel->proc;
+
+    req.data = (void *)as_map(pdevice->as, 0, 0, size,
+                              AS_MAP_USER | AS_MAP_WRITE);
+    if (!req.data) {
+        ret = -ENOMEM;
+        goto error;
+    }
+
+    req.inode = inode;
+    req.uid = uid;
+    req.gid = gid;
+    req.cookie = *cookie;
+    req.count = count;
+    req.flags = flags;
+
+    req.hdr.slave_id = slave->id;
+    req.hdr.op = VFS_GETDENTS;
+
+    ret = fiu_channel_read_rw(slave, &req, sizeof (req), &resp, sizeof (resp));
+    if (ret < 0)
+        goto error_unmap;
+
+    fiu_slave_put(fi, slave, 0);
+
+    ret = resp.ret;
+    if (ret <= 0)
+        goto end;
+
+    if (ret > count)
+        ret = count;
+
+    if (as_copy(pdevice->as, thread_current()->parent->as, req.data, buf,
+                ret * rec_size) < 0) {
+        ret = -EFAULT;
+        goto end;
+    }
+
+    /*
+     * The attributes are taken again from the server mapping, the buffer of
+     * the caller is not trusted for a cache shared by every process
+     */
+    for (int i = 0; (flags & GETDENTS_STAT) && i < ret; ++i) {
+        struct dirent_plus *rec = (void *)((char *)req.data + i * rec_size);
+        struct stat st;
+
+        if (as_copy(pdevice->as, &kernel_as, &rec->st, &st,
+                    sizeof (struct stat)) < 0)
+            break;
+
+        if (!st.st_ino)
+            continue;
+
+        acache_add(&fi->acache, generation, st.st_ino, &st, resp.lease);
+    }
+
+    *cookie = resp.cookie;
+
+end:
+    as_unmap(pdevice->as, (vaddr_t)req.data, AS_UNMAP_RELEASE);
+
+    return ret;
+
+error_unmap:
+    as_unmap(pdevice->as, (vaddr_t)req.data, AS_UNMAP_RELEASE);
+error:
+    fiu_slave_put(fi, slave, ret);
+    return ret;
+}
+
 static int fiu_open(struct file *file, ino_t inode, pid_t pid, uid_t uid,
                     gid_t gid, int flags, mode_t mode)
 {
@@ -262,8 +433,19 @@ static int fiu_open(struct file *file, ino_t inode, pid_t pid, uid_t uid,
         goto error_channel;
     }
 
+    /* Without a ring, payloads are mapped in the server for each request */
+    if (priv->ops & VFS_OPS_RING)
+        channel_ring_create(slave);
+
     priv->slave = slave;
 
+    priv->ra_next = 0;
+    priv->ra_window = 0;
+    priv->ra_end = 0;
+    priv->ra_eof = FIU_RA_NO_EOF;
+    priv->ra_hits = 0;
+    priv->ra_misses = 0;
+
     file->private = priv;
 
     return resp.inode;
@@ -275,13 +457,52 @@ error:
     return ret;
 }
 
-static int fiu_read_write(struct file *file, struct process *p,
+/*
+ * Exchange the payload through the ring of the slave: the server reads and
+ * writes it in place, so it is copied once and nothing is mapped per request
+ */
+static int fiu_read_write_ring(struct fiu_file_private *private,
+                               struct process *p, struct req_rdwr *req,
+                               void *buf, int op, void *kbuf)
+{
+    int ret = 0;
+    struct resp_rdwr resp;
+
+    if (op == VFS_WRITE) {
+        ret = as_copy(p->as, &kernel_as, buf, kbuf, req->size);
+        if (ret < 0)
+            return ret;
+    }
+
+    ret = fiu_channel_read_rw(private->slave, req, sizeof (*req), &resp,
+                              sizeof (resp));
+    if (ret < 0)
+        return ret;
+
+    if (resp.ret < 0)
+        return resp.ret;
+
+    if (resp.size > req->size)
+        return -EINVAL;
+
+    if (op == VFS_READ)
+        ret = as_copy(&kernel_as, p->as, kbuf, buf, resp.size);
+
+    if (ret == 0) {
+        ret = resp.size;
+        req->off += ret;
+    }
+
+    return ret;
+}
+
+static int fiu_read_write(struct fiu_file_private *private, struct process *p,
                           struct req_rdwr *req, void *buf, int op)
 {
     int ret;
-    struct fiu_file_private *private = file->private;
     struct process *pdevice;
     struct resp_rdwr resp;
+    void *kbuf;
 
     if (!(private->ops & op))
         return -ENOSYS;
@@ -291,6 +512,15 @@ static int fiu_read_write(struct file *file, struct process *p,
     req->hdr.op = op;
     req->hdr.slave_id = private->slave->id;
 
+    kbuf = channel_ring_alloc(private->slave, req->size, &req->data);
+    if (kbuf) {
+        ret = fiu_read_write_ring(private, p, req, buf, op, kbuf);
+
+        channel_ring_release(private->slave, kbuf, req->size);
+
+        return ret;
+    }
+
     req->data = (void *)as_map(pdevice->as, 0, 0, req->size,
                                AS_MAP_USER | AS_MAP_WRITE);
     if (!req->data)
@@ -326,15 +556,365 @@ end:
     return ret;
 }
 
+/*
+ * Read a page of a file from the server with the slave of private and put it
+ * in the page cache, the page is returned pinned
+ */
+static int fiu_read_page(struct fs_instance *fi,
+                         struct fiu_file_private *private, ino_t inode,
+                         uint32_t index, int readahead,
+                         struct pcache_page **page)
+{
+    int ret;
+    uint32_t generation;
+    struct req_rdwr req;
+
+    generation = pcache_generation();
+
+    *page = pcache_page_new();
+    if (!*page)
+        return -ENOMEM;
+
+    req.inode = inode;
+    req.size = PAGE_SIZE;
+    req.off = (uint64_t)index << PAGE_SHIFT;
+
+    /* The kernel process owns the kernel address space */
+    ret = fiu_read_write(private, process_get(0), &req, (*page)->data,
+                         VFS_READ);
+    if (ret < 0) {
+        pcache_put(*page);
+        return ret;
+    }
+
+    (*page)->readahead = readahead;
+
+    pcache_insert(*page, generation, fi, inode, index, ret);
+
+    return 0;
+}
+
+/* Pages waiting to be read ahead, and the worker that reads them */
+static struct fiu_ra_request fiu_ra_requests[FIU_RA_QUEUE];
+static struct klist fiu_ra_pending;
+static struct klist fiu_ra_free;
+static struct wait_queue fiu_ra_wait;
+static spinlock_t fiu_ra_lock = SPINLOCK_INIT;
+static int fiu_ra_state;
+
+/*
+ * Read a page ahead, on a slave of the pool: the file may be closed by the
+ * time the request is handled
+ */
+static void fiu_ra_fetch(struct fs_instance *fi, ino_t inode, uint32_t index)
+{
+    int ret;
+    struct fiu_fs *fs = fi->parent->private;
+    struct fiu_fs_instance *priv = fi->private;
+    struct fiu_file_private private;
+    struct pcache_page *page;
+
+    page = pcache_get(fi, inode, index);
+    if (page) {
+        pcache_put(page);
+        return;
+    }
+
+    ret = fiu_slave_get(priv, &private.slave);
+    if (ret < 0)
+        return;
+
+    private.ops = fs->ops;
+
+    ret = fiu_read_page(fi, &private, inode, index, 1, &page);
+
+    /* Only a failed call leaves the slave in an unknown state */
+    fiu_slave_put(priv, private.slave, ret == -ENOMEM ? 0 : ret);
+
+    if (!ret)
+        pcache_put(page);
+}
+
+static void fiu_ra_worker(void)
+{
+    struct thread *t = thread_current();
+    struct fiu_ra_request *req;
+    struct fs_instance *fi;
+    ino_t inode;
+    uint32_t index;
+
+    for (;;) {
+        wait_queue_wait(&fiu_ra_wait, t, !klist_empty(&fiu_ra_pending));
+
+        spinlock_lock(&fiu_ra_lock);
+
+        req = klist_first_elem(&fiu_ra_pending, struct fiu_ra_request, list);
+        if (!req) {
+            spinlock_unlock(&fiu_ra_lock);
+            continue;
+        }
+
+        klist_del(&req->list);
+
+        fi = req->fi;
+        inode = req->inode;
+        index = req->index;
+
+        klist_add(&fiu_ra_free, &req->list);
+
+        spinlock_unlock(&fiu_ra_lock);
+
+        fiu_ra_fetch(fi, inode, index);
+    }
+}
+
+/*
+ * Start the worker the first time a page is read ahead, the kernel threads
+ * do not exist yet when the VFS is initialized
+ */
+static int fiu_ra_start(void)
+{
+    struct thread *t;
+
+    spinlock_lock(&fiu_ra_lock);
+
+    if (fiu_ra_state) {
+        spinlock_unlock(&fiu_ra_lock);
+        return fiu_ra_state;
+    }
+
+    klist_head_init(&fiu_ra_pending);
+    klist_head_init(&fiu_ra_free);
+
+    for (int i = 0; i < FIU_RA_QUEUE; ++i)
+        klist_add(&fiu_ra_free, &fiu_ra_requests[i].list);
+
+    wait_queue_init(&fiu_ra_wait);
+
+    fiu_ra_state = 1;
+
+    spinlock_unlock(&fiu_ra_lock);
+
+    t = kthread_create((uintptr_t)fiu_ra_worker, 0, NULL);
+    if (!t) {
+        fiu_ra_state = -1;
+        return -1;
+    }
+
+    cpu_add_thread(t);
+
+    return 1;
+}
+
+/*
+ * Queue the pages from first to last included, stop at the first one that
+ * does not fit in the queue. Return the page following the last one queued
+ */
+static uint32_t fiu_ra_submit(struct fs_instance *fi, ino_t inode,
+                              uint32_t first, uint32_t last)
+{
+    uint32_t index;
+    struct fiu_ra_request *req;
+
+    if (fiu_ra_start() < 0)
+        return first;
+
+    spinlock_lock(&fiu_ra_lock);
+
+    for (index = first; index <= last; ++index) {
+        req = klist_first_elem(&fiu_ra_free, struct fiu_ra_request, list);
+        if (!req)
+            break;
+
+        klist_del(&req->list);
+
+        req->fi = fi;
+        req->inode = inode;
+        req->index = index;
+
+        klist_add_back(&fiu_ra_pending, &req->list);
+    }
+
+    spinlock_unlock(&fiu_ra_lock);
+
+    if (index != first)
+        wait_queue_notify(&fiu_ra_wait);
+
+    return index;
+}
+
+/*
+ * Grow the readahead window of a file on sequential reads and collapse it on
+ * random ones, then queue the pages of the window that follow the read
+ */
+static void fiu_readahead(struct file *file, struct req_rdwr *req,
+                          uint64_t off)
+{
+    struct fiu_file_private *private = file->private;
+    struct fiu_fs_instance *fi = file->mount->fi->private;
+    struct stat st;
+    uint32_t next;
+    uint32_t last;
+    uint32_t eof;
+
+    if (off != private->ra_next) {
+        private->ra_window = 0;
+        private->ra_end = 0;
+        private->ra_next = req->off;
+
+        return;
+    }
+
+    private->ra_next = req->off;
+
+    if (!private->ra_window)
+        private->ra_window = FIU_RA_MIN;
+    else if (private->ra_window < FIU_RA_MAX)
+        private->ra_window *= 2;
+
+    /*
+     * Nothing beyond the end of the file. The size is only known while its
+     * attributes are cached, otherwise the last short page read marks it
+     */
+    if (acache_lookup(&fi->acache, req->inode, &st)) {
+        if (!st.st_size)
+            return;
+
+        eof = (st.st_size - 1) >> PAGE_SHIFT;
+    } else {
+        eof = private->ra_eof;
+    }
+
+    next = (req->off + PAGE_SIZE - 1) >> PAGE_SHIFT;
+    if (next < private->ra_end)
+        next = private->ra_end;
+
+    last = ((req->off - 1) >> PAGE_SHIFT) + private->ra_window;
+    if (last > eof)
+        last = eof;
+
+    if (next > last)
+        return;
+
+    private->ra_end = fiu_ra_submit(file->mount->fi, req->inode, next, last);
+}
+
+/*
+ * Read through the page cache, the server is only asked for the pages that
+ * are not cached
+ */
+static int fiu_read_cached(struct file *file, struct process *p,
+                           struct req_rdwr *req, void *buf)
+{
+    int ret = 0;
+    int eof;
+    size_t done = 0;
+    size_t in_page;
+    size_t size;
+    uint64_t off;
+    struct pcache_page *page;
+    struct fiu_file_private *private = file->private;
+
+    while (done < req->size) {
+        off = req->off + done;
+        in_page = off & (PAGE_SIZE - 1);
+
+        page = pcache_get(file->mount->fi, req->inode, off >> PAGE_SHIFT);
+        if (page) {
+            /* The counters are only indicative, no lock taken */
+            if (page->readahead) {
+                page->readahead = 0;
+                ++private->ra_hits;
+            }
+        } else {
+            ret = fiu_read_page(file->mount->fi, private, req->inode,
+                                off >> PAGE_SHIFT, 0, &page);
+            if (ret < 0)
+                break;
+
+            if (private->ra_window)
+                ++private->ra_misses;
+        }
+
+        /* A full page at or past the known end means that the file grew */
+        if (page->size < PAGE_SIZE)
+            private->ra_eof = off >> PAGE_SHIFT;
+        else if ((off >> PAGE_SHIFT) >= private->ra_eof)
+            private->ra_eof = FIU_RA_NO_EOF;
+
+        if (page->size <= in_page) {
+            pcache_put(page);
+            break;
+        }
+
+        size = page->size - in_page;
+        if (size > req->size - done)
+            size = req->size - done;
+
+        eof = page->size < PAGE_SIZE;
+
+        ret = as_copy(&kernel_as, p->as, (char *)page->data + in_page,
+                      (char *)buf + done, size);
+
+        pcache_put(page);
+
+        if (ret < 0)
+            break;
+
+        done += size;
+
+        if (eof)
+            break;
+    }
+
+    /* Report the error only if nothing could be read */
+    if (!done && ret < 0)
+        return ret;
+
+    off = req->off;
+    req->off += done;
+
+    if (done)
+        fiu_readahead(file, req, off);
+
+    return done;
+}
+
 static int fiu_read(struct file *file, struct process *p, struct req_rdwr *req,
                     void *buf)
 {
-    return fiu_read_write(file, p, req, buf, VFS_READ);
+    struct fiu_file_private *private = file->private;
+
+    if (file->mount && private->ops & VFS_OPS_CACHE) {
+        int ret = fiu_read_cached(file, p, req, buf);
+
+        /* Every page is pinned, read without the cache */
+        if (ret != -ENOMEM)
+            return ret;
+    }
+
+    return fiu_read_write(private, p, req, buf, VFS_READ);
 }
+
 static int fiu_write(struct file *file, struct process *p,
                      struct req_rdwr *req, void *buf)
 {
-    return fiu_read_write(file, p, req, buf, VFS_WRITE);
+    int ret;
+    uint64_t off = req->off;
+    struct fiu_fs_instance *fi;
+
+    ret = fiu_read_write(file->private, p, req, buf, VFS_WRITE);
+
+    /* The content and the size changed */
+    if (ret > 0 && file->mount) {
+        fi = file->mount->fi->private;
+
+        pcache_invalidate(file->mount->fi, req->inode, off >> PAGE_SHIFT,
+                          (off + ret - 1) >> PAGE_SHIFT);
+        acache_invalidate(&fi->acache, req->inode);
+    }
+
+    return ret;
 }
 
 static int fiu_ioctl(struct file *file, struct req_ioctl *req, int *argp)
@@ -377,9 +957,20 @@ static int fiu_dup(struct file *new, struct file *old)
         return ret;
     }
 
+    if (old_priv->ops & VFS_OPS_RING)
+        channel_ring_create(slave);
+
     new_priv->slave = slave;
     new_priv->ops = old_priv->ops;
 
+    /* The offset is shared, the access pattern too */
+    new_priv->ra_next = old_priv->ra_next;
+    new_priv->ra_window = old_priv->ra_window;
+    new_priv->ra_end = old_priv->ra_end;
+    new_priv->ra_eof = old_priv->ra_eof;
+    new_priv->ra_hits = 0;
+    new_priv->ra_misses = 0;
+
     new->private = new_priv;
 
     return 0;
@@ -409,6 +1000,41 @@ static int fiu_close(struct file *file, ino_t inode)
     return resp.ret;
 }
 
+/*
+ * Control messages sent by the instance on its channel
+ */
+static void fiu_control(void *data, void *buf, size_t size)
+{
+    struct fs_instance *fi = data;
+    struct fiu_fs_instance *priv = fi->private;
+    struct msg_header *hdr = buf;
+    struct req_invalidate *req = buf;
+    struct req_invalidate_data *req_data = buf;
+    uint32_t last = 0xffffffff;
+
+    switch (hdr->op) {
+    case VFS_INVALIDATE:
+        if (size < sizeof (struct req_invalidate))
+            return;
+
+        dcache_invalidate(&priv->dcache, req->inode);
+        acache_invalidate(&priv->acache, req->inode);
+        pcache_invalidate(fi, req->inode, 0, last);
+        break;
+
+    case VFS_INVALIDATE_DATA:
+        if (size < sizeof (struct req_invalidate_data) || !req_data->inode)
+            return;
+
+        if (req_data->size)
+            last = (req_data->off + req_data->size - 1) >> PAGE_SHIFT;
+
+        pcache_invalidate(fi, req_data->inode, req_data->off >> PAGE_SHIFT,
+                          last);
+        break;
+    }
+}
+
 static int fiu_create(struct fs_instance *fi, const char *device,
                       const char *mount_pt)
 {
@@ -458,6 +1084,12 @@ static int fiu_create(struct fs_instance *fi, const char *device,
 
     fi->private = priv;
     priv->channel = channel;
+    priv->pool_count = 0;
+    spinlock_init(&priv->pool_lock);
+    dcache_initialize(&priv->dcache);
+    acache_initialize(&priv->acache);
+
+    channel_control_set(channel, fiu_control, fi);
 
     return 0;
 
@@ -473,6 +1105,7 @@ struct fs_operation fiu_fs_ops = {
     .stat = fiu_stat,
     .mount = fiu_mount,
     .getdirent = fiu_getdirent,
+    .getdents = fiu_getdents,
 };
 
 struct file_operation fiu_f_ops = {
@@ -9,9 +9,9 @@
 
 int vfs_close(struct thread *t, int fd)
 {
-    int ret;
+    int ret = 0;
     struct process *p;
-    struct file *file;
+    struct file file;
 
     /* Kernel request */
     if (!t)
@@ -19,20 +19,33 @@ int vfs_close(struct thread *t, int fd)
     else
         p = thread_current()->parent;
 
-    ret = process_file_from_fd(p, fd, &file);
-    if (ret < 0)
-        return ret;
+    if (fd < 0 || fd >= PROCESS_MAX_OPEN_FD)
+        return -EINVAL;
 
-    if (!file->f_ops->close)
-        goto end;
+    /*
+     * The descriptor is released before the file is torn down, the readers
+     * of the table (procfs) never see a file whose private data is freed
+     */
+    spinlock_lock(&p->files_lock);
 
-    ret = file->f_ops->close(file, file->inode->inode);
-    if (ret < 0)
-        return ret;
+    if (!p->files[fd].used) {
+        spinlock_unlock(&p->files_lock);
+        return -EBADF;
+    }
 
-end:
-    inode_del(file->inode);
-    process_free_fd(p, fd);
+    file = p->files[fd];
 
-    return 0;
+    p->files[fd].used = 0;
+    p->files[fd].f_ops = NULL;
+    p->files[fd].private = NULL;
+    p->files[fd].inode = NULL;
+
+    spinlock_unlock(&p->files_lock);
+
+    if (file.f_ops->close)
+        ret = file.f_ops->close(&file, file.inode->inode);
+
+    inode_del(file.inode);
+
+    return ret < 0 ? ret : 0;
 }
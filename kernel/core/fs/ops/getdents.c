@@ -0,0 +1,112 @@
+#include <string.h>
+
+#include <kernel/errno.h>
+
+#include <kernel/proc/thread.h>
+
+#include <kernel/fs/vfs.h>
+#include <kernel/fs/vfs/vops.h>
+#include <kernel/fs/vfs/mount.h>
+
+/*
+ * For the file systems that only know getdirent, the cookie is the index of
+ * the next entry
+ */
+static int getdents_from_getdirent(struct mount_entry *mount, uid_t uid,
+                                   gid_t gid, ino_t inode, void *buf,
+                                   int count, int flags, uint32_t *cookie)
+{
+    struct fs_operation *fs_ops = mount->fi->parent->fs_ops;
+    struct dirent_plus *rec;
+    size_t rec_size;
+    int ret;
+    int n;
+
+    if (!fs_ops->getdirent)
+        return -ENOSYS;
+
+    if (flags & GETDENTS_STAT)
+        rec_size = sizeof (struct dirent_plus);
+    else
+        rec_size = sizeof (struct dirent);
+
+    for (n = 0; n < count; ++n) {
+        rec = (void *)((char *)buf + n * rec_size);
+
+        ret = fs_ops->getdirent(mount, inode, &rec->d, *cookie);
+        if (ret < 0)
+            return n ? n : ret;
+
+        if (!ret)
+            break;
+
+        ++*cookie;
+
+        if (!(flags & GETDENTS_STAT))
+            continue;
+
+        if (!fs_ops->stat ||
+            fs_ops->stat(mount, uid, gid, rec->d.d_ino, &rec->st) < 0)
+            memset(&rec->st, 0, sizeof (struct stat));
+    }
+
+    return n;
+}
+
+int vfs_getdents(struct thread *t, int fd, void *buf, size_t size,
+                 uint32_t *cookie, int flags)
+{
+    int ret;
+    int count;
+    struct process *p;
+    uid_t uid;
+    gid_t gid;
+    struct file *file;
+    struct fs_operation *fs_ops;
+
+    /* Kernel request */
+    if (!t) {
+        p = process_get(0);
+
+        uid = 0;
+        gid = 0;
+    } else {
+        p = t->parent;
+
+        uid = t->uid;
+        gid = t->gid;
+    }
+
+    if (flags & ~GETDENTS_STAT)
+        return -EINVAL;
+
+    if (flags & GETDENTS_STAT)
+        count = size / sizeof (struct dirent_plus);
+    else
+        count = size / sizeof (struct dirent);
+
+    if (!count)
+        return -EINVAL;
+
+    if (count > GETDENTS_MAX)
+        count = GETDENTS_MAX;
+
+    ret = process_file_from_fd(p, fd, &file);
+    if (ret < 0)
+        return ret;
+
+    if (!file->mount || !file->inode)
+        return -EBADF;
+
+    fs_ops = file->mount->fi->parent->fs_ops;
+
+    if (fs_ops->getdents) {
+        ret = fs_ops->getdents(file->mount, uid, gid, file->inode->inode, buf,
+                               count, flags, cookie);
+        if (ret != -ENOSYS)
+            return ret;
+    }
+
+    return getdents_from_getdirent(file->mount, uid, gid, file->inode->inode,
+                                   buf, count, flags, cookie);
+}
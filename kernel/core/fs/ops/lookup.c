@@ -18,7 +18,6 @@ int vfs_lookup(struct thread *t, const char *path, struct resp_lookup *res,
     int processed = 0;
     int path_len = strlen(path);
     struct mount_entry *root = vfs_root_get();
-    char *copied_path = kmalloc(path_len + 1);
     uid_t uid;
     gid_t gid;
 
@@ -31,52 +30,33 @@ int vfs_lookup(struct thread *t, const char *path, struct resp_lookup *res,
         gid = t->gid;
     }
 
-    if (!copied_path)
-        return -ENOMEM;
-
-    strcpy(copied_path, path);
-
     for (;;) {
-        if (!root || !root->used) {
-            kfree(copied_path);
+        if (!root || !root->used)
             return -ENOENT;
-        }
 
-        if (!root->fi->parent->fs_ops->lookup) {
-            kfree(copied_path);
+        if (!root->fi->parent->fs_ops->lookup)
             return -ENOSYS;
-        }
 
         ret = root->fi->parent->fs_ops->lookup(root, path + processed, uid,
                                                gid, res);
 
-        if (ret < 0) {
-            kfree(copied_path);
+        if (ret < 0)
             return ret;
-        }
 
         processed += res->processed;
 
-        if (!processed || processed > path_len) {
-            kfree(copied_path);
+        if (!processed || processed > path_len)
             return -EBADE;
-        }
 
         if (res->ret == RES_OK || res->ret == RES_KO)
             break;
 
-        char old = copied_path[res->processed];
-
-        copied_path[res->processed] = 0;
-        root = vfs_mount_pt_get(copied_path);
-        copied_path[res->processed] = old;
+        root = vfs_mount_pt_get_n(path, processed);
     }
 
     *mount_pt = root;
 
     res->processed = processed;
 
-    kfree(copied_path);
-
     return processed;
 }
@@ -0,0 +1,442 @@
+/*
+ * zOS
+ * Copyright (C) 2015 Baptiste Covolato
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zOS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file    kernel/core/fs/poll.c
+ * \brief   Implementation of the readiness notification
+ *
+ * A set hooks a poller on the wait queue of each source it watches: the
+ * wait queue of a channel, of a slave, of a user interrupt, or the readiness
+ * queue of the channel of a device driver. Notifying the queue marks the
+ * entry and wakes up the set, the readiness itself is read from the source
+ * when the set is scanned.
+ *
+ * \author  Baptiste Covolato
+ */
+
+#include <kernel/errno.h>
+#include <kernel/interrupt.h>
+
+#include <kernel/mem/kmalloc.h>
+
+#include <kernel/proc/process.h>
+#include <kernel/proc/thread.h>
+
+#include <kernel/fs/vfs.h>
+#include <kernel/fs/fiu.h>
+#include <kernel/fs/channel.h>
+#include <kernel/fs/poll.h>
+
+/*
+ * Serializes the attachment of entries to wait queues with their detachment,
+ * so that a set never touches a wait queue that has been destroyed
+ */
+static spinlock_t poll_lock = SPINLOCK_INIT;
+
+static void poll_entry_notify(struct wait_queue_poller *poller)
+{
+    struct poll_entry *entry = klist_elem(poller, struct poll_entry, poller);
+    struct poll *poll = entry->poll;
+
+    entry->pending = 1;
+    poll->notified = 1;
+
+    wait_queue_notify(&poll->wait);
+}
+
+static void poll_entry_attach(struct poll_entry *entry,
+                              struct wait_queue *queue)
+{
+    entry->poller.notify = poll_entry_notify;
+    entry->poller.queue = queue;
+
+    spinlock_lock(&queue->lock);
+    klist_add_back(&queue->pollers, &entry->poller.list);
+    spinlock_unlock(&queue->lock);
+}
+
+/* Must be called with poll_lock held */
+static void poll_entry_detach(struct poll_entry *entry)
+{
+    struct wait_queue *queue = entry->poller.queue;
+
+    if (!queue)
+        return;
+
+    spinlock_lock(&queue->lock);
+    klist_del(&entry->poller.list);
+    spinlock_unlock(&queue->lock);
+
+    entry->poller.queue = NULL;
+}
+
+void poll_detach(struct wait_queue *queue)
+{
+    struct wait_queue_poller *poller;
+
+    spinlock_lock(&poll_lock);
+
+    spinlock_lock(&queue->lock);
+
+    while (!klist_empty(&queue->pollers)) {
+        poller = klist_first_elem(&queue->pollers, struct wait_queue_poller,
+                                  list);
+
+        klist_del(&poller->list);
+        poller->queue = NULL;
+
+        /* Let the set report the hang up */
+        poller->notify(poller);
+    }
+
+    spinlock_unlock(&queue->lock);
+
+    spinlock_unlock(&poll_lock);
+}
+
+int poll_create(struct file *file)
+{
+    struct poll *poll;
+
+    poll = kmalloc(sizeof (struct poll));
+    if (!poll)
+        return -ENOMEM;
+
+    wait_queue_init(&poll->wait);
+    poll->notified = 0;
+    klist_head_init(&poll->entries);
+    poll->ref = 1;
+    poll->users = 0;
+    poll->closed = 0;
+
+    file->inode = NULL;
+    file->private = poll;
+    file->f_ops = &poll_f_ops;
+    file->mount = NULL;
+
+    return 0;
+}
+
+static struct poll_entry *poll_entry_find(struct poll *poll, int type, int id)
+{
+    struct poll_entry *entry;
+
+    klist_for_each_elem(&poll->entries, entry, list) {
+        if (entry->type == type && entry->id == id)
+            return entry;
+    }
+
+    return NULL;
+}
+
+/*
+ * Fill the source of an entry, return the wait queue to watch
+ */
+static struct wait_queue *poll_entry_source(struct poll_entry *entry)
+{
+    struct thread *t = thread_current();
+    struct file *file;
+
+    if (entry->type == POLL_SRC_IRQ) {
+        entry->kind = POLL_KIND_IRQ;
+        entry->source = t;
+
+        return interrupt_user_queue(t, entry->id);
+    }
+
+    if (process_file_from_fd(t->parent, entry->id, &file) < 0)
+        return NULL;
+
+    entry->source = file->private;
+
+    if (file->f_ops == &channel_master_f_ops) {
+        entry->kind = POLL_KIND_MASTER;
+
+        return &((struct channel *)entry->source)->wait;
+    }
+
+    if (file->f_ops == &channel_slave_f_ops) {
+        entry->kind = POLL_KIND_SLAVE;
+
+        return &((struct channel_slave *)entry->source)->wait;
+    }
+
+    /* Only the driver knows when a device is ready, it tells its channel */
+    if (file->f_ops == &fiu_f_ops && !file->mount && file->private) {
+        struct fiu_file_private *priv = file->private;
+
+        entry->kind = POLL_KIND_DEVICE;
+        entry->source = priv->slave->parent;
+
+        return &priv->slave->parent->ready_wait;
+    }
+
+    return NULL;
+}
+
+static int poll_add(struct poll *poll, int type, int id,
+                    struct poll_event *event)
+{
+    struct poll_entry *entry;
+    struct wait_queue *queue;
+
+    entry = kmalloc(sizeof (struct poll_entry));
+    if (!entry)
+        return -ENOMEM;
+
+    entry->poll = poll;
+    entry->type = type;
+    entry->id = id;
+    entry->event = *event;
+    entry->pending = 0;
+
+    spinlock_lock(&poll_lock);
+
+    if (poll->closed) {
+        spinlock_unlock(&poll_lock);
+        kfree(entry);
+        return -EBADF;
+    }
+
+    if (poll_entry_find(poll, type, id)) {
+        spinlock_unlock(&poll_lock);
+        kfree(entry);
+        return -EEXIST;
+    }
+
+    queue = poll_entry_source(entry);
+    if (!queue) {
+        spinlock_unlock(&poll_lock);
+        kfree(entry);
+        return type == POLL_SRC_IRQ ? -EINVAL : -EBADF;
+    }
+
+    poll_entry_attach(entry, queue);
+    klist_add_back(&poll->entries, &entry->list);
+
+    spinlock_unlock(&poll_lock);
+
+    /* The source may already be ready */
+    poll->notified = 1;
+
+    return 0;
+}
+
+static int poll_del(struct poll *poll, int type, int id)
+{
+    struct poll_entry *entry;
+
+    spinlock_lock(&poll_lock);
+
+    entry = poll_entry_find(poll, type, id);
+    if (!entry) {
+        spinlock_unlock(&poll_lock);
+        return -ENOENT;
+    }
+
+    poll_entry_detach(entry);
+    klist_del(&entry->list);
+
+    spinlock_unlock(&poll_lock);
+
+    kfree(entry);
+
+    return 0;
+}
+
+int poll_ctl(struct poll *poll, int op, int type, int id,
+             struct poll_event *event)
+{
+    if (type != POLL_SRC_FD && type != POLL_SRC_IRQ)
+        return -EINVAL;
+
+    if (op == POLL_ADD)
+        return poll_add(poll, type, id, event);
+
+    if (op == POLL_DEL)
+        return poll_del(poll, type, id);
+
+    return -EINVAL;
+}
+
+/*
+ * Events of an entry that are ready, must be called with poll_lock held so
+ * that the source is still there
+ */
+static uint32_t poll_entry_ready(struct poll_entry *entry)
+{
+    int edge = entry->event.events & POLLET;
+    int pending = entry->pending;
+    uint32_t events = 0;
+
+    /* An edge triggered entry is only looked at once per notification */
+    if (edge && !pending)
+        return 0;
+
+    entry->pending = 0;
+
+    if (!entry->poller.queue)
+        return POLLHUP;
+
+    if (entry->kind == POLL_KIND_IRQ) {
+        if (interrupt_user_ack(entry->source, entry->id))
+            events |= POLLIN;
+    } else if (entry->kind == POLL_KIND_MASTER) {
+        struct channel *channel = entry->source;
+
+        if (!klist_empty(&channel->input))
+            events |= POLLIN;
+    } else if (entry->kind == POLL_KIND_DEVICE) {
+        struct channel *channel = entry->source;
+
+        events |= channel->ready;
+    } else {
+        struct channel_slave *slave = entry->source;
+
+        if (!klist_empty(&slave->input))
+            events |= POLLIN;
+    }
+
+    return events & entry->event.events;
+}
+
+static int poll_scan(struct poll *poll, struct poll_event *events, int max)
+{
+    struct poll_entry *entry;
+    int n = 0;
+
+    spinlock_lock(&poll_lock);
+
+    klist_for_each_elem(&poll->entries, entry, list) {
+        uint32_t ready;
+
+        if (n == max)
+            break;
+
+        ready = poll_entry_ready(entry);
+        if (!ready)
+            continue;
+
+        events[n].events = ready;
+        events[n].data = entry->event.data;
+        ++n;
+    }
+
+    spinlock_unlock(&poll_lock);
+
+    return n;
+}
+
+int poll_wait(struct poll *poll, struct poll_event *events, int max,
+              int block)
+{
+    struct thread *t = thread_current();
+    int n;
+
+    for (;;) {
+        /* A notification after this point makes the wait below return */
+        poll->notified = 0;
+
+        if (poll->closed)
+            return -EBADF;
+
+        n = poll_scan(poll, events, max);
+        if (n || !block)
+            return n;
+
+        wait_queue_wait(&poll->wait, t, poll->notified);
+    }
+}
+
+void poll_get(struct poll *poll)
+{
+    spinlock_lock(&poll_lock);
+    ++poll->users;
+    spinlock_unlock(&poll_lock);
+}
+
+void poll_put(struct poll *poll)
+{
+    int last;
+
+    spinlock_lock(&poll_lock);
+    last = !--poll->users && poll->closed;
+    spinlock_unlock(&poll_lock);
+
+    if (last)
+        kfree(poll);
+}
+
+static int poll_dup(struct file *new, struct file *old)
+{
+    struct poll *poll = old->private;
+
+    (void) new;
+
+    spinlock_lock(&poll_lock);
+    ++poll->ref;
+    spinlock_unlock(&poll_lock);
+
+    return 0;
+}
+
+static int poll_close(struct file *file, ino_t inode)
+{
+    struct poll *poll = file->private;
+    struct poll_entry *entry;
+    int last;
+
+    (void) inode;
+
+    spinlock_lock(&poll_lock);
+
+    if (--poll->ref) {
+        spinlock_unlock(&poll_lock);
+        return 0;
+    }
+
+    while (!klist_empty(&poll->entries)) {
+        entry = klist_first_elem(&poll->entries, struct poll_entry, list);
+
+        poll_entry_detach(entry);
+        klist_del(&entry->list);
+
+        kfree(entry);
+    }
+
+    poll->closed = 1;
+    poll->notified = 1;
+
+    /* The threads still waiting on the set return, the last one frees it */
+    while (wait_queue_notify(&poll->wait))
+        continue;
+
+    last = !poll->users;
+
+    spinlock_unlock(&poll_lock);
+
+    if (last)
+        kfree(poll);
+
+    return 0;
+}
+
+struct file_operation poll_f_ops = {
+    .dup = poll_dup,
+    .close = poll_close,
+};
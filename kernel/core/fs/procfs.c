@@ -0,0 +1,725 @@
+/*
+ * zOS
+ * Copyright (C) 2015 Baptiste Covolato
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zOS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file    kernel/core/fs/procfs.c
+ * \brief   Process information file system. Every file is generated in the
+ *          kernel when it is read, no user space server is involved
+ *
+ * \author  Baptiste Covolato
+ */
+
+#include <string.h>
+
+#include <kernel/zos.h>
+#include <kernel/errno.h>
+
+#include <kernel/mem/kmalloc.h>
+#include <kernel/mem/as.h>
+#include <kernel/mem/segment.h>
+
+#include <kernel/proc/process.h>
+#include <kernel/proc/thread.h>
+
+#include <kernel/fs/vfs.h>
+#include <kernel/fs/procfs.h>
+#include <kernel/fs/channel.h>
+#include <kernel/fs/fiu.h>
+
+#include <kernel/fs/vfs/device.h>
+#include <kernel/fs/vfs/message.h>
+#include <kernel/fs/vfs/mount.h>
+
+# define FS_NAME "procfs"
+
+/*
+ * Inode 1 is the root directory, the directory of a process and its files
+ * are encoded as ((pid + 1) << 3) | file
+ */
+# define PROCFS_INODE_ROOT 1
+
+# define PROCFS_FILE_DIR 0
+# define PROCFS_FILE_STATUS 1
+# define PROCFS_FILE_THREADS 2
+# define PROCFS_FILE_MAPS 3
+# define PROCFS_FILE_FDS 4
+# define PROCFS_FILE_CHANNELS 5
+
+# define PROCFS_INODE(pid, file) ((((ino_t)(pid) + 1) << 3) | (file))
+# define PROCFS_INODE_PID(inode) ((pid_t)((inode) >> 3) - 1)
+# define PROCFS_INODE_FILE(inode) ((inode) & 7)
+
+struct procfs_buf {
+    char *data;
+    size_t size;
+    size_t len;
+
+    /* Set if some output did not fit */
+    int truncated;
+};
+
+/* Appended to a file whose content did not fit in the buffer */
+# define PROCFS_TRUNCATED "[truncated]\n"
+
+struct procfs_generate_req {
+    int file;
+    struct procfs_buf buf;
+};
+
+typedef void (*procfs_show_t)(struct process *, struct procfs_buf *);
+
+static void procfs_show_status(struct process *p, struct procfs_buf *b);
+static void procfs_show_threads(struct process *p, struct procfs_buf *b);
+static void procfs_show_maps(struct process *p, struct procfs_buf *b);
+static void procfs_show_fds(struct process *p, struct procfs_buf *b);
+static void procfs_show_channels(struct process *p, struct procfs_buf *b);
+
+static const struct {
+    const char *name;
+    procfs_show_t show;
+} procfs_files[] = {
+    [PROCFS_FILE_STATUS] = { "status", procfs_show_status },
+    [PROCFS_FILE_THREADS] = { "threads", procfs_show_threads },
+    [PROCFS_FILE_MAPS] = { "maps", procfs_show_maps },
+    [PROCFS_FILE_FDS] = { "fds", procfs_show_fds },
+    [PROCFS_FILE_CHANNELS] = { "channels", procfs_show_channels },
+};
+
+# define PROCFS_FILE_COUNT (sizeof (procfs_files) / sizeof (procfs_files[0]))
+
+static void procfs_putc(struct procfs_buf *b, char c)
+{
+    if (b->len < b->size)
+        b->data[b->len++] = c;
+    else
+        b->truncated = 1;
+}
+
+static void procfs_pad(struct procfs_buf *b, char c, int count)
+{
+    for (; count > 0; --count)
+        procfs_putc(b, c);
+}
+
+/*
+ * Write s in a field of width characters, right aligned unless left is set
+ */
+static void procfs_field(struct procfs_buf *b, const char *s, int width,
+                         int left, char pad)
+{
+    int len = strlen(s);
+
+    if (!left)
+        procfs_pad(b, pad, width - len);
+
+    while (*s)
+        procfs_putc(b, *(s++));
+
+    if (left)
+        procfs_pad(b, ' ', width - len);
+}
+
+static void procfs_number(char *s, uint32_t num, uint32_t base, int neg)
+{
+    char tmp[11];
+    int i = 0;
+
+    do {
+        tmp[i++] = "0123456789abcdef"[num % base];
+        num /= base;
+    } while (num);
+
+    if (neg)
+        *(s++) = '-';
+
+    while (i)
+        *(s++) = tmp[--i];
+
+    *s = '\0';
+}
+
+/*
+ * Small printf supporting %s %d %u %x, with an optional '-' or '0' flag and
+ * field width
+ */
+static void procfs_printf(struct procfs_buf *b, const char *fmt, ...)
+{
+    va_list args;
+    char num[12];
+
+    va_start(args, fmt);
+
+    for (; *fmt; ++fmt) {
+        int left = 0;
+        char pad = ' ';
+        int width = 0;
+
+        if (*fmt != '%') {
+            procfs_putc(b, *fmt);
+            continue;
+        }
+
+        ++fmt;
+
+        if (*fmt == '-') {
+            left = 1;
+            ++fmt;
+        } else if (*fmt == '0') {
+            pad = '0';
+            ++fmt;
+        }
+
+        for (; *fmt >= '0' && *fmt <= '9'; ++fmt)
+            width = width * 10 + *fmt - '0';
+
+        switch (*fmt) {
+        case 's':
+            procfs_field(b, va_arg(args, const char *), width, left, ' ');
+            break;
+        case 'd': {
+            int32_t n = va_arg(args, int32_t);
+
+            procfs_number(num, n < 0 ? -n : n, 10, n < 0);
+            procfs_field(b, num, width, left, pad);
+            break;
+        }
+        case 'u':
+            procfs_number(num, va_arg(args, uint32_t), 10, 0);
+            procfs_field(b, num, width, left, pad);
+            break;
+        case 'x':
+            procfs_number(num, va_arg(args, uint32_t), 16, 0);
+            procfs_field(b, num, width, left, pad);
+            break;
+        case '%':
+            procfs_putc(b, '%');
+            break;
+        default:
+            va_end(args);
+            return;
+        }
+    }
+
+    va_end(args);
+}
+
+static int procfs_queued(struct klist *input, spinlock_t *lock)
+{
+    struct klist *pos;
+    int count = 0;
+
+    spinlock_lock(lock);
+
+    for (pos = input->next; pos != input; pos = pos->next)
+        ++count;
+
+    spinlock_unlock(lock);
+
+    return count;
+}
+
+static const char *procfs_thread_state(int state)
+{
+    switch (state) {
+    case THREAD_STATE_RUNNING:
+        return "running";
+    case THREAD_STATE_BLOCKED:
+        return "blocked";
+    case THREAD_STATE_ZOMBIE:
+        return "zombie";
+    default:
+        return "unknown";
+    }
+}
+
+static const char *procfs_policy(int policy)
+{
+    switch (policy) {
+    case SCHED_NORMAL:
+        return "normal";
+    case SCHED_BATCH:
+        return "batch";
+    case SCHED_FIFO:
+        return "fifo";
+    default:
+        return "unknown";
+    }
+}
+
+static void procfs_show_wait(struct thread *t, struct procfs_buf *b)
+{
+    static const char *events[] = {
+        [SCHED_EV_TIMER] = "timer",
+        [SCHED_EV_INTERRUPT] = "interrupt",
+        [SCHED_EV_REQ] = "request",
+        [SCHED_EV_RESP] = "response",
+        [SCHED_EV_PEXIT] = "pexit",
+        [SCHED_EV_PEXIT_PARENT] = "pexit-child",
+    };
+
+    if (t->state != THREAD_STATE_BLOCKED)
+        procfs_printf(b, "-");
+    else if (t->futex)
+        procfs_printf(b, "futex 0x%x", t->futex->key);
+    else if (t->event.event > SCHED_EV_NONE && t->event.event <= SCHED_EV_SIZE)
+        procfs_printf(b, "%s 0x%x", events[t->event.event], t->event.data);
+    else
+        procfs_printf(b, "queue");
+}
+
+static void procfs_show_status(struct process *p, struct procfs_buf *b)
+{
+    procfs_printf(b, "name:    %s\n", p->name);
+    procfs_printf(b, "pid:     %d\n", p->pid);
+    procfs_printf(b, "ppid:    %d\n", p->parent ? p->parent->pid : -1);
+    procfs_printf(b, "state:   %s\n",
+                  p->state == PROCESS_STATE_ALIVE ? "alive" : "zombie");
+    procfs_printf(b, "type:    %s\n",
+                  p->type & PROCESS_TYPE_USER ? "user" : "kernel");
+    procfs_printf(b, "threads: %u\n", p->thread_count);
+
+    if (p->state == PROCESS_STATE_ZOMBIE)
+        procfs_printf(b, "exit:    %d\n", p->exit_state);
+}
+
+static void procfs_show_threads(struct process *p, struct procfs_buf *b)
+{
+    struct thread *t;
+
+    procfs_printf(b, "TID STATE   CPU POLICY NICE PRIO   USER    SYS   VCSW"
+                     "  IVCSW WAIT\n");
+
+    klist_for_each_elem(&p->threads, t, list) {
+        procfs_printf(b, "%3d %-7s %3d %-6s %4d %4d %6u %6u %6u %6u ",
+                      t->tid, procfs_thread_state(t->state), t->cpu,
+                      procfs_policy(t->sattr.policy), t->sattr.nice,
+                      t->sattr.rt_priority, t->stats.user_ticks,
+                      t->stats.kernel_ticks, t->stats.voluntary,
+                      t->stats.involuntary);
+
+        procfs_show_wait(t, b);
+
+        procfs_putc(b, '\n');
+    }
+}
+
+static void procfs_show_maps(struct process *p, struct procfs_buf *b)
+{
+    struct as_mapping *map;
+    struct as *as = p->as;
+
+    /* The address space of a zombie may already be released */
+    if (p->state != PROCESS_STATE_ALIVE || !as)
+        return;
+
+    procfs_printf(b, "START    END            SIZE PERM PHYSICAL REFS COW\n");
+
+    rwlock_read_lock(&as->map_lock);
+
+    klist_for_each_elem(&as->mapping, map, list) {
+        char perm[5] = "r---";
+
+        if (map->flags & AS_MAP_WRITE)
+            perm[1] = 'w';
+        if (map->flags & AS_MAP_EXEC)
+            perm[2] = 'x';
+        if (map->flags & AS_MAP_USER)
+            perm[3] = 'u';
+
+        procfs_printf(b, "%08x-%08x %10u %s ", map->virt,
+                      map->virt + map->size, map->size, perm);
+
+        if (map->phy)
+            procfs_printf(b, "%08x %4u %s\n", map->phy->base,
+                          map->phy->ref_count,
+                          map->phy->flags & SEGMENT_FLAGS_COW ? "yes" : "no");
+        else
+            procfs_printf(b, "-           - -\n");
+    }
+
+    rwlock_read_unlock(&as->map_lock);
+}
+
+static void procfs_show_fds(struct process *p, struct procfs_buf *b)
+{
+    procfs_printf(b, " FD     OFFSET TYPE     TARGET\n");
+
+    spinlock_lock(&p->files_lock);
+
+    for (int i = 0; i < PROCESS_MAX_OPEN_FD; ++i) {
+        struct file *file = &p->files[i];
+
+        if (!file->used || !file->f_ops)
+            continue;
+
+        /* A channel being opened has no private data yet */
+        if ((file->f_ops == &channel_master_f_ops ||
+             file->f_ops == &channel_slave_f_ops) && !file->private)
+            continue;
+
+        procfs_printf(b, "%3d %10u ", i, (uint32_t)file->offset);
+
+        if (file->f_ops == &channel_master_f_ops) {
+            struct channel *channel = file->private;
+
+            procfs_printf(b, "channel  %s (master)\n", channel->name);
+        } else if (file->f_ops == &channel_slave_f_ops) {
+            struct channel_slave *slave = file->private;
+
+            procfs_printf(b, "channel  %s:%u\n", slave->parent->name,
+                          slave->id);
+        } else if (file->mount) {
+            procfs_printf(b, "file     %s inode %u", file->mount->path,
+                          file->inode ? (uint32_t)file->inode->inode : 0);
+
+            /* Readahead window and how well it predicts the reads */
+            if (file->f_ops == &fiu_f_ops && file->private) {
+                struct fiu_file_private *priv = file->private;
+
+                procfs_printf(b, " ra %u hits %u misses %u", priv->ra_window,
+                              priv->ra_hits, priv->ra_misses);
+            }
+
+            procfs_printf(b, "\n");
+        } else {
+            struct device *device = NULL;
+
+            if (file->inode)
+                device = device_get(file->inode->dev);
+
+            procfs_printf(b, "device   %s\n", device ? device->name : "?");
+        }
+    }
+
+    spinlock_unlock(&p->files_lock);
+}
+
+static void procfs_show_channels(struct process *p, struct procfs_buf *b)
+{
+    procfs_printf(b, " FD END    CHANNEL              ID QUEUED  BYTES   HIGH "
+                  "CREDIT   FULL  WAITS\n");
+
+    spinlock_lock(&p->files_lock);
+
+    for (int i = 0; i < PROCESS_MAX_OPEN_FD; ++i) {
+        struct file *file = &p->files[i];
+        struct channel_slave *slave = NULL;
+        const char *end = "slave";
+
+        if (!file->used || !file->f_ops || !file->private)
+            continue;
+
+        if (file->f_ops == &channel_master_f_ops) {
+            struct channel *channel = file->private;
+
+            procfs_printf(b, "%3d master %-20s  - %6d %6u %6u %6u %6u      -\n",
+                          i, channel->name,
+                          procfs_queued(&channel->input, &channel->lock),
+                          channel->limit.bytes, channel->limit.high_msgs,
+                          channel->limit.max_msgs - channel->limit.msgs,
+                          channel->limit.full);
+            continue;
+        }
+
+        if (file->f_ops == &channel_slave_f_ops) {
+            slave = file->private;
+        } else if (file->f_ops == &fiu_f_ops && file->private) {
+            /* Files of FIU file systems talk to their server on a slave */
+            slave = ((struct fiu_file_private *)file->private)->slave;
+            end = "fiu";
+        }
+
+        /* The credit of a slave is what it can still queue on the master */
+        if (slave)
+            procfs_printf(b, "%3d %-6s %-20s %2u %6d %6u %6u %6u %6u %6u\n",
+                          i, end, slave->parent->name, slave->id,
+                          procfs_queued(&slave->input, &slave->lock),
+                          slave->limit.bytes, slave->limit.high_msgs,
+                          slave->credit.max_msgs - slave->credit.msgs,
+                          slave->limit.full, slave->credit.full);
+    }
+
+    spinlock_unlock(&p->files_lock);
+}
+
+static int procfs_exists(struct process __unused *p, void __unused *data)
+{
+    return 0;
+}
+
+static int procfs_generate(struct process *p, void *data)
+{
+    struct procfs_generate_req *req = data;
+
+    procfs_files[req->file].show(p, &req->buf);
+
+    return 0;
+}
+
+static int procfs_open(struct file __unused *file, ino_t inode,
+                       pid_t __unused pid, uid_t __unused uid,
+                       gid_t __unused gid, int __unused flags,
+                       mode_t __unused mode)
+{
+    if (inode == PROCFS_INODE_ROOT)
+        return inode;
+
+    if (PROCFS_INODE_FILE(inode) >= PROCFS_FILE_COUNT)
+        return -EINVAL;
+
+    if (process_call(PROCFS_INODE_PID(inode), procfs_exists, NULL) < 0)
+        return -ENOENT;
+
+    return inode;
+}
+
+static int procfs_read(struct file __unused *file, struct process __unused *p,
+                       struct req_rdwr *req, void *buf)
+{
+    struct procfs_generate_req gen;
+    struct procfs_buf *b = &gen.buf;
+    size_t size;
+    int ret;
+
+    if (req->inode == PROCFS_INODE_ROOT ||
+        PROCFS_INODE_FILE(req->inode) == PROCFS_FILE_DIR)
+        return -EISDIR;
+
+    if (PROCFS_INODE_FILE(req->inode) >= PROCFS_FILE_COUNT)
+        return -EINVAL;
+
+    b->data = kmalloc(PROCFS_BUF_SIZE);
+    if (!b->data)
+        return -ENOMEM;
+
+    /* Room is kept for the truncation marker */
+    b->size = PROCFS_BUF_SIZE - sizeof (PROCFS_TRUNCATED);
+    b->len = 0;
+    b->truncated = 0;
+
+    /*
+     * The content is generated again for each read, so a file read in
+     * several chunks may be inconsistent if the process changed meanwhile
+     */
+    gen.file = PROCFS_INODE_FILE(req->inode);
+
+    ret = process_call(PROCFS_INODE_PID(req->inode), procfs_generate, &gen);
+    if (ret < 0) {
+        kfree(b->data);
+        return ret;
+    }
+
+    if (b->truncated) {
+        memcpy(b->data + b->len, PROCFS_TRUNCATED,
+               sizeof (PROCFS_TRUNCATED) - 1);
+        b->len += sizeof (PROCFS_TRUNCATED) - 1;
+    }
+
+    size = 0;
+    if (req->off < b->len) {
+        size = b->len - (size_t)req->off;
+        if (size > req->size)
+            size = req->size;
+
+        memcpy(buf, b->data + (size_t)req->off, size);
+    }
+
+    kfree(b->data);
+
+    req->off += size;
+
+    return size;
+}
+
+static int procfs_close(struct file __unused *file, ino_t __unused inode)
+{
+    return 0;
+}
+
+static int procfs_lookup(struct mount_entry __unused *root, const char *path,
+                         uid_t __unused uid, gid_t __unused gid,
+                         struct resp_lookup *resp)
+{
+    pid_t pid = 0;
+    const char *start;
+
+    resp->processed = 0;
+
+    if (*path == '/') {
+        ++path;
+        ++resp->processed;
+    }
+
+    resp->inode.dev = -1;
+    resp->ret = RES_OK;
+
+    /* Root node */
+    if (!strcmp(path, "") || !strcmp(path, "/")) {
+        resp->inode.inode = PROCFS_INODE_ROOT;
+        return 0;
+    }
+
+    /* Process directory */
+    for (start = path; *path >= '0' && *path <= '9'; ++path) {
+        pid = pid * 10 + *path - '0';
+        if (pid >= PROCESS_MAX_PID)
+            return -ENOENT;
+    }
+
+    if (path == start || (*path && *path != '/'))
+        return -ENOENT;
+
+    if (process_call(pid, procfs_exists, NULL) < 0)
+        return -ENOENT;
+
+    resp->processed += path - start;
+    resp->inode.inode = PROCFS_INODE(pid, PROCFS_FILE_DIR);
+
+    if (!*path || !strcmp(path, "/"))
+        return 0;
+
+    /* File of the process directory */
+    ++path;
+
+    for (size_t i = 1; i < PROCFS_FILE_COUNT; ++i) {
+        if (!strcmp(path, procfs_files[i].name)) {
+            resp->processed += 1 + strlen(path);
+            resp->inode.inode = PROCFS_INODE(pid, i);
+
+            return 0;
+        }
+    }
+
+    return -ENOENT;
+}
+
+static int procfs_stat(struct mount_entry __unused *mount, uid_t __unused uid,
+                       gid_t __unused gid, ino_t inode, struct stat *stat)
+{
+    stat->st_dev = -1;
+    stat->st_ino = inode;
+
+    if (inode == PROCFS_INODE_ROOT)
+        stat->st_mode = VFS_FTYPE_DIR;
+    else if (PROCFS_INODE_FILE(inode) >= PROCFS_FILE_COUNT)
+        return -EINVAL;
+    else if (process_call(PROCFS_INODE_PID(inode), procfs_exists, NULL) < 0)
+        return -ENOENT;
+    else if (PROCFS_INODE_FILE(inode) == PROCFS_FILE_DIR)
+        stat->st_mode = VFS_FTYPE_DIR;
+    else
+        stat->st_mode = VFS_FTYPE_FILE;
+
+    /* The size of a file is only known once it is generated */
+    stat->st_nlink = 0;
+    stat->st_uid = 0;
+    stat->st_gid = 0;
+    stat->st_rdev = 0;
+    stat->st_size = 0;
+    stat->st_blksize = 0;
+    stat->st_blocks = 0;
+    stat->st_atime = 0;
+    stat->st_mtime = 0;
+    stat->st_ctime = 0;
+
+    return 0;
+}
+
+static int procfs_getdirent(struct mount_entry __unused *mount, ino_t inode,
+                            struct dirent *dirent, int index)
+{
+    pid_t pid;
+
+    if (index < 0)
+        return 0;
+
+    if (inode == PROCFS_INODE_ROOT) {
+        pid = process_pid_at(index);
+        if (pid < 0)
+            return 0;
+
+        dirent->d_ino = PROCFS_INODE(pid, PROCFS_FILE_DIR);
+
+        procfs_number(dirent->d_name, pid, 10, 0);
+
+        return 1;
+    }
+
+    if (PROCFS_INODE_FILE(inode) != PROCFS_FILE_DIR)
+        return -EINVAL;
+
+    /* Index 0 of procfs_files is the directory itself */
+    if ((size_t)index + 1 >= PROCFS_FILE_COUNT)
+        return 0;
+
+    dirent->d_ino = PROCFS_INODE(PROCFS_INODE_PID(inode), index + 1);
+
+    strcpy(dirent->d_name, procfs_files[index + 1].name);
+
+    return 1;
+}
+
+static int procfs_create(struct fs_instance *fi, const char __unused *device,
+                         const char __unused *mount_pt)
+{
+    struct procfs *procfs = fi->parent->private;
+
+    spinlock_lock(&procfs->lock);
+
+    /* Procfs can be mounted only once */
+    if (procfs->mounted) {
+        spinlock_unlock(&procfs->lock);
+        return -EBUSY;
+    }
+
+    procfs->mounted = 1;
+    spinlock_unlock(&procfs->lock);
+
+    return 0;
+}
+
+static struct file_operation procfs_f_ops = {
+    .open = procfs_open,
+    .read = procfs_read,
+    .close = procfs_close,
+};
+
+static struct fs_operation procfs_ops = {
+    .lookup = procfs_lookup,
+    .stat = procfs_stat,
+    .getdirent = procfs_getdirent,
+};
+
+static struct fs_super_operation procfs_sup_ops = {
+    .create = procfs_create,
+};
+
+int procfs_initialize(void)
+{
+    struct procfs *procfs;
+
+    procfs = kmalloc(sizeof (struct procfs));
+    if (!procfs)
+        return -ENOMEM;
+
+    procfs->mounted = 0;
+    spinlock_init(&procfs->lock);
+
+    return fs_register(FS_NAME, 0, &procfs_sup_ops, &procfs_ops,
+                       &procfs_f_ops, procfs);
+}
@@ -0,0 +1,166 @@
+/*
+ * zOS
+ * Copyright (C) 2015 Baptiste Covolato
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zOS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file    kernel/core/fs/vfs/acache.c
+ * \brief   Implementation of the attribute cache
+ *
+ * \author  Baptiste Covolato
+ */
+
+#include <kernel/time.h>
+
+#include <kernel/mem/kmalloc.h>
+
+#include <kernel/fs/vfs/acache.h>
+
+void acache_initialize(struct acache *ac)
+{
+    for (int i = 0; i < ACACHE_BUCKETS; ++i)
+        klist_head_init(&ac->buckets[i]);
+
+    lru_initialize(&ac->lru, ACACHE_MAX_ENTRIES);
+
+    ac->generation = 0;
+
+    spinlock_init(&ac->lock);
+}
+
+static inline struct klist *acache_bucket(struct acache *ac, ino_t inode)
+{
+    return &ac->buckets[inode & (ACACHE_BUCKETS - 1)];
+}
+
+static struct acache_entry *acache_find(struct acache *ac, ino_t inode)
+{
+    struct acache_entry *entry;
+
+    klist_for_each_elem(acache_bucket(ac, inode), entry, node.hash) {
+        if (entry->inode == inode)
+            return entry;
+    }
+
+    return NULL;
+}
+
+int acache_lookup(struct acache *ac, ino_t inode, struct stat *buf)
+{
+    struct acache_entry *entry;
+
+    spinlock_lock(&ac->lock);
+
+    entry = acache_find(ac, inode);
+    if (!entry) {
+        spinlock_unlock(&ac->lock);
+        return 0;
+    }
+
+    /* The ticks wrap, compare the distance to the end of the lease */
+    if (!entry->infinite &&
+        (int32_t)(entry->expire - timer_ticks_get()) <= 0) {
+        lru_drop(&ac->lru, &entry->node);
+
+        spinlock_unlock(&ac->lock);
+
+        return 0;
+    }
+
+    lru_touch(&ac->lru, &entry->node);
+
+    *buf = entry->stat;
+
+    spinlock_unlock(&ac->lock);
+
+    return 1;
+}
+
+uint32_t acache_generation(struct acache *ac)
+{
+    uint32_t generation;
+
+    spinlock_lock(&ac->lock);
+
+    generation = ac->generation;
+
+    spinlock_unlock(&ac->lock);
+
+    return generation;
+}
+
+void acache_add(struct acache *ac, uint32_t generation, ino_t inode,
+                const struct stat *buf, uint32_t lease)
+{
+    struct acache_entry *entry;
+    struct acache_entry *new;
+    struct lru_node *node;
+
+    if (!lease)
+        return;
+
+    node = lru_alloc(&ac->lru, sizeof (struct acache_entry));
+
+    spinlock_lock(&ac->lock);
+
+    if (ac->generation != generation) {
+        spinlock_unlock(&ac->lock);
+
+        if (node)
+            kfree(node);
+
+        return;
+    }
+
+    entry = acache_find(ac, inode);
+
+    node = lru_claim(&ac->lru, entry ? &entry->node : NULL, node);
+    if (!node) {
+        spinlock_unlock(&ac->lock);
+        return;
+    }
+
+    new = klist_elem(node, struct acache_entry, node);
+
+    new->inode = inode;
+    new->infinite = lease == ACACHE_LEASE_INFINITE;
+    new->expire = timer_ticks_get() + ms_to_ticks(lease);
+    new->stat = *buf;
+
+    lru_insert(&ac->lru, acache_bucket(ac, inode), node);
+
+    spinlock_unlock(&ac->lock);
+}
+
+void acache_invalidate(struct acache *ac, ino_t inode)
+{
+    struct acache_entry *entry;
+
+    spinlock_lock(&ac->lock);
+
+    ++ac->generation;
+
+    if (inode) {
+        entry = acache_find(ac, inode);
+        if (entry)
+            lru_drop(&ac->lru, &entry->node);
+    } else {
+        klist_for_each(&ac->lru.entries, elem, lru)
+            lru_drop(&ac->lru, klist_elem(elem, struct lru_node, lru));
+    }
+
+    spinlock_unlock(&ac->lock);
+}
@@ -0,0 +1,228 @@
+/*
+ * zOS
+ * Copyright (C) 2015 Baptiste Covolato
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zOS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file    kernel/core/fs/vfs/dcache.c
+ * \brief   Implementation of the lookup cache
+ *
+ * \author  Baptiste Covolato
+ */
+
+#include <string.h>
+
+#include <kernel/errno.h>
+
+#include <kernel/mem/kmalloc.h>
+
+#include <kernel/fs/vfs/dcache.h>
+
+void dcache_initialize(struct dcache *dc)
+{
+    for (int i = 0; i < DCACHE_BUCKETS; ++i)
+        klist_head_init(&dc->buckets[i]);
+
+    lru_initialize(&dc->lru, DCACHE_MAX_ENTRIES);
+
+    dc->generation = 0;
+
+    spinlock_init(&dc->lock);
+}
+
+/**
+ *  \brief  FNV-1a hash of the path, mixed with the credentials
+ */
+static uint32_t dcache_key(const char *path, uid_t uid, gid_t gid)
+{
+    uint32_t hash = 2166136261u;
+
+    for (; *path; ++path) {
+        hash ^= (unsigned char)*path;
+        hash *= 16777619u;
+    }
+
+    hash ^= uid;
+    hash *= 16777619u;
+    hash ^= gid;
+    hash *= 16777619u;
+
+    return hash;
+}
+
+static struct dcache_entry *dcache_find(struct dcache *dc, uint32_t key,
+                                        const char *path, uid_t uid,
+                                        gid_t gid)
+{
+    struct dcache_entry *entry;
+
+    klist_for_each_elem(&dc->buckets[key & (DCACHE_BUCKETS - 1)], entry,
+                        node.hash) {
+        if (entry->key == key && entry->uid == uid && entry->gid == gid &&
+            !strcmp(entry->path, path))
+            return entry;
+    }
+
+    return NULL;
+}
+
+int dcache_lookup(struct dcache *dc, const char *path, uid_t uid, gid_t gid,
+                  struct resp_lookup *res)
+{
+    uint32_t key = dcache_key(path, uid, gid);
+    struct dcache_entry *entry;
+
+    spinlock_lock(&dc->lock);
+
+    entry = dcache_find(dc, key, path, uid, gid);
+    if (!entry) {
+        spinlock_unlock(&dc->lock);
+        return 0;
+    }
+
+    lru_touch(&dc->lru, &entry->node);
+
+    *res = entry->res;
+
+    spinlock_unlock(&dc->lock);
+
+    return 1;
+}
+
+uint32_t dcache_generation(struct dcache *dc)
+{
+    uint32_t generation;
+
+    spinlock_lock(&dc->lock);
+
+    generation = dc->generation;
+
+    spinlock_unlock(&dc->lock);
+
+    return generation;
+}
+
+void dcache_add(struct dcache *dc, uint32_t generation, const char *path,
+                uid_t uid, gid_t gid, const struct resp_lookup *res)
+{
+    uint32_t key;
+    struct dcache_entry *entry;
+    struct dcache_entry *new;
+    struct lru_node *node;
+
+    if (res->ret < 0 && res->ret != -ENOENT)
+        return;
+
+    if (strlen(path) >= DCACHE_PATH_MAX)
+        return;
+
+    key = dcache_key(path, uid, gid);
+
+    node = lru_alloc(&dc->lru, sizeof (struct dcache_entry));
+
+    spinlock_lock(&dc->lock);
+
+    if (dc->generation != generation) {
+        spinlock_unlock(&dc->lock);
+
+        if (node)
+            kfree(node);
+
+        return;
+    }
+
+    /* Another thread looked the same path up meanwhile */
+    entry = dcache_find(dc, key, path, uid, gid);
+
+    node = lru_claim(&dc->lru, entry ? &entry->node : NULL, node);
+    if (!node) {
+        spinlock_unlock(&dc->lock);
+        return;
+    }
+
+    new = klist_elem(node, struct dcache_entry, node);
+
+    new->key = key;
+    new->uid = uid;
+    new->gid = gid;
+    new->res = *res;
+    strcpy(new->path, path);
+
+    lru_insert(&dc->lru, &dc->buckets[key & (DCACHE_BUCKETS - 1)], node);
+
+    spinlock_unlock(&dc->lock);
+}
+
+static void dcache_drop(struct dcache *dc, struct dcache_entry *entry)
+{
+    lru_drop(&dc->lru, &entry->node);
+}
+
+/**
+ *  \brief  Drop the entries of the paths under \a path
+ */
+static void dcache_drop_under(struct dcache *dc, const char *path)
+{
+    size_t len = strlen(path);
+    struct dcache_entry *entry;
+
+    klist_for_each(&dc->lru.entries, elem, lru) {
+        entry = klist_elem(elem, struct dcache_entry, node.lru);
+
+        if (!strncmp(entry->path, path, len) && entry->path[len] == '/')
+            dcache_drop(dc, entry);
+    }
+}
+
+void dcache_invalidate(struct dcache *dc, ino_t inode)
+{
+    struct dcache_entry *entry;
+    char path[DCACHE_PATH_MAX];
+    int found;
+
+    spinlock_lock(&dc->lock);
+
+    ++dc->generation;
+
+    do {
+        found = 0;
+
+        klist_for_each(&dc->lru.entries, elem, lru) {
+            entry = klist_elem(elem, struct dcache_entry, node.lru);
+
+            if (entry->res.ret < 0) {
+                dcache_drop(dc, entry);
+                continue;
+            }
+
+            if (inode && entry->res.inode.inode != inode)
+                continue;
+
+            /* The iterator may point to an entry under this one */
+            strcpy(path, entry->path);
+
+            dcache_drop(dc, entry);
+
+            found = 1;
+            break;
+        }
+
+        if (found)
+            dcache_drop_under(dc, path);
+    } while (found);
+
+    spinlock_unlock(&dc->lock);
+}
@@ -26,6 +26,7 @@
 #include <string.h>
 
 #include <kernel/errno.h>
+#include <kernel/idmap.h>
 
 #include <kernel/mem/kmalloc.h>
 
@@ -37,8 +38,35 @@
 
 #include <arch/spinlock.h>
 
+/**
+ *  \brief  Number of buckets of the device table (must be a power of 2)
+ */
+#define DEVICE_HASH_SIZE 64
+
 static struct device devices[VFS_MAX_DEVICE];
-static spinlock_t device_lock = SPINLOCK_INIT;
+static rwlock_t device_lock = RWLOCK_INIT;
+
+static struct klist device_buckets[DEVICE_HASH_SIZE];
+static struct htable device_table;
+
+static struct idmap device_ids;
+static uint32_t device_id_bitmap[IDMAP_WORDS(VFS_MAX_DEVICE)];
+
+int device_initialize(void)
+{
+    htable_initialize(&device_table, device_buckets, DEVICE_HASH_SIZE,
+                      VFS_DEV_MAX_NAMEL);
+
+    idmap_initialize(&device_ids, device_id_bitmap, VFS_MAX_DEVICE,
+                     IDMAP_FIRST_FIT);
+
+    return 0;
+}
+
+static struct device *device_from_name_nolock(const char *name)
+{
+    return htable_get_elem(&device_table, name, struct device, hash);
+}
 
 /**
  *  \brief  Find a free device id and verify that a device named \a name
@@ -50,17 +78,13 @@ static spinlock_t device_lock = SPINLOCK_INIT;
  */
 static dev_t find_free_device(const char *name, struct device **dev)
 {
-    dev_t id = -1;
+    dev_t id;
 
-    for (int i = 0; i < VFS_MAX_DEVICE; ++i) {
-        if (id == -1 && !devices[i].active)
-            id = i;
-
-        if (devices[i].active && !strcmp(devices[i].name, name))
-            return -EEXIST;
-    }
+    if (device_from_name_nolock(name))
+        return -EEXIST;
 
-    if (id == -1)
+    id = idmap_alloc(&device_ids);
+    if (id < 0)
         return -EBUSY;
 
     *dev = &devices[id];
@@ -78,25 +102,27 @@ static dev_t device_create(pid_t pid, const char *name, vop_t ops,
     if (!(ops & VFS_OPS_OPEN) || !(ops & VFS_OPS_CLOSE))
         return -EINVAL;
 
-    spinlock_lock(&device_lock);
+    rwlock_write_lock(&device_lock);
 
     dev_id = find_free_device(name, &new_dev);
     if (dev_id < 0) {
-        spinlock_unlock(&device_lock);
+        rwlock_write_unlock(&device_lock);
         return dev_id;
     }
 
-    new_dev->active = 1;
-    strncpy(new_dev->name, name, VFS_DEV_MAX_NAMEL);
-
-    spinlock_unlock(&device_lock);
-
     new_dev->id = dev_id;
     new_dev->pid = pid;
     new_dev->ops = ops;
     new_dev->f_ops = f_ops;
     new_dev->private = private;
 
+    strncpy(new_dev->name, name, VFS_DEV_MAX_NAMEL);
+    htable_add(&device_table, &new_dev->hash, new_dev->name);
+
+    new_dev->active = 1;
+
+    rwlock_write_unlock(&device_lock);
+
     if (device)
         *device = new_dev;
 
@@ -124,15 +150,18 @@ struct device *device_get(dev_t dev)
 
 dev_t device_get_from_name(const char *name)
 {
-    for (int i = 0; i < VFS_MAX_DEVICE; ++i) {
-        if (!devices[i].active)
-            continue;
+    dev_t id = -ENODEV;
+    struct device *device;
 
-        if (!strcmp(devices[i].name, name))
-            return devices[i].id;
-    }
+    rwlock_read_lock(&device_lock);
 
-    return -ENODEV;
+    device = device_from_name_nolock(name);
+    if (device)
+        id = device->id;
+
+    rwlock_read_unlock(&device_lock);
+
+    return id;
 }
 
 struct device *device_get_from_index(int index)
@@ -140,12 +169,12 @@ struct device *device_get_from_index(int index)
     if (index < 0 || index > VFS_MAX_DEVICE)
         return NULL;
 
-    spinlock_lock(&device_lock);
+    rwlock_read_lock(&device_lock);
 
     for (int i = 0; i < VFS_MAX_DEVICE; ++i) {
         if (devices[i].active) {
             if (!index) {
-                spinlock_unlock(&device_lock);
+                rwlock_read_unlock(&device_lock);
                 return &devices[i];
             }
 
@@ -153,19 +182,22 @@ struct device *device_get_from_index(int index)
         }
     }
 
-    spinlock_unlock(&device_lock);
+    rwlock_read_unlock(&device_lock);
 
     return NULL;
 }
 
 int device_exists(const char *name)
 {
-    for (int i = 0; i < VFS_MAX_DEVICE; ++i) {
-        if (devices[i].active && !strcmp(devices[i].name, name))
-            return 1;
-    }
+    int exists;
 
-    return 0;
+    rwlock_read_lock(&device_lock);
+
+    exists = device_from_name_nolock(name) != NULL;
+
+    rwlock_read_unlock(&device_lock);
+
+    return exists;
 }
 
 int device_destroy(pid_t pid, dev_t dev)
@@ -173,17 +205,24 @@ int device_destroy(pid_t pid, dev_t dev)
     if (dev < 0 || dev >= VFS_MAX_DEVICE)
         return -EINVAL;
 
-    if (!devices[dev].active)
+    rwlock_write_lock(&device_lock);
+
+    if (!devices[dev].active) {
+        rwlock_write_unlock(&device_lock);
         return -ENODEV;
+    }
 
-    if (devices[dev].pid != pid)
+    if (devices[dev].pid != pid) {
+        rwlock_write_unlock(&device_lock);
         return -EINVAL;
-
-    spinlock_lock(&device_lock);
+    }
 
     devices[dev].active = 0;
+    htable_del(&devices[dev].hash);
+
+    rwlock_write_unlock(&device_lock);
 
-    spinlock_unlock(&device_lock);
+    idmap_free(&device_ids, dev);
 
     return 0;
 }
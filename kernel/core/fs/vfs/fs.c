@@ -33,28 +33,27 @@
 
 #include <arch/spinlock.h>
 
+/**
+ *  \brief  Number of buckets of the file system table (must be a power of 2)
+ */
+#define FS_HASH_SIZE 16
+
 static spinlock_t fs_lock;
-static struct klist fs_list;
+static struct klist fs_buckets[FS_HASH_SIZE];
+static struct htable fs_table;
 
 int fs_initialize(void)
 {
     spinlock_init(&fs_lock);
 
-    klist_head_init(&fs_list);
+    htable_initialize(&fs_table, fs_buckets, FS_HASH_SIZE, VFS_FS_MAX_NAMEL);
 
     return 0;
 }
 
 static struct fs *fs_from_name_nolock(const char *name)
 {
-    struct fs *fs;
-
-    klist_for_each_elem(&fs_list, fs, list) {
-        if (!strncmp(fs->name, name, VFS_FS_MAX_NAMEL))
-            return fs;
-    }
-
-    return NULL;
+    return htable_get_elem(&fs_table, name, struct fs, hash);
 }
 
 struct fs *fs_from_name(const char *name)
@@ -102,7 +101,7 @@ int fs_register(const char *name, pid_t pid,
         return -EEXIST;
     }
 
-    klist_add(&fs_list, &fs->list);
+    htable_add(&fs_table, &fs->hash, fs->name);
     spinlock_unlock(&fs_lock);
 
     return 0;
@@ -125,7 +124,7 @@ int fs_unregister(const char *name, pid_t pid)
         return -EPERM;
     }
 
-    klist_del(&fs->list);
+    htable_del(&fs->hash);
 
     spinlock_unlock(&fs_lock);
 
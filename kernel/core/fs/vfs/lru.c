@@ -0,0 +1,101 @@
+/*
+ * zOS
+ * Copyright (C) 2015 Baptiste Covolato
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zOS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file    kernel/core/fs/vfs/lru.c
+ * \brief   Implementation of the bounded LRU lists of the VFS caches
+ *
+ * \author  Baptiste Covolato
+ */
+
+#include <kernel/mem/kmalloc.h>
+
+#include <kernel/fs/vfs/lru.h>
+
+void lru_initialize(struct lru *lru, int max)
+{
+    klist_head_init(&lru->entries);
+
+    lru->count = 0;
+    lru->max = max;
+}
+
+struct lru_node *lru_alloc(struct lru *lru, size_t size)
+{
+    /* Allocations are done unlocked, the count is only a hint here */
+    if (lru->count >= lru->max)
+        return NULL;
+
+    return kmalloc(size);
+}
+
+struct lru_node *lru_claim(struct lru *lru, struct lru_node *found,
+                           struct lru_node *new)
+{
+    if (found) {
+        klist_del(&found->hash);
+        klist_del(&found->lru);
+
+        if (new)
+            kfree(new);
+
+        return found;
+    }
+
+    if (new && lru->count < lru->max) {
+        ++lru->count;
+
+        return new;
+    }
+
+    if (new)
+        kfree(new);
+
+    if (klist_empty(&lru->entries))
+        return NULL;
+
+    /* Recycle the least recently used entry */
+    new = klist_elem(lru->entries.prev, struct lru_node, lru);
+
+    klist_del(&new->hash);
+    klist_del(&new->lru);
+
+    return new;
+}
+
+void lru_insert(struct lru *lru, struct klist *bucket, struct lru_node *node)
+{
+    klist_add(bucket, &node->hash);
+    klist_add(&lru->entries, &node->lru);
+}
+
+void lru_touch(struct lru *lru, struct lru_node *node)
+{
+    klist_del(&node->lru);
+    klist_add(&lru->entries, &node->lru);
+}
+
+void lru_drop(struct lru *lru, struct lru_node *node)
+{
+    klist_del(&node->hash);
+    klist_del(&node->lru);
+
+    --lru->count;
+
+    kfree(node);
+}
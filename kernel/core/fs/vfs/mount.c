@@ -18,41 +18,186 @@
 
 # define MAX_MOUNTED_PATH 5
 
+/*
+ * Mount points are indexed by a trie of path components, the root node is
+ * "/". A node exists for every component of a mount path, entry is only set
+ * on the nodes of mount points
+ */
+struct mount_node {
+    const char *name;
+    size_t len;
+
+    struct mount_entry *entry;
+
+    struct klist children;
+    struct klist list;
+};
+
 static struct mount_entry mounts[MAX_MOUNTED_PATH];
-static spinlock_t mount_lock = SPINLOCK_INIT;
+static rwlock_t mount_lock = RWLOCK_INIT;
+
+static struct mount_node mount_root = {
+    .name = "",
+    .len = 0,
+    .entry = NULL,
+    .children = { &mount_root.children, &mount_root.children },
+    .list = { NULL, NULL },
+};
+
+static struct mount_node *mount_node_child(struct mount_node *node,
+                                           const char *name, size_t len)
+{
+    struct mount_node *child;
+
+    klist_for_each_elem(&node->children, child, list) {
+        if (child->len == len && !strncmp(child->name, name, len))
+            return child;
+    }
+
+    return NULL;
+}
+
+/*
+ * Find the deepest mount point that is a prefix of the first len characters
+ * of path, on a component boundary. *matched is set to the length of the
+ * path covered by the mount point
+ */
+static struct mount_entry *mount_trie_match(const char *path, size_t len,
+                                            size_t *matched)
+{
+    struct mount_node *node = &mount_root;
+    struct mount_entry *entry = mount_root.entry;
+    size_t i = 0;
+
+    *matched = 0;
+
+    for (;;) {
+        size_t start;
+
+        while (i < len && path[i] == '/')
+            ++i;
+
+        if (i == len)
+            break;
+
+        start = i;
+        while (i < len && path[i] != '/')
+            ++i;
+
+        node = mount_node_child(node, path + start, i - start);
+        if (!node)
+            break;
+
+        if (node->entry) {
+            entry = node->entry;
+            *matched = i;
+        }
+    }
+
+    return entry;
+}
+
+/*
+ * Insert the nodes of a mount path, each node stores its component right
+ * after it. Return NULL when out of memory
+ */
+static struct mount_node *mount_trie_insert(const char *path)
+{
+    struct mount_node *node = &mount_root;
+    struct mount_node *child;
+    size_t i = 0;
+
+    for (;;) {
+        size_t start;
+
+        while (path[i] == '/')
+            ++i;
+
+        if (!path[i])
+            return node;
+
+        start = i;
+        while (path[i] && path[i] != '/')
+            ++i;
+
+        child = mount_node_child(node, path + start, i - start);
+        if (!child) {
+            child = kmalloc(sizeof (struct mount_node) + i - start);
+            if (!child)
+                return NULL;
+
+            memcpy(child + 1, path + start, i - start);
+
+            child->name = (const char *)(child + 1);
+            child->len = i - start;
+            child->entry = NULL;
+            klist_head_init(&child->children);
+            klist_add(&node->children, &child->list);
+        }
+
+        node = child;
+    }
+}
+
+/*
+ * The exact mount point of the first len characters of path, trailing
+ * slashes are ignored
+ */
+static struct mount_entry *mount_trie_get(const char *path, size_t len)
+{
+    size_t matched;
+    struct mount_entry *entry = mount_trie_match(path, len, &matched);
+
+    while (matched < len && path[matched] == '/')
+        ++matched;
+
+    if (matched != len)
+        return NULL;
+
+    return entry;
+}
 
 static int vfs_check_mounts(const char *mount_path)
 {
     int mount_nb = -1;
 
-    spinlock_lock(&mount_lock);
+    rwlock_write_lock(&mount_lock);
+
+    if (mount_trie_get(mount_path, strlen(mount_path))) {
+        rwlock_write_unlock(&mount_lock);
+        return -EBUSY;
+    }
 
     for (int i = 0; i < MAX_MOUNTED_PATH; ++i)
     {
         if (!mounts[i].used) {
-            if (mount_nb == -1)
-                mount_nb = i;
-            continue;
-        }
-
-        if (!strcmp(mounts[i].path, mount_path)) {
-            spinlock_unlock(&mount_lock);
-            return -EBUSY;
+            mount_nb = i;
+            break;
         }
     }
 
     if (mount_nb == -1) {
-        spinlock_unlock(&mount_lock);
+        rwlock_write_unlock(&mount_lock);
         return -ENOMEM;
     }
 
     mounts[mount_nb].used = 1;
+    mounts[mount_nb].path = NULL;
 
-    spinlock_unlock(&mount_lock);
+    rwlock_write_unlock(&mount_lock);
 
     return mount_nb;
 }
 
+static void vfs_release_mount(int mount_nb)
+{
+    rwlock_write_lock(&mount_lock);
+
+    mounts[mount_nb].used = 0;
+
+    rwlock_write_unlock(&mount_lock);
+}
+
 static int do_mount(struct thread *t, const char *mount_path, int mount_nb)
 {
     int ret;
@@ -82,8 +227,10 @@ int vfs_mount(struct thread *t, const char *fs_name, const char *device,
 {
     int ret;
     int mount_nb;
+    char *path;
     struct fs *fs;
     struct fs_instance *fi;
+    struct mount_node *node;
 
     fs = fs_from_name(fs_name);
     if (!fs)
@@ -95,7 +242,7 @@ int vfs_mount(struct thread *t, const char *fs_name, const char *device,
 
     ret = fs_new_instance(fs_name, device, mount_pt, &fi);
     if (ret < 0) {
-        mounts[mount_nb].used = 0;
+        vfs_release_mount(mount_nb);
         return ret;
     }
 
@@ -105,20 +252,35 @@ int vfs_mount(struct thread *t, const char *fs_name, const char *device,
     if (mount_nb != 0) {
         ret = do_mount(t, mount_pt, mount_nb);
         if (ret < 0) {
-            mounts[mount_nb].used = 0;
+            vfs_release_mount(mount_nb);
             return ret;
         }
     }
 
-    mounts[mount_nb].path = kmalloc(strlen(mount_pt) + 1);
-    if (!mounts[mount_nb].path) {
-        mounts[mount_nb].used = 0;
+    path = kmalloc(strlen(mount_pt) + 1);
+    if (!path) {
+        vfs_release_mount(mount_nb);
         return -ENOMEM;
     }
 
-    strcpy(mounts[mount_nb].path, mount_pt);
+    strcpy(path, mount_pt);
+
+    /* The entry becomes visible to lookups once it is in the trie */
+    rwlock_write_lock(&mount_lock);
+
+    node = mount_trie_insert(path);
+    if (!node || node->entry) {
+        rwlock_write_unlock(&mount_lock);
+        kfree(path);
+        vfs_release_mount(mount_nb);
+        return node ? -EBUSY : -ENOMEM;
+    }
 
     mounts[mount_nb].fi = fi;
+    mounts[mount_nb].path = path;
+    node->entry = &mounts[mount_nb];
+
+    rwlock_write_unlock(&mount_lock);
 
     return 0;
 }
@@ -130,11 +292,18 @@ struct mount_entry *vfs_root_get(void)
 
 struct mount_entry *vfs_mount_pt_get(const char *path)
 {
-    for (int i = 0; i < MAX_MOUNTED_PATH; ++i)
-    {
-        if (mounts[i].used && !strcmp(path, mounts[i].path))
-            return &mounts[i];
-    }
+    return vfs_mount_pt_get_n(path, strlen(path));
+}
 
-    return NULL;
+struct mount_entry *vfs_mount_pt_get_n(const char *path, size_t len)
+{
+    struct mount_entry *entry;
+
+    rwlock_read_lock(&mount_lock);
+
+    entry = mount_trie_get(path, len);
+
+    rwlock_read_unlock(&mount_lock);
+
+    return entry;
 }
@@ -0,0 +1,267 @@
+/*
+ * zOS
+ * Copyright (C) 2015 Baptiste Covolato
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zOS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file    kernel/core/fs/vfs/pcache.c
+ * \brief   Implementation of the page cache
+ *
+ * \author  Baptiste Covolato
+ */
+
+#include <kernel/mem/as.h>
+#include <kernel/mem/kmalloc.h>
+
+#include <kernel/fs/vfs/pcache.h>
+
+#include <arch/spinlock.h>
+
+static struct klist buckets[PCACHE_BUCKETS];
+
+/* Cached pages, the most recently used first */
+static struct klist lru;
+
+/* Number of pages allocated, cached or pinned out of the cache */
+static int count;
+
+static uint32_t generation;
+
+static spinlock_t pcache_lock;
+
+void pcache_initialize(void)
+{
+    for (int i = 0; i < PCACHE_BUCKETS; ++i)
+        klist_head_init(&buckets[i]);
+
+    klist_head_init(&lru);
+
+    count = 0;
+    generation = 0;
+
+    spinlock_init(&pcache_lock);
+}
+
+static inline struct klist *pcache_bucket(struct fs_instance *fi, ino_t inode,
+                                          uint32_t index)
+{
+    uint32_t hash = ((uintptr_t)fi >> 4) ^ (inode * 31) ^ (index * 17);
+
+    return &buckets[hash & (PCACHE_BUCKETS - 1)];
+}
+
+static struct pcache_page *pcache_find(struct fs_instance *fi, ino_t inode,
+                                       uint32_t index)
+{
+    struct pcache_page *page;
+
+    klist_for_each_elem(pcache_bucket(fi, inode, index), page, hash) {
+        if (page->fi == fi && page->inode == inode && page->index == index)
+            return page;
+    }
+
+    return NULL;
+}
+
+/*
+ * Release a page that is neither cached nor pinned, its count has already
+ * been given back
+ */
+static void pcache_free(struct pcache_page *page)
+{
+    as_unmap(&kernel_as, (vaddr_t)page->data, AS_UNMAP_RELEASE);
+
+    kfree(page);
+}
+
+/*
+ * Take a page out of the cache, called with the lock held. The page is
+ * added to \a freed if nobody uses it anymore
+ */
+static void pcache_remove(struct pcache_page *page, struct klist *freed)
+{
+    klist_del(&page->hash);
+    klist_del(&page->lru);
+
+    page->dead = 1;
+
+    if (!page->ref) {
+        --count;
+
+        klist_add(freed, &page->lru);
+    }
+}
+
+struct pcache_page *pcache_get(struct fs_instance *fi, ino_t inode,
+                               uint32_t index)
+{
+    struct pcache_page *page;
+
+    spinlock_lock(&pcache_lock);
+
+    page = pcache_find(fi, inode, index);
+    if (page) {
+        ++page->ref;
+
+        klist_del(&page->lru);
+        klist_add(&lru, &page->lru);
+    }
+
+    spinlock_unlock(&pcache_lock);
+
+    return page;
+}
+
+uint32_t pcache_generation(void)
+{
+    uint32_t ret;
+
+    spinlock_lock(&pcache_lock);
+
+    ret = generation;
+
+    spinlock_unlock(&pcache_lock);
+
+    return ret;
+}
+
+struct pcache_page *pcache_page_new(void)
+{
+    struct pcache_page *page;
+
+    spinlock_lock(&pcache_lock);
+
+    if (count < PCACHE_MAX_PAGES) {
+        ++count;
+
+        spinlock_unlock(&pcache_lock);
+
+        page = kmalloc(sizeof (struct pcache_page));
+        if (!page)
+            goto error;
+
+        page->data = (void *)as_map(&kernel_as, 0, 0, PAGE_SIZE,
+                                    AS_MAP_WRITE);
+        if (!page->data) {
+            kfree(page);
+            goto error;
+        }
+
+        page->ref = 1;
+        page->dead = 1;
+        page->readahead = 0;
+
+        return page;
+    }
+
+    /* Recycle the least recently used page that nobody is reading */
+    for (struct klist *l = lru.prev; l != &lru; l = l->prev) {
+        page = klist_elem(l, struct pcache_page, lru);
+
+        if (page->ref)
+            continue;
+
+        klist_del(&page->hash);
+        klist_del(&page->lru);
+
+        page->ref = 1;
+        page->dead = 1;
+        page->readahead = 0;
+
+        spinlock_unlock(&pcache_lock);
+
+        return page;
+    }
+
+    spinlock_unlock(&pcache_lock);
+
+    return NULL;
+
+error:
+    spinlock_lock(&pcache_lock);
+    --count;
+    spinlock_unlock(&pcache_lock);
+
+    return NULL;
+}
+
+void pcache_insert(struct pcache_page *page, uint32_t gen,
+                   struct fs_instance *fi, ino_t inode, uint32_t index,
+                   size_t size)
+{
+    page->fi = fi;
+    page->inode = inode;
+    page->index = index;
+    page->size = size;
+
+    spinlock_lock(&pcache_lock);
+
+    if (gen == generation && !pcache_find(fi, inode, index)) {
+        page->dead = 0;
+
+        klist_add(pcache_bucket(fi, inode, index), &page->hash);
+        klist_add(&lru, &page->lru);
+    }
+
+    spinlock_unlock(&pcache_lock);
+}
+
+void pcache_put(struct pcache_page *page)
+{
+    int last;
+
+    spinlock_lock(&pcache_lock);
+
+    last = !--page->ref && page->dead;
+    if (last)
+        --count;
+
+    spinlock_unlock(&pcache_lock);
+
+    if (last)
+        pcache_free(page);
+}
+
+void pcache_invalidate(struct fs_instance *fi, ino_t inode, uint32_t first,
+                       uint32_t last)
+{
+    struct pcache_page *page;
+    struct klist freed;
+
+    klist_head_init(&freed);
+
+    spinlock_lock(&pcache_lock);
+
+    ++generation;
+
+    klist_for_each(&lru, elem, lru) {
+        page = klist_elem(elem, struct pcache_page, lru);
+
+        if (page->fi != fi)
+            continue;
+
+        if (inode && (page->inode != inode || page->index < first ||
+                      page->index > last))
+            continue;
+
+        pcache_remove(page, &freed);
+    }
+
+    spinlock_unlock(&pcache_lock);
+
+    klist_for_each(&freed, elem, lru)
+        pcache_free(klist_elem(elem, struct pcache_page, lru));
+}
@@ -38,11 +38,17 @@
 
 #include <kernel/fs/vfs/vops.h>
 #include <kernel/fs/vfs/mount.h>
+#include <kernel/fs/vfs/device.h>
+#include <kernel/fs/vfs/pcache.h>
 
 #ifdef CONFIG_DEVFS
 # include <kernel/fs/devfs.h>
 #endif /* !CONFIG_DEVFS */
 
+#ifdef CONFIG_PROCFS
+# include <kernel/fs/procfs.h>
+#endif /* !CONFIG_PROCFS */
+
 int vfs_initialize(void)
 {
     int ret;
@@ -55,11 +61,23 @@ int vfs_initialize(void)
     if (ret < 0)
         return ret;
 
+    ret = device_initialize();
+    if (ret < 0)
+        return ret;
+
+    pcache_initialize();
+
 #ifdef CONFIG_DEVFS
     ret = devfs_initialize();
     if (ret < 0)
         return ret;
 #endif /* !CONFIG_DEVFS */
 
+#ifdef CONFIG_PROCFS
+    ret = procfs_initialize();
+    if (ret < 0)
+        return ret;
+#endif /* !CONFIG_PROCFS */
+
     return 0;
 }
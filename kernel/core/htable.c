@@ -0,0 +1,82 @@
+/*
+ * zOS
+ * Copyright (C) 2015 Baptiste Covolato
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zOS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file    kernel/core/htable.c
+ * \brief   Implementation of the name indexed hash table
+ *
+ * \author  Baptiste Covolato
+ */
+
+#include <string.h>
+
+#include <kernel/htable.h>
+
+void htable_initialize(struct htable *table, struct klist *buckets, int size,
+                       size_t key_max)
+{
+    for (int i = 0; i < size; ++i)
+        klist_head_init(&buckets[i]);
+
+    table->buckets = buckets;
+    table->size = size;
+    table->key_max = key_max;
+}
+
+/**
+ *  \brief  FNV-1a hash of the first key_max characters of a key
+ */
+static uint32_t htable_hash(const char *key, size_t key_max)
+{
+    uint32_t hash = 2166136261u;
+
+    for (size_t i = 0; i < key_max && key[i]; ++i) {
+        hash ^= (unsigned char)key[i];
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+void htable_add(struct htable *table, struct htable_node *node,
+                const char *key)
+{
+    node->key = key;
+    node->hash = htable_hash(key, table->key_max);
+
+    klist_add(&table->buckets[node->hash & (table->size - 1)], &node->list);
+}
+
+void htable_del(struct htable_node *node)
+{
+    klist_del(&node->list);
+}
+
+struct htable_node *htable_get(struct htable *table, const char *key)
+{
+    struct htable_node *node;
+    uint32_t hash = htable_hash(key, table->key_max);
+
+    klist_for_each_elem(&table->buckets[hash & (table->size - 1)], node,
+                        list) {
+        if (node->hash == hash && !strncmp(node->key, key, table->key_max))
+            return node;
+    }
+
+    return NULL;
+}
@@ -0,0 +1,121 @@
+/*
+ * zOS
+ * Copyright (C) 2015 Baptiste Covolato
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zOS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file    kernel/core/idmap.c
+ * \brief   Implementation of the bitmap based id allocator
+ *
+ * \author  Baptiste Covolato
+ */
+
+#include <string.h>
+
+#include <kernel/idmap.h>
+
+void idmap_initialize(struct idmap *map, uint32_t *bitmap, int size,
+                      int policy)
+{
+    spinlock_init(&map->lock);
+
+    memset(bitmap, 0, IDMAP_WORDS(size) * sizeof (uint32_t));
+
+    map->bitmap = bitmap;
+    map->size = size;
+    map->policy = policy;
+    map->next = 0;
+}
+
+/**
+ *  \brief  Find and set the first clear bit in [start, end[, a whole word is
+ *          skipped at once when it is full
+ */
+static int idmap_search(struct idmap *map, int start, int end)
+{
+    int id = start;
+
+    while (id < end) {
+        uint32_t word = map->bitmap[id / 32] | ((1u << (id % 32)) - 1);
+
+        if (word == 0xFFFFFFFF) {
+            id = (id & ~31) + 32;
+            continue;
+        }
+
+        id = (id & ~31) + __builtin_ctz(~word);
+        if (id >= end)
+            break;
+
+        map->bitmap[id / 32] |= 1u << (id % 32);
+
+        return id;
+    }
+
+    return -1;
+}
+
+int idmap_alloc(struct idmap *map)
+{
+    int id;
+
+    spinlock_lock(&map->lock);
+
+    if (map->policy == IDMAP_CYCLIC) {
+        id = idmap_search(map, map->next, map->size);
+        if (id < 0)
+            id = idmap_search(map, 0, map->next);
+
+        if (id >= 0)
+            map->next = (id + 1) % map->size;
+    } else
+        id = idmap_search(map, 0, map->size);
+
+    spinlock_unlock(&map->lock);
+
+    return id;
+}
+
+int idmap_reserve(struct idmap *map, int id)
+{
+    int ret = -1;
+
+    if (id < 0 || id >= map->size)
+        return -1;
+
+    spinlock_lock(&map->lock);
+
+    if (!(map->bitmap[id / 32] & (1u << (id % 32)))) {
+        map->bitmap[id / 32] |= 1u << (id % 32);
+        ret = 0;
+    }
+
+    spinlock_unlock(&map->lock);
+
+    return ret;
+}
+
+void idmap_free(struct idmap *map, int id)
+{
+    if (id < 0 || id >= map->size)
+        return;
+
+    spinlock_lock(&map->lock);
+
+    map->bitmap[id / 32] &= ~(1u << (id % 32));
+
+    spinlock_unlock(&map->lock);
+}
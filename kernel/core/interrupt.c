@@ -4,6 +4,9 @@
 #include <kernel/interrupt.h>
 #include <kernel/console.h>
 #include <kernel/panic.h>
+#include <kernel/cpu.h>
+
+#include <kernel/scheduler/trace.h>
 
 #include <glue/interrupt.h>
 
@@ -23,6 +26,8 @@ void interrupt_dispatch(struct irq_regs *regs)
      * FIXME: we use reg->irq_num and reg->irq_data that must be here
      * for every architecture ....
      */
+    sched_trace(SCHED_TRACE_IRQ_ENTRY, thread_current(), regs->irq_num, 0);
+
     interrupt_acnowledge(regs->irq_num);
 
     if (regs->irq_num >= MAX_IRQ_NUMBER)
@@ -34,6 +39,10 @@ void interrupt_dispatch(struct irq_regs *regs)
         console_message(T_INF, "Unhandled IRQ %i fired with data = 0x%x",
                         regs->irq_num, regs->irq_data);
 
+    sched_trace(SCHED_TRACE_IRQ_EXIT, thread_current(), regs->irq_num, 0);
+
+    /* The interrupt may have woken a thread that must run right now */
+    scheduler_preempt(regs);
 }
 
 void interrupt_acnowledge(int irq)
@@ -33,7 +33,7 @@ int as_initialize(struct as* as)
         return 0;
 
     spinlock_init(&as->region_lock);
-    spinlock_init(&as->map_lock);
+    rwlock_init(&as->map_lock);
 
     region_initialize(as);
 
@@ -62,7 +62,7 @@ struct as_mapping *as_mapping_locate(struct as *as, vaddr_t vaddr)
     struct as_mapping *mapping;
     struct as_mapping *ret = NULL;
 
-    spinlock_lock(&as->map_lock);
+    rwlock_read_lock(&as->map_lock);
 
     klist_for_each_elem(&as->mapping, mapping, list)
     {
@@ -74,7 +74,7 @@ struct as_mapping *as_mapping_locate(struct as *as, vaddr_t vaddr)
         }
     }
 
-    spinlock_unlock(&as->map_lock);
+    rwlock_read_unlock(&as->map_lock);
 
     return ret;
 }
@@ -122,12 +122,12 @@ static struct as_mapping *setup_mapping(struct as *as, vaddr_t vaddr,
          */
         else
         {
-            spinlock_lock(&as->map_lock);
+            rwlock_write_lock(&as->map_lock);
 
             /* We remove this mapping from mapping list */
             klist_del(&map->list);
 
-            spinlock_unlock(&as->map_lock);
+            rwlock_write_unlock(&as->map_lock);
 
             if (map->size > size)
                 kernel_panic("as: need mapping split");
@@ -204,18 +204,35 @@ vaddr_t as_map(struct as *as, vaddr_t vaddr, paddr_t paddr, size_t size,
 
     map->flags = flags;
 
-    spinlock_lock(&as->map_lock);
+    rwlock_write_lock(&as->map_lock);
     klist_add(&as->mapping, &map->list);
-    spinlock_unlock(&as->map_lock);
+    rwlock_write_unlock(&as->map_lock);
 
     return map->virt;
 }
 
+vaddr_t as_map_kernel(struct as *as, vaddr_t vaddr, const void *kaddr,
+                      size_t size, int flags)
+{
+    struct as_mapping *kmap;
+
+    if (!(kmap = as_mapping_locate(&kernel_as, (vaddr_t)kaddr)))
+        return 0;
+
+    if (!(vaddr = as_map(as, vaddr, kmap->phy->base, size, flags)))
+        return 0;
+
+    /* as_map() does not take a reference on a given physical address */
+    ++kmap->phy->ref_count;
+
+    return vaddr;
+}
+
 void as_unmap(struct as *as, vaddr_t vaddr, int flags)
 {
     struct as_mapping *map;
 
-    spinlock_lock(&as->map_lock);
+    rwlock_write_lock(&as->map_lock);
 
     klist_for_each_elem(&as->mapping, map, list)
     {
@@ -232,13 +249,13 @@ void as_unmap(struct as *as, vaddr_t vaddr, int flags)
 
             kfree(map);
 
-            spinlock_unlock(&as->map_lock);
+            rwlock_write_unlock(&as->map_lock);
 
             return;
         }
     }
 
-    spinlock_unlock(&as->map_lock);
+    rwlock_write_unlock(&as->map_lock);
 }
 
 struct as *as_duplicate(struct as *as)
@@ -251,7 +268,7 @@ struct as *as_duplicate(struct as *as)
     /* Duplicate every mapping */
     struct as_mapping *mapping;
 
-    spinlock_lock(&as->map_lock);
+    rwlock_write_lock(&as->map_lock);
 
     klist_for_each_elem(&as->mapping, mapping, list)
     {
@@ -287,7 +304,7 @@ struct as *as_duplicate(struct as *as)
         }
     }
 
-    spinlock_unlock(&as->map_lock);
+    rwlock_write_unlock(&as->map_lock);
 
     if (!glue_call(as, duplicate, as, new_as))
         goto cleanup;
@@ -296,7 +313,7 @@ struct as *as_duplicate(struct as *as)
 
 cleanup:
     as_destroy(new_as);
-    spinlock_unlock(&as->map_lock);
+    rwlock_write_unlock(&as->map_lock);
 
     return NULL;
 }
@@ -305,7 +322,7 @@ int as_is_mapped(struct as *as, vaddr_t ptr, size_t size)
 {
     struct as_mapping *mapping;
 
-    spinlock_lock(&as->map_lock);
+    rwlock_read_lock(&as->map_lock);
 
     klist_for_each_elem(&as->mapping, mapping, list)
     {
@@ -313,18 +330,18 @@ int as_is_mapped(struct as *as, vaddr_t ptr, size_t size)
         {
             if (ptr - mapping->virt + size > mapping->size)
             {
-                spinlock_unlock(&as->map_lock);
+                rwlock_read_unlock(&as->map_lock);
                 return 0;
             }
             else
             {
-                spinlock_unlock(&as->map_lock);
+                rwlock_read_unlock(&as->map_lock);
                 return 1;
             }
         }
     }
 
-    spinlock_unlock(&as->map_lock);
+    rwlock_read_unlock(&as->map_lock);
 
     return 0;
 }
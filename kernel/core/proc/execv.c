@@ -5,6 +5,8 @@
 #include <kernel/scheduler.h>
 
 #include <kernel/fs/vfs/vops.h>
+#include <kernel/fs/aio.h>
+#include <kernel/fs/channel.h>
 
 #include <kernel/mem/kmalloc.h>
 
@@ -132,16 +134,36 @@ int process_execv(struct thread *thread, const char *filename,
         return -ELIBBAD;
     }
 
+    /* filename may live in the address space that is about to be cleaned */
+    process_set_name(thread->parent, filename);
+
     klist_for_each(&thread->parent->threads, tlist, list)
     {
         struct thread *t = klist_elem(tlist, struct thread, list);
 
         if (t != thread)
-            thread_exit(thread);
+            thread_exit(t);
     }
 
+    /* The rings are not inherited by the new program */
+    aio_exit(thread->parent);
+
+    /* The rings of its channels are unmapped with the address space */
+    channel_process_exit(thread->parent);
+
     as_clean(thread->parent->as);
 
+    /* The information page is unmapped with the rest of the address space */
+    if (process_info_map(thread->parent) < 0)
+    {
+        kfree(binary);
+        kfree(new_argv);
+
+        process_exit(thread->parent, 0);
+
+        scheduler_update(NULL, 1);
+    }
+
     entry = process_load_elf(thread->parent, (uintptr_t)binary);
 
     kfree(binary);
@@ -157,6 +179,8 @@ int process_execv(struct thread *thread, const char *filename,
 
     thread_update_exec(thread, entry, new_argv);
 
+    process_info_update(thread);
+
     kfree(new_argv);
 
     scheduler_update(NULL, 1);
@@ -0,0 +1,237 @@
+/*
+ * zOS
+ * Copyright (C) 2015 Baptiste Covolato
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zOS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file    kernel/core/proc/futex.c
+ * \brief   Implementation of futexes (fast userland mutexes)
+ *
+ * \author  Baptiste Covolato
+ */
+
+#include <kernel/errno.h>
+#include <kernel/cpu.h>
+#include <kernel/timer.h>
+#include <kernel/scheduler.h>
+
+#include <kernel/mem/as.h>
+
+#include <kernel/proc/thread.h>
+#include <kernel/proc/futex.h>
+
+#include <arch/mmu.h>
+
+static struct futex_bucket futex_table[FUTEX_HASH_SIZE];
+
+void futex_initialize(void)
+{
+    for (int i = 0; i < FUTEX_HASH_SIZE; ++i) {
+        spinlock_init(&futex_table[i].lock);
+        klist_head_init(&futex_table[i].waiters);
+    }
+}
+
+static struct futex_bucket *futex_bucket_get(paddr_t key)
+{
+    return &futex_table[((key >> 2) ^ (key >> 12)) & (FUTEX_HASH_SIZE - 1)];
+}
+
+/**
+ *  \brief  Compute the key of a futex word. Keying on the physical address
+ *          lets processes sharing memory synchronize on the same futex
+ */
+static int futex_key(struct thread *thread, uint32_t *uaddr, paddr_t *key)
+{
+    paddr_t page;
+
+    if ((vaddr_t)uaddr & (sizeof (uint32_t) - 1))
+        return -EFAULT;
+
+    if (!as_is_mapped(thread->parent->as, (vaddr_t)uaddr, sizeof (uint32_t)))
+        return -EFAULT;
+
+    page = as_virt_to_phy((vaddr_t)uaddr);
+    if (!page)
+        return -EFAULT;
+
+    *key = page | ((vaddr_t)uaddr & (PAGE_SIZE - 1));
+
+    return 0;
+}
+
+/**
+ *  \brief  Remove a waiter from its bucket and give its thread back to the
+ *          scheduler. The bucket lock must be held
+ */
+static void futex_dequeue(struct futex_waiter *waiter, int state)
+{
+    struct thread *thread = waiter->thread;
+
+    klist_del(&waiter->list);
+
+    waiter->state = state;
+    thread->futex = NULL;
+
+    /* An exiting thread stays a zombie so that the scheduler reaps it */
+    if (state != FUTEX_STATE_CANCELED)
+        thread->state = THREAD_STATE_RUNNING;
+
+    cpu_add_thread(thread);
+}
+
+static void futex_timeout(int data)
+{
+    struct futex_waiter *waiter = (void *)data;
+    struct futex_bucket *bucket = futex_bucket_get(waiter->key);
+
+    spinlock_lock(&bucket->lock);
+
+    if (waiter->state == FUTEX_STATE_WAITING)
+        futex_dequeue(waiter, FUTEX_STATE_TIMEDOUT);
+
+    spinlock_unlock(&bucket->lock);
+}
+
+int futex_wait(struct thread *thread, uint32_t *uaddr, uint32_t val,
+               size_t timeout)
+{
+    int ret;
+    int state;
+    struct cpu *cpu;
+    struct futex_bucket *bucket;
+    struct futex_waiter waiter;
+
+    ret = futex_key(thread, uaddr, &waiter.key);
+    if (ret < 0)
+        return ret;
+
+    bucket = futex_bucket_get(waiter.key);
+
+    spinlock_lock(&bucket->lock);
+
+    /*
+     * The value is checked with the bucket locked, so a futex_wake() issued
+     * after userland modified the word cannot be missed
+     */
+    if (*uaddr != val) {
+        spinlock_unlock(&bucket->lock);
+        return -EAGAIN;
+    }
+
+    waiter.thread = thread;
+    waiter.state = FUTEX_STATE_WAITING;
+    waiter.timer = -1;
+
+    if (timeout) {
+        waiter.timer = timer_register(TIMER_ONESHOT, timeout, futex_timeout,
+                                      (long)&waiter);
+        if (waiter.timer < 0) {
+            spinlock_unlock(&bucket->lock);
+            return waiter.timer;
+        }
+    }
+
+    klist_add_back(&bucket->waiters, &waiter.list);
+    thread->futex = &waiter;
+
+    cpu = cpu_get(thread->cpu);
+
+    while (waiter.state == FUTEX_STATE_WAITING) {
+        thread->state = THREAD_STATE_BLOCKED;
+
+        /*
+         * Interrupts stay disabled until the thread is removed from the
+         * scheduler, otherwise the timeout could wake it up in between and
+         * add it twice to the scheduler
+         */
+        spinlock_unlock_no_restore(&bucket->lock);
+
+        spinlock_lock(&cpu->scheduler.sched_lock);
+        scheduler_remove_thread(thread, &cpu->scheduler);
+
+        spinlock_lock(&bucket->lock);
+    }
+
+    state = waiter.state;
+
+    spinlock_unlock(&bucket->lock);
+
+    if (state == FUTEX_STATE_TIMEDOUT)
+        return -ETIMEDOUT;
+
+    if (waiter.timer >= 0)
+        timer_unregister(waiter.timer, futex_timeout, (long)&waiter);
+
+    return 0;
+}
+
+int futex_wake(struct thread *thread, uint32_t *uaddr, int count)
+{
+    int ret;
+    int woken = 0;
+    paddr_t key;
+    struct futex_waiter *waiter;
+    struct futex_bucket *bucket;
+
+    ret = futex_key(thread, uaddr, &key);
+    if (ret < 0)
+        return ret;
+
+    bucket = futex_bucket_get(key);
+
+    spinlock_lock(&bucket->lock);
+
+    klist_for_each(&bucket->waiters, wlist, list) {
+        if (woken >= count)
+            break;
+
+        waiter = klist_elem(wlist, struct futex_waiter, list);
+
+        if (waiter->key != key)
+            continue;
+
+        futex_dequeue(waiter, FUTEX_STATE_WOKEN);
+
+        ++woken;
+    }
+
+    spinlock_unlock(&bucket->lock);
+
+    return woken;
+}
+
+void futex_cancel(struct thread *thread)
+{
+    struct futex_waiter *waiter = thread->futex;
+    struct futex_bucket *bucket;
+
+    if (!waiter)
+        return;
+
+    bucket = futex_bucket_get(waiter->key);
+
+    spinlock_lock(&bucket->lock);
+
+    if (thread->futex == waiter && waiter->state == FUTEX_STATE_WAITING) {
+        if (waiter->timer >= 0)
+            timer_unregister(waiter->timer, futex_timeout, (long)waiter);
+
+        futex_dequeue(waiter, FUTEX_STATE_CANCELED);
+    }
+
+    spinlock_unlock(&bucket->lock);
+}
@@ -0,0 +1,117 @@
+/*
+ * zOS
+ * Copyright (C) 2015 Baptiste Covolato
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zOS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file    kernel/core/proc/info.c
+ * \brief   Implementation of the read-only information page of processes
+ *
+ * \author  Baptiste Covolato
+ */
+
+#include <string.h>
+
+#include <kernel/errno.h>
+#include <kernel/time.h>
+
+#include <kernel/mem/segment.h>
+#include <kernel/mem/region.h>
+#include <kernel/mem/as.h>
+
+#include <kernel/proc/process.h>
+#include <kernel/proc/thread.h>
+#include <kernel/proc/info.h>
+
+#include <arch/mmu.h>
+
+static struct {
+    uint32_t khz;
+    uint32_t mult;
+    uint64_t base;
+} info_clock;
+
+void process_info_clock_set(uint32_t khz, uint32_t mult, uint64_t base)
+{
+    info_clock.khz = khz;
+    info_clock.mult = mult;
+    info_clock.base = base;
+}
+
+int process_info_create(struct process *process)
+{
+    struct process_info *info;
+    int ret;
+
+    info = (void *)as_map(&kernel_as, 0, 0, PAGE_SIZE, AS_MAP_WRITE);
+    if (!info)
+        return -ENOMEM;
+
+    memset(info, 0, PAGE_SIZE);
+
+    info->pid = process->pid;
+    info->tid = 0;
+    info->ticks = timer_ticks_get();
+    info->tick_per_sec = TICK_PER_SEC;
+
+    info->clock_khz = info_clock.khz;
+    info->clock_mult = info_clock.mult;
+    info->clock_shift = PROCESS_INFO_CLOCK_SHIFT;
+    info->clock_base = info_clock.base;
+
+    process->info = info;
+
+    ret = process_info_map(process);
+    if (ret < 0)
+        process_info_destroy(process);
+
+    return ret;
+}
+
+int process_info_map(struct process *process)
+{
+    if (region_reserve(process->as, PROCESS_INFO_ADDR, 1) != PROCESS_INFO_ADDR)
+        return -ENOMEM;
+
+    if (!as_map_kernel(process->as, PROCESS_INFO_ADDR, process->info,
+                       PAGE_SIZE, AS_MAP_USER)) {
+        region_release(process->as, PROCESS_INFO_ADDR);
+        return -ENOMEM;
+    }
+
+    return 0;
+}
+
+void process_info_destroy(struct process *process)
+{
+    if (!process->info)
+        return;
+
+    as_unmap(&kernel_as, (vaddr_t)process->info, AS_UNMAP_RELEASE);
+
+    process->info = NULL;
+}
+
+void process_info_update(struct thread *thread)
+{
+    struct process_info *info = thread->parent->info;
+
+    if (!info)
+        return;
+
+    info->tid = thread->tid;
+    info->ticks = timer_ticks_get();
+}
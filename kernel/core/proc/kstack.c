@@ -0,0 +1,109 @@
+/*
+ * zOS
+ * Copyright (C) 2015 Baptiste Covolato
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zOS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file    kernel/core/proc/kstack.c
+ * \brief   Allocation of kernel stacks with guard pages and per cpu caching
+ *
+ * \author  Baptiste Covolato
+ */
+
+#include <kernel/cpu.h>
+
+#include <kernel/mem/region.h>
+#include <kernel/mem/as.h>
+
+#include <kernel/proc/kstack.h>
+
+#include <arch/mmu.h>
+
+/*
+ * The caches are not part of struct cpu because the first threads are
+ * created before the cpus are initialized
+ */
+static struct kstack_cache caches[CPU_COUNT];
+
+void kstack_initialize(void)
+{
+    for (int i = 0; i < CPU_COUNT; ++i) {
+        spinlock_init(&caches[i].lock);
+        caches[i].count = 0;
+    }
+}
+
+static vaddr_t kstack_map(void)
+{
+    vaddr_t base;
+    vaddr_t stack;
+
+    base = region_reserve(&kernel_as, 0, KSTACK_GUARD_PAGES + 1);
+    if (!base)
+        return 0;
+
+    /* Only the stack page is backed, the guard pages stay unmapped */
+    stack = base + KSTACK_GUARD_PAGES * PAGE_SIZE;
+
+    if (!as_map(&kernel_as, stack, 0, PAGE_SIZE, AS_MAP_WRITE)) {
+        region_release(&kernel_as, base);
+        return 0;
+    }
+
+    return stack;
+}
+
+static void kstack_unmap(vaddr_t stack)
+{
+    as_unmap(&kernel_as, stack, AS_UNMAP_RELEASE);
+
+    region_release(&kernel_as, stack - KSTACK_GUARD_PAGES * PAGE_SIZE);
+}
+
+vaddr_t kstack_alloc(void)
+{
+    struct kstack_cache *cache = &caches[cpu_id_get()];
+    vaddr_t stack = 0;
+
+    spinlock_lock(&cache->lock);
+
+    if (cache->count)
+        stack = cache->stacks[--cache->count];
+
+    spinlock_unlock(&cache->lock);
+
+    if (!stack)
+        stack = kstack_map();
+
+    return stack;
+}
+
+void kstack_free(vaddr_t stack)
+{
+    struct kstack_cache *cache = &caches[cpu_id_get()];
+
+    spinlock_lock(&cache->lock);
+
+    if (cache->count < KSTACK_CACHE_SIZE) {
+        cache->stacks[cache->count++] = stack;
+        stack = 0;
+    }
+
+    spinlock_unlock(&cache->lock);
+
+    if (stack)
+        kstack_unmap(stack);
+}
@@ -37,13 +37,33 @@
 
 #include <kernel/proc/process.h>
 #include <kernel/proc/thread.h>
+#include <kernel/proc/futex.h>
 #include <kernel/proc/elf.h>
 
+#include <kernel/fs/aio.h>
+#include <kernel/fs/channel.h>
+
 static struct klist processes;
+static struct klist process_hash[PROCESS_HASH_SIZE];
+static rwlock_t process_lock;
+
+static struct idmap pids;
+static uint32_t pid_bitmap[IDMAP_WORDS(PROCESS_MAX_PID)];
 
 void process_initialize(void)
 {
     klist_head_init(&processes);
+
+    for (int i = 0; i < PROCESS_HASH_SIZE; ++i)
+        klist_head_init(&process_hash[i]);
+
+    rwlock_init(&process_lock);
+
+    idmap_initialize(&pids, pid_bitmap, PROCESS_MAX_PID, IDMAP_CYCLIC);
+
+    thread_initialize();
+
+    futex_initialize();
 }
 
 static void init_process(struct process *p, pid_t pid, int type,
@@ -53,41 +73,65 @@ static void init_process(struct process *p, pid_t pid, int type,
     p->thread_count = 0;
     p->type = type;
     p->pid = pid;
+    p->info = NULL;
+    p->aio = NULL;
 
     p->parent = parent;
 
+    process_set_name(p, parent ? parent->name : "kernel");
+
     spinlock_init(&p->plock);
     spinlock_init(&p->files_lock);
 
     /* Init thread list */
     klist_head_init(&p->threads);
     klist_head_init(&p->children);
+
+    idmap_initialize(&p->tids, p->tid_bitmap, THREAD_MAX_PER_PROCESS,
+                     IDMAP_FIRST_FIT);
 }
 
 static pid_t process_new_pid(void)
 {
-    struct process *process;
-    int used;
-    pid_t pid = 0;
+    return idmap_alloc(&pids);
+}
 
-    for (; pid < PROCESS_MAX_PID; ++pid)
-    {
-        used = 0;
+/**
+ *  \brief  Make \a p visible to process_get() and to the process list
+ */
+static void process_register(struct process *p)
+{
+    rwlock_write_lock(&process_lock);
 
-        klist_for_each_elem(&processes, process, list)
-        {
-            if (process->pid == pid)
-            {
-                used = 1;
-                break;
-            }
-        }
+    klist_add(&processes, &p->list);
+    klist_add(&process_hash[p->pid & (PROCESS_HASH_SIZE - 1)], &p->hash);
+
+    rwlock_write_unlock(&process_lock);
+}
+
+void process_release(struct process *p)
+{
+    rwlock_write_lock(&process_lock);
+
+    klist_del(&p->list);
+    klist_del(&p->hash);
+
+    rwlock_write_unlock(&process_lock);
+
+    idmap_free(&pids, p->pid);
+}
+
+void process_set_name(struct process *process, const char *path)
+{
+    const char *name = path;
 
-        if (!used)
-            return pid;
+    for (; *path; ++path) {
+        if (*path == '/' && path[1])
+            name = path + 1;
     }
 
-    return -1;
+    strncpy(process->name, name, PROCESS_NAME_MAX - 1);
+    process->name[PROCESS_NAME_MAX - 1] = '\0';
 }
 
 struct process *process_create(int type, uintptr_t code, int flags,
@@ -103,7 +147,13 @@ struct process *process_create(int type, uintptr_t code, int flags,
     process = kmalloc(sizeof (struct process));
 
     if (!process)
+    {
+        idmap_free(&pids, pid);
+
         return NULL;
+    }
+
+    process->info = NULL;
 
     if (type & PROCESS_TYPE_USER)
     {
@@ -121,6 +171,12 @@ struct process *process_create(int type, uintptr_t code, int flags,
      */
     init_process(process, pid, type, process_get(1));
 
+    if (argv && argv[0])
+        process_set_name(process, argv[0]);
+
+    if (type & PROCESS_TYPE_USER && process_info_create(process) < 0)
+        goto error;
+
     /* Mark all file slots has unused */
     memset(process->files, 0, sizeof (process->files));
 
@@ -146,7 +202,7 @@ struct process *process_create(int type, uintptr_t code, int flags,
                               THREAD_CREATEF_DEEP_ARGV_COPY) < 0)
         goto error;
 
-    klist_add(&processes, &process->list);
+    process_register(process);
 
     return process;
 
@@ -154,22 +210,84 @@ error:
     if (process->as != &kernel_as)
         as_destroy(process->as);
 
+    process_info_destroy(process);
+
     kfree(process);
 
+    idmap_free(&pids, pid);
+
     return NULL;
 }
 
 struct process *process_get(pid_t pid)
 {
     struct process *process;
+    struct process *ret = NULL;
 
-    klist_for_each_elem(&processes, process, list)
+    if (pid < 0)
+        return NULL;
+
+    rwlock_read_lock(&process_lock);
+
+    klist_for_each_elem(&process_hash[pid & (PROCESS_HASH_SIZE - 1)],
+                        process, hash)
     {
         if (process->pid == pid)
-            return process;
+        {
+            ret = process;
+            break;
+        }
     }
 
-    return NULL;
+    rwlock_read_unlock(&process_lock);
+
+    return ret;
+}
+
+int process_call(pid_t pid, int (*cb)(struct process *, void *), void *data)
+{
+    struct process *process;
+    int ret = -ESRCH;
+
+    if (pid < 0)
+        return -ESRCH;
+
+    rwlock_read_lock(&process_lock);
+
+    klist_for_each_elem(&process_hash[pid & (PROCESS_HASH_SIZE - 1)],
+                        process, hash)
+    {
+        if (process->pid == pid)
+        {
+            ret = cb(process, data);
+            break;
+        }
+    }
+
+    rwlock_read_unlock(&process_lock);
+
+    return ret;
+}
+
+pid_t process_pid_at(int index)
+{
+    struct process *process;
+    pid_t pid = -1;
+
+    rwlock_read_lock(&process_lock);
+
+    klist_for_each_elem(&processes, process, list)
+    {
+        if (!index--)
+        {
+            pid = process->pid;
+            break;
+        }
+    }
+
+    rwlock_read_unlock(&process_lock);
+
+    return pid;
 }
 
 int process_fork(struct process *process, struct irq_regs *regs)
@@ -177,21 +295,44 @@ int process_fork(struct process *process, struct irq_regs *regs)
     pid_t pid;
     struct process *child;
 
-    if (!(pid = process_new_pid()))
+    if ((pid = process_new_pid()) < 0)
         return -EAGAIN;
 
     if (!(child = kmalloc(sizeof (struct process))))
+    {
+        idmap_free(&pids, pid);
+
         return -ENOMEM;
+    }
 
     if (!(child->as = as_duplicate(process->as)))
     {
         kfree(child);
 
+        idmap_free(&pids, pid);
+
         return -EAGAIN;
     }
 
     init_process(child, pid, process->type, process);
 
+    /*
+     * The child must not share the information page of its parent, drop the
+     * copy made with the rest of the address space
+     */
+    as_unmap(child->as, PROCESS_INFO_ADDR, AS_UNMAP_RELEASE);
+
+    if (process_info_create(child) < 0)
+    {
+        as_destroy(child->as);
+
+        kfree(child);
+
+        idmap_free(&pids, pid);
+
+        return -ENOMEM;
+    }
+
     /*
      * Duplicate thread, the child's thread will automatically be added to the
      * scheduler and return in the userland code and return 0 to the syscall
@@ -201,8 +342,12 @@ int process_fork(struct process *process, struct irq_regs *regs)
     {
         as_destroy(child->as);
 
+        process_info_destroy(child);
+
         kfree(child);
 
+        idmap_free(&pids, pid);
+
         return -ENOMEM;
     }
 
@@ -214,7 +359,7 @@ int process_fork(struct process *process, struct irq_regs *regs)
     klist_add(&process->children, &child->brothers);
 
     /* Add the process to the process' list */
-    klist_add(&processes, &child->list);
+    process_register(child);
 
     /* Only the father returns here, the child return in thread_duplicate */
     return pid;
@@ -228,7 +373,10 @@ int process_new_fd(struct process *process)
     {
         if (!process->files[i].used)
         {
+            /* procfs skips the slot until the file is set up */
             process->files[i].used = 1;
+            process->files[i].f_ops = NULL;
+            process->files[i].private = NULL;
 
             spinlock_unlock(&process->files_lock);
 
@@ -341,6 +489,12 @@ void process_exit(struct process *p, int code)
         thread_exit(thread);
     }
 
+    /* The workers of the rings are zombies now */
+    aio_exit(p);
+
+    /* The rings of its channels are released with the address space */
+    channel_process_exit(p);
+
     cpu->scheduler.time = 1;
 
     scheduler_update(NULL, 1);
@@ -357,6 +511,8 @@ void process_destroy(struct process *p)
 
     kfree(p->as);
 
+    process_info_destroy(p);
+
     spinlock_lock(&p->plock);
 
     /* Notify process waiting for this process to exit, if there is any */
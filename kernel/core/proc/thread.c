@@ -33,32 +33,52 @@
 #include <kernel/mem/kmalloc.h>
 
 #include <kernel/proc/thread.h>
+#include <kernel/proc/kstack.h>
+
+#include <kernel/fs/aio.h>
 
 #include <arch/mmu.h>
 
-static int thread_new_tid(struct process *p)
+static struct klist thread_hash[THREAD_HASH_SIZE];
+static rwlock_t thread_lock;
+
+void thread_initialize(void)
 {
-    struct thread *thread;
-    int used;
+    kstack_initialize();
 
-    for (int tid = 0; tid < THREAD_MAX_PER_PROCESS; ++tid)
-    {
-        used = 0;
+    for (int i = 0; i < THREAD_HASH_SIZE; ++i)
+        klist_head_init(&thread_hash[i]);
 
-        klist_for_each_elem(&p->threads, thread, list)
-        {
-            if (thread->tid == tid)
-            {
-                used = 1;
-                break;
-            }
-        }
+    rwlock_init(&thread_lock);
+}
 
-        if (!used)
-            return tid;
-    }
+static inline struct klist *thread_bucket(pid_t pid, int tid)
+{
+    return &thread_hash[(pid * THREAD_MAX_PER_PROCESS + tid) &
+                        (THREAD_HASH_SIZE - 1)];
+}
+
+static void thread_hash_add(struct thread *thread)
+{
+    rwlock_write_lock(&thread_lock);
+
+    klist_add(thread_bucket(thread->parent->pid, thread->tid), &thread->hash);
 
-    return -1;
+    rwlock_write_unlock(&thread_lock);
+}
+
+static void thread_hash_del(struct thread *thread)
+{
+    rwlock_write_lock(&thread_lock);
+
+    klist_del(&thread->hash);
+
+    rwlock_write_unlock(&thread_lock);
+}
+
+static int thread_new_tid(struct process *p)
+{
+    return idmap_alloc(&p->tids);
 }
 
 int thread_create(struct process *process, uintptr_t code, int argc,
@@ -67,6 +87,8 @@ int thread_create(struct process *process, uintptr_t code, int argc,
     int tid;
     vaddr_t thread_kstack;
     struct thread *thread;
+    struct thread *creator = thread_current();
+    struct sched_attr default_attr = SCHED_ATTR_INIT;
 
     if (!code)
         return -1;
@@ -78,9 +100,12 @@ int thread_create(struct process *process, uintptr_t code, int argc,
      * Allocate one entire page because thread structure is located on the
      * kernel stack
      */
-    thread_kstack = as_map(&kernel_as, 0, 0, PAGE_SIZE, AS_MAP_WRITE);
+    thread_kstack = kstack_alloc();
     if (!thread_kstack)
+    {
+        idmap_free(&process->tids, tid);
         return -1;
+    }
 
     thread = (void *)((uintptr_t)thread_kstack + PAGE_SIZE -
                       sizeof (struct thread));
@@ -94,19 +119,36 @@ int thread_create(struct process *process, uintptr_t code, int argc,
     thread->gid = 0;
     thread->kstack = (uintptr_t)thread - 4;
 
+    /* Threads of a process inherit the scheduling attributes of the creator */
+    thread->cpu = 0;
+    if (creator && creator->parent == process)
+        thread->sattr = creator->sattr;
+    else
+        thread->sattr = default_attr;
+
+    thread->interactive = 0;
+    memset(&thread->stats, 0, sizeof (thread->stats));
+
+    thread->sched.prev = NULL;
+    thread->sched.next = NULL;
+
     memset(thread->interrupts, 0, sizeof (thread->interrupts));
     memset(&thread->event, 0, sizeof (thread->event));
+    memset(&thread->regs, 0, sizeof (thread->regs));
+    thread->futex = NULL;
+    thread->aio = NULL;
 
-    if (!glue_call(thread, create, process, thread, code, argc, argv,
-                   flags & THREAD_CREATEF_DEEP_ARGV_COPY))
+    if (!glue_call(thread, create, process, thread, code, argc, argv, flags))
     {
-        as_unmap(&kernel_as, (vaddr_t)thread, AS_UNMAP_RELEASE);
+        kstack_free(thread_kstack);
+        idmap_free(&process->tids, tid);
         return -1;
     }
 
     ++process->thread_count;
 
     klist_add(&process->threads, &thread->list);
+    thread_hash_add(thread);
 
     if (!(flags & THREAD_CREATEF_NOSTART_THREAD))
         cpu_add_thread(thread);
@@ -117,28 +159,40 @@ int thread_create(struct process *process, uintptr_t code, int argc,
 struct thread *thread_get(struct process *p, pid_t tid)
 {
     struct thread *t;
+    struct thread *ret = NULL;
 
-    spinlock_lock(&p->plock);
-
-    klist_for_each(&p->threads, tlist, list) {
-        t = klist_elem(tlist, struct thread, list);
+    rwlock_read_lock(&thread_lock);
 
-        if (t->tid == tid) {
-            spinlock_unlock(&p->plock);
-            return t;
+    klist_for_each_elem(thread_bucket(p->pid, tid), t, hash) {
+        if (t->parent == p && t->tid == tid) {
+            ret = t;
+            break;
         }
     }
 
-    spinlock_unlock(&p->plock);
+    rwlock_read_unlock(&thread_lock);
 
-    return NULL;
+    return ret;
 }
 
 int thread_update_exec(struct thread *thread, uintptr_t eip, char *argv[])
 {
     int argc = 0;
+    struct process *p = thread->parent;
 
-    thread->tid = 0;
+    /*
+     * The thread becomes the main thread of the new program. Take tid 0 if
+     * it is free, the other threads may still hold it until they are reaped
+     */
+    if (thread->tid && !idmap_reserve(&p->tids, 0))
+    {
+        thread_hash_del(thread);
+        idmap_free(&p->tids, thread->tid);
+
+        thread->tid = 0;
+
+        thread_hash_add(thread);
+    }
 
     if (argv)
     {
@@ -146,7 +200,8 @@ int thread_update_exec(struct thread *thread, uintptr_t eip, char *argv[])
             ;
     }
 
-    if (!glue_call(thread, create, thread->parent, thread, eip, argc, argv, 1))
+    if (!glue_call(thread, create, thread->parent, thread, eip, argc, argv,
+                   THREAD_CREATEF_DEEP_ARGV_COPY))
         return -1;
 
     return 0;
@@ -162,8 +217,11 @@ int thread_duplicate(struct process *process, struct thread *thread,
     if ((tid = thread_new_tid(process)) < 0)
         return 0;
 
-    if (!(t_mem = (void *)(as_map(&kernel_as, 0, 0, PAGE_SIZE, AS_MAP_WRITE))))
+    if (!(t_mem = (void *)kstack_alloc()))
+    {
+        idmap_free(&process->tids, tid);
         return 0;
+    }
 
     new = t_mem + PAGE_SIZE - sizeof (struct thread);
 
@@ -175,12 +233,24 @@ int thread_duplicate(struct process *process, struct thread *thread,
     new->gid = thread->gid;
     new->kstack = (uintptr_t)new - 4;
 
+    new->cpu = 0;
+    new->sattr = thread->sattr;
+    new->interactive = thread->interactive;
+    memset(&new->stats, 0, sizeof (new->stats));
+
+    new->sched.prev = NULL;
+    new->sched.next = NULL;
+
     memset(thread->interrupts, 0, sizeof (thread->interrupts));
     memset(&thread->event, 0, sizeof (thread->event));
+    memset(&new->regs, 0, sizeof (new->regs));
+    new->futex = NULL;
+    new->aio = NULL;
 
     if (!glue_call(thread, duplicate, new, regs))
     {
-        as_unmap(&kernel_as, (vaddr_t)new, AS_UNMAP_RELEASE);
+        kstack_free((vaddr_t)t_mem);
+        idmap_free(&process->tids, tid);
 
         return 0;
     }
@@ -188,6 +258,7 @@ int thread_duplicate(struct process *process, struct thread *thread,
     ++process->thread_count;
 
     klist_add(&process->threads, &new->list);
+    thread_hash_add(new);
 
     cpu_add_thread(new);
 
@@ -255,11 +326,13 @@ void thread_exit(struct thread *thread)
     /* The thread will be destroy when it is elected by the scheduler */
     thread->state = THREAD_STATE_ZOMBIE;
 
+    /* Leave the futex the thread is blocked on */
+    futex_cancel(thread);
+
     /* Unregister interrupts */
     for (int i = 0; i < IRQ_USER_SIZE; ++i)
     {
-        if (thread->interrupts[i] & INTERRUPT_REGISTERED)
-            interrupt_unregister(i + IRQ_USER_BEGIN);
+        interrupt_user_unregister(thread, i + IRQ_USER_BEGIN);
 
         thread->interrupts[i] = 0;
     }
@@ -267,14 +340,59 @@ void thread_exit(struct thread *thread)
 
 void thread_destroy(struct thread *thread)
 {
+    glue_call(thread, destroy, thread);
+
     thread->kstack = align(thread->kstack, PAGE_SIZE) - PAGE_SIZE;
 
     klist_del(&thread->list);
+    thread_hash_del(thread);
+
+    idmap_free(&thread->parent->tids, thread->tid);
 
     --(thread->parent->thread_count);
 
     if (!thread->parent->thread_count)
         process_destroy(thread->parent);
 
-    as_unmap(&kernel_as, thread->kstack, AS_UNMAP_RELEASE);
+    /*
+     * A worker may be destroyed in the middle of a request. The thread lives
+     * on its stack, so this is done before the stack is released
+     */
+    if (thread->aio)
+        aio_put(thread->aio);
+
+    kstack_free(thread->kstack);
+}
+
+int thread_stats_collect(struct sched_thread_info *info, int count)
+{
+    struct thread *t;
+    int n = 0;
+
+    rwlock_read_lock(&thread_lock);
+
+    for (int i = 0; i < THREAD_HASH_SIZE && n < count; ++i) {
+        klist_for_each_elem(&thread_hash[i], t, hash) {
+            if (n == count)
+                break;
+
+            info[n].pid = t->parent->pid;
+            info[n].tid = t->tid;
+            info[n].state = t->state;
+            info[n].cpu = t->cpu;
+            info[n].policy = t->sattr.policy;
+            info[n].nice = t->sattr.nice;
+
+            strncpy(info[n].name, t->parent->name, SCHED_STATS_NAME_MAX - 1);
+            info[n].name[SCHED_STATS_NAME_MAX - 1] = '\0';
+
+            info[n].stats = t->stats;
+
+            ++n;
+        }
+    }
+
+    rwlock_read_unlock(&thread_lock);
+
+    return n;
 }
@@ -6,7 +6,8 @@
 static void remove_process(struct process *child)
 {
     klist_del(&child->brothers);
-    klist_del(&child->list);
+
+    process_release(child);
 
     child->pid = -1;
 }
@@ -1,7 +1,12 @@
+#include <string.h>
+
 #include <kernel/scheduler.h>
 #include <kernel/zos.h>
 #include <kernel/console.h>
 #include <kernel/cpu.h>
+#include <kernel/errno.h>
+
+#include <kernel/scheduler/trace.h>
 
 void scheduler_initialize(struct scheduler *sched)
 {
@@ -10,28 +15,120 @@ void scheduler_initialize(struct scheduler *sched)
      * first thread will be scheduled
      */
     sched->time = 0;
+    sched->need_resched = 0;
     sched->running = NULL;
     sched->thread_num = 0;
+    sched->handoff = NULL;
+    sched->handoff_from = NULL;
+    sched->migrating = NULL;
+
+    memset(&sched->stats, 0, sizeof (sched->stats));
 
     spinlock_init(&sched->sched_lock);
 
     klist_head_init(&sched->threads);
+    klist_head_init(&sched->rt_threads);
 
     scheduler_event_initialize();
 }
 
-void scheduler_add_thread(struct scheduler *sched, struct thread *thread)
+size_t scheduler_timeslice(struct thread *thread)
+{
+    size_t time;
+
+    if (thread->sattr.policy == SCHED_FIFO)
+        return SCHEDULER_TIME_RT;
+
+    /* nice -20 doubles the default timeslice, nice 19 nearly cancels it */
+    time = SCHEDULER_TIME * (20 - thread->sattr.nice) / 20;
+
+    if (thread->sattr.policy == SCHED_BATCH)
+        time *= 2;
+
+    return time ? time : 1;
+}
+
+/*
+ * Queue a thread according to its policy, SCHED_FIFO threads are put behind
+ * the ones of greater or equal priority
+ */
+static void scheduler_queue(struct scheduler *sched, struct thread *thread)
+{
+    struct thread *t;
+
+    if (thread->sattr.policy != SCHED_FIFO)
+    {
+        klist_add_back(&sched->threads, &thread->sched);
+
+        return;
+    }
+
+    klist_for_each_elem(&sched->rt_threads, t, sched)
+    {
+        if (t->sattr.rt_priority < thread->sattr.rt_priority)
+        {
+            klist_add_back(&t->sched, &thread->sched);
+
+            return;
+        }
+    }
+
+    klist_add_back(&sched->rt_threads, &thread->sched);
+}
+
+/*
+ * Whether thread must take the cpu from the running thread: realtime threads
+ * preempt time shared ones, and a thread that has a lower nice value or that
+ * mostly sleeps preempts a cpu bound one. SCHED_BATCH threads never preempt
+ */
+static int scheduler_preempts(struct scheduler *sched, struct thread *thread)
+{
+    struct thread *running = sched->running;
+
+    if (!running || running == sched->idle)
+        return 1;
+
+    if (thread->sattr.policy == SCHED_FIFO)
+        return running->sattr.policy != SCHED_FIFO ||
+               running->sattr.rt_priority < thread->sattr.rt_priority;
+
+    if (running->sattr.policy == SCHED_FIFO ||
+        thread->sattr.policy == SCHED_BATCH)
+        return 0;
+
+    if (thread->sattr.nice < running->sattr.nice)
+        return 1;
+
+    return thread->interactive &&
+           (running->sattr.policy == SCHED_BATCH || !running->interactive);
+}
+
+int scheduler_add_thread(struct scheduler *sched, struct thread *thread)
 {
+    int preempt;
+
     spinlock_lock(&sched->sched_lock);
 
     ++sched->thread_num;
 
-    klist_add_back(&sched->threads, &thread->sched);
+    preempt = sched->running && scheduler_preempts(sched, thread);
 
-    if (sched->running && sched->running == sched->idle)
-        sched->time = 1;
+    /* A preempting thread is the next one elected by the round robin */
+    if (preempt && thread->sattr.policy != SCHED_FIFO)
+        klist_add(&sched->threads, &thread->sched);
+    else
+        scheduler_queue(sched, thread);
+
+    /*
+     * The running thread keeps its remaining time, it may still hand it to
+     * the woken thread if it blocks before the reschedule
+     */
+    if (preempt)
+        sched->need_resched = 1;
 
     spinlock_unlock(&sched->sched_lock);
+
+    return preempt;
 }
 
 void scheduler_start(struct scheduler *sched)
@@ -41,7 +138,33 @@ void scheduler_start(struct scheduler *sched)
     scheduler_update(NULL, 0);
 }
 
-static struct thread *scheduler_elect(struct scheduler *sched, int force)
+/*
+ * Elect the SCHED_FIFO thread of highest priority, if any. When force is set
+ * the running thread yields to the threads of the same priority
+ */
+static struct thread *scheduler_elect_rt(struct scheduler *sched, int force)
+{
+    struct thread *thread;
+    struct thread *running = sched->running;
+
+    if (force && running && running->sched.next &&
+        running->sattr.policy == SCHED_FIFO)
+    {
+        klist_del(&running->sched);
+
+        scheduler_queue(sched, running);
+    }
+
+    klist_for_each_elem(&sched->rt_threads, thread, sched)
+    {
+        if (!force || thread != running)
+            return thread;
+    }
+
+    return NULL;
+}
+
+static struct thread *scheduler_elect_rr(struct scheduler *sched, int force)
 {
     struct thread *thread;
 
@@ -67,7 +190,7 @@ static struct thread *scheduler_elect(struct scheduler *sched, int force)
         if (count == 0)
             thread = sched->idle;
         else
-            thread = scheduler_elect(sched, force);
+            thread = scheduler_elect_rr(sched, force);
     }
     else
         klist_add_back(&sched->threads, &thread->sched);
@@ -75,76 +198,260 @@ static struct thread *scheduler_elect(struct scheduler *sched, int force)
     return thread;
 }
 
+/*
+ * Elect the thread the running one handed the cpu to, if the running thread
+ * blocked and no realtime thread has precedence over the target
+ */
+static struct thread *scheduler_elect_handoff(struct scheduler *sched)
+{
+    struct thread *thread = sched->handoff;
+    struct thread *rt;
+
+    sched->handoff = NULL;
+
+    if (!thread || sched->handoff_from != sched->running ||
+        !sched->running || sched->running->state != THREAD_STATE_BLOCKED)
+        return NULL;
+
+    /* The target must be queued on this scheduler */
+    if (thread->state != THREAD_STATE_RUNNING || !thread->sched.next ||
+        &cpu_get(thread->cpu)->scheduler != sched)
+        return NULL;
+
+    rt = klist_first_elem(&sched->rt_threads, struct thread, sched);
+    if (rt && rt != thread && (thread->sattr.policy != SCHED_FIFO ||
+                               rt->sattr.rt_priority >
+                               thread->sattr.rt_priority))
+        return NULL;
+
+    /* Move it behind the others, as scheduler_elect_rr() does */
+    if (thread->sattr.policy != SCHED_FIFO)
+    {
+        klist_del(&thread->sched);
+        klist_add_back(&sched->threads, &thread->sched);
+    }
+
+    return thread;
+}
+
+static struct thread *scheduler_elect(struct scheduler *sched, int force)
+{
+    struct thread *thread = scheduler_elect_rt(sched, force);
+
+    if (thread)
+        return thread;
+
+    return scheduler_elect_rr(sched, force);
+}
+
+/*
+ * Give the cpu to new_thread for time ticks, or for its whole timeslice if
+ * time is 0
+ */
 static void scheduler_switch(struct scheduler *sched,
                              struct thread *new_thread, struct irq_regs *regs,
-                             spinlock_t *sched_lock)
+                             spinlock_t *sched_lock, int reason, size_t time)
 {
     struct thread *old = sched->running;
 
+    sched_trace(SCHED_TRACE_SWITCH_OUT, old, reason, 0);
+    sched_trace(SCHED_TRACE_SWITCH_IN, new_thread, reason, 0);
+
+    ++sched->stats.switches;
+    ++new_thread->stats.switches;
+
+    if (old && old != sched->idle)
+    {
+        if (reason == SCHED_TRACE_TIMESLICE || reason == SCHED_TRACE_PREEMPT)
+            ++old->stats.involuntary;
+        else
+            ++old->stats.voluntary;
+    }
+
     sched->running = new_thread;
-    sched->time = SCHEDULER_TIME;
+    sched->time = scheduler_timeslice(new_thread);
+
+    if (time && time < sched->time)
+        sched->time = time;
+
+    process_info_update(new_thread);
 
     _scheduler.sswitch(regs, new_thread, old, sched_lock);
 }
 
+/*
+ * Remove the blocked and zombie threads from a queue
+ */
+static void scheduler_clean(struct scheduler *sched, struct klist *queue)
+{
+    struct thread *thread;
+
+    klist_for_each(queue, tlist, sched)
+    {
+        thread = klist_elem(tlist, struct thread, sched);
+
+        if (thread->state == THREAD_STATE_BLOCKED)
+            klist_del(&thread->sched);
+        else if (thread->state == THREAD_STATE_ZOMBIE)
+        {
+            if (sched->running == thread)
+                continue;
+
+            klist_del(&thread->sched);
+
+            /*
+             * FIXME: I don't like the fact that the lock is released here
+             * might cause bugs. Maybe an asynchronous event dispatcher
+             * would be cleaner and may improve stability a lot
+             * (thread_destroy dispatch two events which are responsable
+             * for dead locks if the lock is not released)
+             */
+            spinlock_unlock_no_restore(&sched->sched_lock);
+
+            thread_destroy(thread);
+
+            spinlock_lock(&sched->sched_lock);
+        }
+    }
+}
+
+/*
+ * Why the running thread is about to leave the cpu, for the trace
+ */
+static int scheduler_switch_reason(struct scheduler *sched, int force)
+{
+    struct thread *running = sched->running;
+
+    if (!running || running->state == THREAD_STATE_ZOMBIE)
+        return SCHED_TRACE_EXIT;
+
+    if (running->state == THREAD_STATE_BLOCKED)
+        return SCHED_TRACE_BLOCKED;
+
+    if (sched->need_resched)
+        return SCHED_TRACE_PREEMPT;
+
+    if (force)
+        return SCHED_TRACE_YIELD;
+
+    return SCHED_TRACE_TIMESLICE;
+}
+
+/*
+ * Take the running thread off the queues if its affinity excludes this cpu,
+ * it is handed to another cpu once this one switched away from it
+ */
+static void scheduler_migrate_running(struct cpu *cpu)
+{
+    struct scheduler *sched = &cpu->scheduler;
+    struct thread *running = sched->running;
+
+    if (!running || running == sched->idle ||
+        running->state != THREAD_STATE_RUNNING ||
+        running->sattr.affinity & (1U << cpu->id))
+        return;
+
+    klist_del(&running->sched);
+    --sched->thread_num;
+
+    sched->migrating = running;
+}
+
 void scheduler_update(struct irq_regs *regs, int force)
 {
     struct cpu *cpu = cpu_get(cpu_id_get());
+    struct thread *migrating = cpu->scheduler.migrating;
+
+    /* Only this cpu sets it, and the switch away from it is complete */
+    if (migrating && migrating != cpu->scheduler.running)
+    {
+        cpu->scheduler.migrating = NULL;
+
+        cpu_add_thread(migrating);
+    }
 
     spinlock_lock(&cpu->scheduler.sched_lock);
 
     --cpu->scheduler.time;
 
-    if (cpu->scheduler.time <= 0 ||
+    if (cpu->scheduler.time <= 0 || cpu->scheduler.need_resched ||
         cpu->scheduler.running->state != THREAD_STATE_RUNNING ||
         !regs || force ||
         (cpu->scheduler.running == cpu->scheduler.idle &&
-         !klist_empty(&cpu->scheduler.threads)))
+         (!klist_empty(&cpu->scheduler.threads) ||
+          !klist_empty(&cpu->scheduler.rt_threads))))
     {
         struct thread *thread;
+        size_t donated = 0;
+        int reason = scheduler_switch_reason(&cpu->scheduler, force);
+
+        /* A thread that used its whole timeslice is cpu bound */
+        if (cpu->scheduler.time <= 0 && !cpu->scheduler.need_resched)
+            cpu->scheduler.running->interactive = 0;
+
+        cpu->scheduler.need_resched = 0;
+
+        scheduler_migrate_running(cpu);
 
         /* Clean blocked/zombie thread if any */
-        klist_for_each(&cpu->scheduler.threads, tlist, sched)
-        {
-            thread = klist_elem(tlist, struct thread, sched);
-
-            if (thread->state == THREAD_STATE_BLOCKED)
-                klist_del(&thread->sched);
-            else if (thread->state == THREAD_STATE_ZOMBIE)
-            {
-                if (cpu->scheduler.running == thread)
-                    continue;
-
-                klist_del(&thread->sched);
-
-                /*
-                 * FIXME: I don't like the fact that the lock is released here
-                 * might cause bugs. Maybe an asynchronous event dispatcher
-                 * would be cleaner and may improve stability a lot
-                 * (thread_destroy dispatch two events which are responsable
-                 * for dead locks if the lock is not released)
-                 */
-                spinlock_unlock_no_restore(&cpu->scheduler.sched_lock);
-
-                thread_destroy(thread);
-
-                spinlock_lock(&cpu->scheduler.sched_lock);
-            }
-        }
+        scheduler_clean(&cpu->scheduler, &cpu->scheduler.rt_threads);
+        scheduler_clean(&cpu->scheduler, &cpu->scheduler.threads);
 
-        thread = scheduler_elect(&cpu->scheduler, force);
+        /* A blocking thread lends the rest of its timeslice */
+        thread = scheduler_elect_handoff(&cpu->scheduler);
+        if (thread)
+            donated = cpu->scheduler.time;
+        else
+            thread = scheduler_elect(&cpu->scheduler, force);
 
         if (thread != cpu->scheduler.running)
             scheduler_switch(&cpu->scheduler, thread, regs,
-                             &cpu->scheduler.sched_lock);
+                             &cpu->scheduler.sched_lock, reason, donated);
         else
-            cpu->scheduler.time = SCHEDULER_TIME;
+            cpu->scheduler.time = scheduler_timeslice(thread);
 
     }
 
     spinlock_unlock(&cpu->scheduler.sched_lock);
 }
 
+void scheduler_tick(struct irq_regs *regs)
+{
+    struct scheduler *sched = &cpu_get(cpu_id_get())->scheduler;
+    struct thread *running = sched->running;
+
+    if (!running)
+        return;
+
+    if (running == sched->idle)
+        ++sched->stats.idle_ticks;
+    else if (irq_regs_user(regs))
+    {
+        ++sched->stats.user_ticks;
+        ++running->stats.user_ticks;
+    }
+    else
+    {
+        ++sched->stats.kernel_ticks;
+        ++running->stats.kernel_ticks;
+    }
+}
+
+void scheduler_preempt(struct irq_regs *regs)
+{
+    struct cpu *cpu = cpu_get(cpu_id_get());
+
+    /* Not a safe point if the interrupted code holds a lock */
+    if (!cpu->scheduler.need_resched || !cpu->scheduler.running ||
+        spinlock_held())
+        return;
+
+    /* scheduler_update() consumes this tick and elects a new thread */
+    cpu->scheduler.time = 1;
+
+    scheduler_update(regs, 0);
+}
+
 void scheduler_remove_thread(struct thread *t, struct scheduler *sched)
 {
     /*
@@ -157,10 +464,14 @@ void scheduler_remove_thread(struct thread *t, struct scheduler *sched)
         return;
     }
 
+    sched_trace(SCHED_TRACE_BLOCK, t, t->event.event, t->event.data);
+
     if (t == sched->running)
     {
         --sched->thread_num;
 
+        t->interactive = sched->time > scheduler_timeslice(t) / 2;
+
         spinlock_unlock(&sched->sched_lock);
 
         /* FIXME: Move that shit away ! */
@@ -185,3 +496,73 @@ void scheduler_remove_thread(struct thread *t, struct scheduler *sched)
         spinlock_unlock(&sched->sched_lock);
     }
 }
+
+void scheduler_handoff(struct thread *thread)
+{
+    struct scheduler *sched = &cpu_get(cpu_id_get())->scheduler;
+
+    spinlock_lock(&sched->sched_lock);
+
+    sched->handoff = thread;
+    sched->handoff_from = sched->running;
+
+    spinlock_unlock(&sched->sched_lock);
+}
+
+int scheduler_set_attr(struct thread *thread, const struct sched_attr *attr)
+{
+    struct scheduler *sched = &cpu_get(thread->cpu)->scheduler;
+    int queued;
+    int migrate;
+
+    if (attr->policy != SCHED_NORMAL && attr->policy != SCHED_BATCH &&
+        attr->policy != SCHED_FIFO)
+        return -EINVAL;
+
+    if (attr->nice < SCHED_NICE_MIN || attr->nice > SCHED_NICE_MAX)
+        return -EINVAL;
+
+    if (attr->policy == SCHED_FIFO && (attr->rt_priority < SCHED_RT_PRIO_MIN ||
+                                       attr->rt_priority > SCHED_RT_PRIO_MAX))
+        return -EINVAL;
+
+    if (!(attr->affinity & SCHEDULER_AFFINITY_MASK))
+        return -EINVAL;
+
+    spinlock_lock(&sched->sched_lock);
+
+    /* A thread is linked in a queue of its scheduler unless it is blocked */
+    queued = thread->sched.next != NULL;
+
+    if (queued)
+        klist_del(&thread->sched);
+
+    thread->sattr = *attr;
+
+    if (attr->policy != SCHED_FIFO)
+        thread->sattr.rt_priority = 0;
+
+    /* The running thread moves at its next switch, see scheduler_update() */
+    migrate = queued && thread != sched->running &&
+              !(attr->affinity & (1U << thread->cpu));
+
+    if (migrate)
+        --sched->thread_num;
+    else if (queued)
+    {
+        scheduler_queue(sched, thread);
+
+        if (thread == sched->running || scheduler_preempts(sched, thread))
+        {
+            sched->time = 1;
+            sched->need_resched = 1;
+        }
+    }
+
+    spinlock_unlock(&sched->sched_lock);
+
+    if (migrate)
+        cpu_add_thread(thread);
+
+    return 0;
+}
@@ -0,0 +1,137 @@
+#include <string.h>
+
+#include <kernel/zos.h>
+#include <kernel/errno.h>
+#include <kernel/cpu.h>
+#include <kernel/timer.h>
+
+#include <kernel/proc/thread.h>
+
+#include <kernel/fs/vfs.h>
+#include <kernel/fs/vfs/device.h>
+#include <kernel/fs/vfs/message.h>
+
+#include <kernel/scheduler/trace.h>
+
+#include <arch/tsc.h>
+
+/*
+ * Each cpu only writes its own ring. Slots are reserved with an atomic
+ * increment so that an interrupt can trace in the middle of a record. The
+ * reader lags behind and skips what has been overwritten
+ */
+struct sched_trace_ring {
+    volatile uint32_t head;
+    uint32_t tail;
+
+    struct sched_trace_event events[SCHED_TRACE_SIZE];
+};
+
+static struct sched_trace_ring rings[CPU_COUNT];
+static spinlock_t reader_lock = SPINLOCK_INIT;
+static int use_tsc;
+
+void sched_trace(int type, struct thread *thread, int32_t arg0, int32_t arg1)
+{
+    int cpu = cpu_id_get();
+    struct sched_trace_ring *ring = &rings[cpu];
+    struct sched_trace_event *event;
+    uint32_t slot;
+
+    slot = __sync_fetch_and_add(&ring->head, 1);
+    event = &ring->events[slot & (SCHED_TRACE_SIZE - 1)];
+
+    event->tsc = use_tsc ? tsc_read() : timer_ticks_get();
+    event->type = type;
+    event->cpu = cpu;
+    event->pid = thread ? thread->parent->pid : -1;
+    event->tid = thread ? thread->tid : -1;
+    event->arg0 = arg0;
+    event->arg1 = arg1;
+}
+
+/*
+ * Pop the oldest event of a cpu, return 0 if there isn't any
+ */
+static int sched_trace_pop(struct sched_trace_ring *ring,
+                           struct sched_trace_event *event)
+{
+    uint32_t head;
+
+    spinlock_lock(&reader_lock);
+
+    head = ring->head;
+
+    if (ring->tail == head) {
+        spinlock_unlock(&reader_lock);
+        return 0;
+    }
+
+    /* The writer lapped us, the oldest events are lost */
+    if (head - ring->tail > SCHED_TRACE_SIZE)
+        ring->tail = head - SCHED_TRACE_SIZE;
+
+    *event = ring->events[ring->tail & (SCHED_TRACE_SIZE - 1)];
+    ++ring->tail;
+
+    spinlock_unlock(&reader_lock);
+
+    return 1;
+}
+
+static int sched_trace_open(struct file __unused *file, ino_t __unused inode,
+                            pid_t __unused pid, uid_t uid,
+                            gid_t __unused gid, int __unused flags,
+                            mode_t __unused mode)
+{
+    if (uid != 0)
+        return -EPERM;
+
+    return 0;
+}
+
+/*
+ * Consume the buffered events, cpu after cpu, as whole records
+ */
+static int sched_trace_read(struct file __unused *file,
+                            struct process __unused *p, struct req_rdwr *req,
+                            void *buf)
+{
+    struct sched_trace_event event;
+    struct sched_trace_event *out = buf;
+    size_t count = 0;
+    size_t max = req->size / sizeof (struct sched_trace_event);
+
+    for (int i = 0; i < CPU_COUNT && count < max; ++i) {
+        while (count < max && sched_trace_pop(&rings[i], &event))
+            out[count++] = event;
+    }
+
+    req->off += count * sizeof (struct sched_trace_event);
+
+    return count * sizeof (struct sched_trace_event);
+}
+
+static int sched_trace_close(struct file __unused *file, ino_t __unused inode)
+{
+    return 0;
+}
+
+static struct file_operation sched_trace_f_ops = {
+    .open = sched_trace_open,
+    .read = sched_trace_read,
+    .close = sched_trace_close,
+};
+
+int sched_trace_initialize(void)
+{
+    dev_t dev;
+
+    use_tsc = tsc_supported();
+
+    dev = vfs_device_create("schedtrace", 0, 0,
+                            VFS_OPS_OPEN | VFS_OPS_READ | VFS_OPS_CLOSE,
+                            &sched_trace_f_ops, NULL);
+
+    return dev < 0 ? dev : 0;
+}
@@ -1,9 +1,12 @@
 #include <string.h>
 
+#include <kernel/config.h>
 #include <kernel/zos.h>
+#include <kernel/errno.h>
 #include <kernel/panic.h>
 #include <kernel/console.h>
 #include <kernel/syscall.h>
+#include <kernel/cpu.h>
 
 #include <kernel/proc/thread.h>
 
@@ -18,6 +21,17 @@ static int sys_uprint(struct syscall *interface)
     return 0;
 }
 
+static int sys_lockstat_dump(struct syscall __unused *interface)
+{
+#ifdef CONFIG_SPINLOCK_STAT
+    spinlock_stat_dump();
+
+    return 0;
+#else
+    return -ENOSYS;
+#endif /* !CONFIG_SPINLOCK_STAT */
+}
+
 static syscall_callback syscalls[] =
 {
     &sys_uprint,
@@ -74,6 +88,35 @@ static syscall_callback syscalls[] =
 
     sys_fs_register,
     sys_fs_unregister,
+
+    /* Futex */
+    sys_futex_wait,
+    sys_futex_wake,
+
+    /* Debug */
+    sys_lockstat_dump,
+
+    /* Scheduling */
+    sys_sched_setattr,
+    sys_sched_getattr,
+    sys_thread_stats,
+    sys_cpu_stats,
+
+    /* Fs - channel */
+    sys_fs_channel_reply_wait,
+    sys_fs_channel_reply_wait_batch,
+
+    /* Fs - poll */
+    sys_fs_poll_create,
+    sys_fs_poll_ctl,
+    sys_fs_poll_wait,
+
+    /* Fs - aio */
+    sys_fs_aio_setup,
+    sys_fs_aio_enter,
+
+    /* Vfs - getdents */
+    sys_vfs_getdents,
 };
 
 void syscall_handler(struct irq_regs *regs)
@@ -96,6 +139,8 @@ void syscall_handler(struct irq_regs *regs)
     }
 
     *call.ret = syscalls[call.num - 1](&call);
+
+    scheduler_preempt(regs);
 }
 
 void syscall_initialize(void)
@@ -7,6 +7,8 @@
 
 #include <kernel/scheduler/event.h>
 
+#include <kernel/fs/poll.h>
+
 struct irq {
     struct thread *thread;
 
@@ -44,6 +46,10 @@ int sys_interrupt_register(struct syscall *interface)
 
     irq = &interrupts[user_irq];
 
+    /* The queue is initialized by the first registration of the irq */
+    if (irq->queue.pollers.next)
+        poll_detach(&irq->queue);
+
     t->interrupts[user_irq] = INTERRUPT_REGISTERED;
     irq->thread = t;
     wait_queue_init(&irq->queue);
@@ -89,20 +95,51 @@ int sys_interrupt_listen(struct syscall *interface)
 
 int sys_interrupt_unregister(struct syscall *interface)
 {
-    int irq_num = interface->arg1;
+    interrupt_user_unregister(thread_current(), interface->arg1);
+
+    return 0;
+}
+
+struct wait_queue *interrupt_user_queue(struct thread *t, int irq_num)
+{
     int user_irq = irq_num - IRQ_USER_BEGIN;
-    struct thread *t = thread_current();
 
     if (irq_num < IRQ_USER_BEGIN || irq_num > IRQ_USER_END)
-        return 0;
+        return NULL;
 
     if (!(t->interrupts[user_irq] & INTERRUPT_REGISTERED))
+        return NULL;
+
+    return &interrupts[user_irq].queue;
+}
+
+int interrupt_user_ack(struct thread *t, int irq_num)
+{
+    int user_irq = irq_num - IRQ_USER_BEGIN;
+
+    if (!(t->interrupts[user_irq] & INTERRUPT_FIRED))
         return 0;
 
+    t->interrupts[user_irq] &= ~INTERRUPT_FIRED;
+
+    return 1;
+}
+
+void interrupt_user_unregister(struct thread *t, int irq_num)
+{
+    int user_irq = irq_num - IRQ_USER_BEGIN;
+
+    if (irq_num < IRQ_USER_BEGIN || irq_num > IRQ_USER_END)
+        return;
+
+    if (!(t->interrupts[user_irq] & INTERRUPT_REGISTERED))
+        return;
+
     interrupt_unregister(irq_num);
 
     t->interrupts[user_irq] = 0;
     interrupts[user_irq].thread = NULL;
 
-    return 0;
+    /* The sets watching the irq must not look at the thread anymore */
+    poll_detach(&interrupts[user_irq].queue);
 }
@@ -1,7 +1,16 @@
+#include <string.h>
+
+#include <kernel/errno.h>
 #include <kernel/syscall.h>
 #include <kernel/cpu.h>
+#include <kernel/scheduler.h>
+#include <kernel/time.h>
+
+#include <kernel/mem/as.h>
+#include <kernel/mem/kmalloc.h>
 
 #include <kernel/proc/thread.h>
+#include <kernel/proc/futex.h>
 
 int sys_thread_create(struct syscall *interface)
 {
@@ -33,3 +42,142 @@ int sys_gettid(struct syscall *interface)
 
     return thread_current()->tid;
 }
+
+int sys_futex_wait(struct syscall *interface)
+{
+    uint32_t *uaddr = (uint32_t *)interface->arg1;
+    uint32_t val = interface->arg2;
+    size_t timeout = interface->arg3;
+
+    /* Userland counts in milliseconds, a timeout below a tick still expires */
+    if (timeout) {
+        timeout = ms_to_ticks(timeout);
+        if (!timeout)
+            timeout = 1;
+    }
+
+    return futex_wait(thread_current(), uaddr, val, timeout);
+}
+
+int sys_futex_wake(struct syscall *interface)
+{
+    uint32_t *uaddr = (uint32_t *)interface->arg1;
+    int count = interface->arg2;
+
+    return futex_wake(thread_current(), uaddr, count);
+}
+
+/*
+ * tid < 0 designates the calling thread, other threads are looked up in the
+ * process of the caller
+ */
+static struct thread *sched_target(int tid)
+{
+    struct thread *current = thread_current();
+
+    if (tid < 0)
+        return current;
+
+    return thread_get(current->parent, tid);
+}
+
+int sys_sched_setattr(struct syscall *interface)
+{
+    int tid = interface->arg1;
+    struct sched_attr *uattr = (void *)interface->arg2;
+    struct sched_attr attr;
+    struct thread *current = thread_current();
+    struct thread *thread;
+
+    if (!as_is_mapped(current->parent->as, (vaddr_t)uattr,
+                      sizeof (struct sched_attr)))
+        return -EFAULT;
+
+    attr = *uattr;
+
+    if (!(thread = sched_target(tid)))
+        return -ESRCH;
+
+    /* Only root may raise a priority or enter the realtime class */
+    if (current->uid != 0 &&
+        (attr.nice < thread->sattr.nice ||
+         (attr.policy == SCHED_FIFO &&
+          (thread->sattr.policy != SCHED_FIFO ||
+           attr.rt_priority > thread->sattr.rt_priority))))
+        return -EPERM;
+
+    return scheduler_set_attr(thread, &attr);
+}
+
+int sys_sched_getattr(struct syscall *interface)
+{
+    int tid = interface->arg1;
+    struct sched_attr *uattr = (void *)interface->arg2;
+    struct thread *thread;
+
+    if (!as_is_mapped(thread_current()->parent->as, (vaddr_t)uattr,
+                      sizeof (struct sched_attr)))
+        return -EFAULT;
+
+    if (!(thread = sched_target(tid)))
+        return -ESRCH;
+
+    *uattr = thread->sattr;
+
+    return 0;
+}
+
+int sys_thread_stats(struct syscall *interface)
+{
+    struct sched_thread_info *uinfo = (void *)interface->arg1;
+    int count = interface->arg2;
+    struct sched_thread_info *info;
+    int ret;
+
+    if (count <= 0)
+        return -EINVAL;
+
+    if (count > SCHED_STATS_MAX)
+        count = SCHED_STATS_MAX;
+
+    if (!as_is_mapped(thread_current()->parent->as, (vaddr_t)uinfo,
+                      count * sizeof (struct sched_thread_info)))
+        return -EFAULT;
+
+    /* The entries are gathered under the thread lock, never fault there */
+    info = kmalloc(count * sizeof (struct sched_thread_info));
+    if (!info)
+        return -ENOMEM;
+
+    ret = thread_stats_collect(info, count);
+
+    memcpy(uinfo, info, ret * sizeof (struct sched_thread_info));
+
+    kfree(info);
+
+    return ret;
+}
+
+int sys_cpu_stats(struct syscall *interface)
+{
+    struct sched_cpu_stats *ustats = (void *)interface->arg1;
+    int count = interface->arg2;
+    struct sched_cpu_stats stats[CPU_COUNT];
+    int ret;
+
+    if (count <= 0)
+        return -EINVAL;
+
+    if (count > CPU_COUNT)
+        count = CPU_COUNT;
+
+    if (!as_is_mapped(thread_current()->parent->as, (vaddr_t)ustats,
+                      count * sizeof (struct sched_cpu_stats)))
+        return -EFAULT;
+
+    ret = cpu_stats_collect(stats, count);
+
+    memcpy(ustats, stats, ret * sizeof (struct sched_cpu_stats));
+
+    return ret;
+}
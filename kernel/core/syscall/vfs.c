@@ -1,3 +1,5 @@
+#include <string.h>
+
 #include <kernel/syscall.h>
 #include <kernel/errno.h>
 
@@ -8,6 +10,8 @@
 #include <kernel/fs/vfs.h>
 #include <kernel/fs/fiu.h>
 #include <kernel/fs/channel.h>
+#include <kernel/fs/poll.h>
+#include <kernel/fs/aio.h>
 
 #include <kernel/fs/vfs/mount.h>
 #include <kernel/fs/vfs/vops.h>
@@ -184,6 +188,33 @@ int sys_vfs_getdirent(struct syscall *interface)
     return vfs_getdirent(thread_current(), fd, dirent, index);
 }
 
+/* User interface is getdents(fd, buf, size, cookie, flags) */
+int sys_vfs_getdents(struct syscall *interface)
+{
+    int fd = interface->arg1;
+    void *buf = (void *)interface->arg2;
+    size_t size = interface->arg3;
+    uint32_t *ucookie = (void *)interface->arg4;
+    int flags = interface->arg5;
+    struct process *p = thread_current()->parent;
+    uint32_t cookie;
+    int ret;
+
+    if (!as_is_mapped(p->as, (vaddr_t)ucookie, sizeof (uint32_t)))
+        return -EFAULT;
+
+    if (!as_is_mapped(p->as, (vaddr_t)buf, size))
+        return -EFAULT;
+
+    cookie = *ucookie;
+
+    ret = vfs_getdents(thread_current(), fd, buf, size, &cookie, flags);
+    if (ret >= 0)
+        *ucookie = cookie;
+
+    return ret;
+}
+
 int sys_vfs_device_exists(struct syscall *interface)
 {
     char *device = (void *)interface->arg1;
@@ -246,6 +277,246 @@ int sys_fs_channel_open(struct syscall *interface)
     return fd;
 }
 
+/* User interface is channel_reply_wait(fd, reply, reply_size, buf, size) */
+int sys_fs_channel_reply_wait(struct syscall *interface)
+{
+    int fd = interface->arg1;
+    void *reply = (void *)interface->arg2;
+    size_t reply_size = interface->arg3;
+    void *buf = (void *)interface->arg4;
+    size_t size = interface->arg5;
+    struct process *p = thread_current()->parent;
+    struct file *file;
+    int ret;
+
+    if (reply_size && !as_is_mapped(p->as, (vaddr_t)reply, reply_size))
+        return -EFAULT;
+
+    if (!as_is_mapped(p->as, (vaddr_t)buf, size))
+        return -EFAULT;
+
+    ret = process_file_from_fd(p, fd, &file);
+    if (ret < 0)
+        return ret;
+
+    if (file->f_ops != &channel_master_f_ops)
+        return -EBADF;
+
+    return channel_master_reply_wait(file->private, reply, reply_size, buf,
+                                     size);
+}
+
+/*
+ * User interface is channel_reply_wait_batch(fd, replies, nreply, msgs, nmsg),
+ * the vectors are copied so that the buffers are only validated once
+ */
+int sys_fs_channel_reply_wait_batch(struct syscall *interface)
+{
+    int fd = interface->arg1;
+    struct channel_iovec *ureplies = (void *)interface->arg2;
+    int nreply = interface->arg3;
+    struct channel_iovec *umsgs = (void *)interface->arg4;
+    int nmsg = interface->arg5;
+    struct channel_iovec replies[CHANNEL_BATCH_MAX];
+    struct channel_iovec msgs[CHANNEL_BATCH_MAX];
+    struct process *p = thread_current()->parent;
+    struct file *file;
+    int ret;
+
+    if (nreply < 0 || nreply > CHANNEL_BATCH_MAX || nmsg <= 0 ||
+        nmsg > CHANNEL_BATCH_MAX)
+        return -EINVAL;
+
+    if (nreply && !as_is_mapped(p->as, (vaddr_t)ureplies,
+                                nreply * sizeof (struct channel_iovec)))
+        return -EFAULT;
+
+    if (!as_is_mapped(p->as, (vaddr_t)umsgs,
+                      nmsg * sizeof (struct channel_iovec)))
+        return -EFAULT;
+
+    memcpy(replies, ureplies, nreply * sizeof (struct channel_iovec));
+    memcpy(msgs, umsgs, nmsg * sizeof (struct channel_iovec));
+
+    for (int i = 0; i < nreply; ++i) {
+        if (!as_is_mapped(p->as, (vaddr_t)replies[i].buf, replies[i].size))
+            return -EFAULT;
+    }
+
+    for (int i = 0; i < nmsg; ++i) {
+        if (!as_is_mapped(p->as, (vaddr_t)msgs[i].buf, msgs[i].size))
+            return -EFAULT;
+    }
+
+    ret = process_file_from_fd(p, fd, &file);
+    if (ret < 0)
+        return ret;
+
+    if (file->f_ops != &channel_master_f_ops)
+        return -EBADF;
+
+    ret = channel_master_reply_wait_batch(file->private, replies, nreply,
+                                          msgs, nmsg);
+    if (ret < 0)
+        return ret;
+
+    for (int i = 0; i < ret; ++i)
+        umsgs[i].size = msgs[i].size;
+
+    return ret;
+}
+
+/* User interface is poll_create() */
+int sys_fs_poll_create(struct syscall *interface)
+{
+    int fd;
+    int err;
+    struct file *file;
+    struct process *p = thread_current()->parent;
+
+    (void) interface;
+
+    fd = process_new_fd(p);
+    if (fd < 0)
+        return fd;
+
+    file = &p->files[fd];
+
+    err = poll_create(file);
+    if (err < 0) {
+        process_free_fd(p, fd);
+        return err;
+    }
+
+    return fd;
+}
+
+/*
+ * The set is kept until poll_put(), a close of the descriptor by another
+ * thread meanwhile does not free it
+ */
+static int poll_from_fd(int fd, struct poll **poll)
+{
+    struct process *p = thread_current()->parent;
+    struct file *file;
+    int ret;
+
+    spinlock_lock(&p->files_lock);
+
+    ret = process_file_from_fd(p, fd, &file);
+    if (ret < 0)
+        goto end;
+
+    if (file->f_ops != &poll_f_ops) {
+        ret = -EBADF;
+        goto end;
+    }
+
+    *poll = file->private;
+
+    poll_get(*poll);
+
+end:
+    spinlock_unlock(&p->files_lock);
+
+    return ret;
+}
+
+/* User interface is poll_ctl(fd, op, type, id, event) */
+int sys_fs_poll_ctl(struct syscall *interface)
+{
+    int fd = interface->arg1;
+    int op = interface->arg2;
+    int type = interface->arg3;
+    int id = interface->arg4;
+    struct poll_event *uevent = (void *)interface->arg5;
+    struct process *p = thread_current()->parent;
+    struct poll_event event;
+    struct poll *poll;
+    int ret;
+
+    ret = poll_from_fd(fd, &poll);
+    if (ret < 0)
+        return ret;
+
+    if (op == POLL_ADD) {
+        if (!as_is_mapped(p->as, (vaddr_t)uevent, sizeof (event))) {
+            poll_put(poll);
+            return -EFAULT;
+        }
+
+        event = *uevent;
+    }
+
+    ret = poll_ctl(poll, op, type, id, &event);
+
+    poll_put(poll);
+
+    return ret;
+}
+
+/* User interface is poll_wait(fd, events, max, block) */
+int sys_fs_poll_wait(struct syscall *interface)
+{
+    int fd = interface->arg1;
+    struct poll_event *uevents = (void *)interface->arg2;
+    int max = interface->arg3;
+    int block = interface->arg4;
+    struct process *p = thread_current()->parent;
+    struct poll_event events[POLL_MAX_EVENTS];
+    struct poll *poll;
+    int ret;
+
+    if (max <= 0)
+        return -EINVAL;
+
+    if (max > POLL_MAX_EVENTS)
+        max = POLL_MAX_EVENTS;
+
+    if (!as_is_mapped(p->as, (vaddr_t)uevents, max * sizeof (*uevents)))
+        return -EFAULT;
+
+    ret = poll_from_fd(fd, &poll);
+    if (ret < 0)
+        return ret;
+
+    ret = poll_wait(poll, events, max, block);
+
+    poll_put(poll);
+
+    if (ret > 0)
+        memcpy(uevents, events, ret * sizeof (*uevents));
+
+    return ret;
+}
+
+int sys_fs_aio_setup(struct syscall *interface)
+{
+    int ret;
+    vaddr_t uaddr;
+    vaddr_t *ring = (void *)interface->arg1;
+    struct thread *t = thread_current();
+
+    if (!as_is_mapped(t->parent->as, (vaddr_t)ring, sizeof (vaddr_t)))
+        return -EFAULT;
+
+    ret = aio_setup(t, &uaddr);
+    if (ret < 0)
+        return ret;
+
+    *ring = uaddr;
+
+    return 0;
+}
+
+int sys_fs_aio_enter(struct syscall *interface)
+{
+    int to_submit = interface->arg1;
+    int min_complete = interface->arg2;
+
+    return aio_enter(thread_current(), to_submit, min_complete);
+}
+
 /* User interface is fs_register(name, channel_fd, ops) */
 int sys_fs_register(struct syscall *interface)
 {
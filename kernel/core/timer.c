@@ -31,6 +31,8 @@
 #include <kernel/cpu.h>
 #include <kernel/scheduler.h>
 
+#include <kernel/scheduler/trace.h>
+
 #include <kernel/mem/kmalloc.h>
 
 static struct timer_entry timers[TIMER_NUM];
@@ -54,10 +56,16 @@ void timer_handler(struct irq_regs *regs)
 
     ++ticks;
 
+    if (cpu->scheduler.running)
+        process_info_update(cpu->scheduler.running);
+
     klist_for_each(&cpu->timers, tlist, list) {
         timer = klist_elem(tlist, struct timer_entry, list);
 
         if (timer->next == ticks) {
+            sched_trace(SCHED_TRACE_TIMER, cpu->scheduler.running,
+                        timer - timers, timer->data);
+
             timer->callback(timer->data);
 
             if (timer->type & TIMER_PERIODIC)
@@ -69,6 +77,8 @@ void timer_handler(struct irq_regs *regs)
         }
     }
 
+    scheduler_tick(regs);
+
     scheduler_update(regs, 0);
 }
 
@@ -102,7 +112,7 @@ int timer_register(int type, tick_t time, timer_callback_t callback, long data)
     if (timer < 0) {
         spinlock_unlock(&timer_lock);
 
-        return -1;
+        return -EAGAIN;
     }
 
     timers[timer].free = 0;
@@ -117,5 +127,27 @@ int timer_register(int type, tick_t time, timer_callback_t callback, long data)
 
     klist_add(&cpu->timers, &timers[timer].list);
 
-    return 1;
+    return timer;
+}
+
+int timer_unregister(int timer, timer_callback_t callback, long data)
+{
+    if (timer < 0 || timer >= TIMER_NUM)
+        return -EINVAL;
+
+    spinlock_lock(&timer_lock);
+
+    if (timers[timer].free || timers[timer].callback != callback ||
+        timers[timer].data != data) {
+        spinlock_unlock(&timer_lock);
+
+        return -EINVAL;
+    }
+
+    klist_del(&timers[timer].list);
+    timers[timer].free = 1;
+
+    spinlock_unlock(&timer_lock);
+
+    return 0;
 }
@@ -1,17 +1,33 @@
+#include <kernel/config.h>
 #include <kernel/cpu.h>
 
 #include <glue/cpu.h>
 
 #include <arch/tss.h>
+#include <arch/fpu.h>
 
+#ifdef CONFIG_SYSCALL
+# include <arch/sysenter.h>
+#endif /* !CONFIG_SYSCALL */
+
+/*
+ * There is no local APIC support, hence no IPI: a remote cpu notices
+ * need_resched at its next timer tick
+ */
 struct cpu_glue cpu_glue_dispatcher =
 {
     i386_pc_cpu_initialize,
+    NULL,
 };
 
 int i386_pc_cpu_initialize(struct cpu *cpu)
 {
     tss_initialize(cpu);
+    fpu_initialize(cpu);
+
+#ifdef CONFIG_SYSCALL
+    sysenter_initialize(cpu);
+#endif /* !CONFIG_SYSCALL */
 
     return 1;
 }
@@ -1,3 +1,4 @@
+#include <kernel/config.h>
 #include <kernel/timer.h>
 #include <kernel/interrupt.h>
 #include <kernel/console.h>
@@ -6,6 +7,11 @@
 
 #include <arch/pit.h>
 #include <arch/pic.h>
+#include <arch/tsc.h>
+
+#ifdef CONFIG_PROCESS
+# include <kernel/proc/info.h>
+#endif /* !CONFIG_PROCESS */
 
 struct timer_glue timer_glue_dispatcher =
 {
@@ -15,6 +21,18 @@ struct timer_glue timer_glue_dispatcher =
 int i386_pc_timer_initialize(void)
 {
     int err;
+    uint32_t khz;
+    uint64_t base;
+
+    khz = tsc_calibrate(&base);
+    if (khz)
+        console_message(T_INF, "TSC frequency: %u kHz", khz);
+
+#ifdef CONFIG_PROCESS
+    if (khz)
+        process_info_clock_set(khz, tsc_mult(khz, PROCESS_INFO_CLOCK_SHIFT),
+                               base);
+#endif /* !CONFIG_PROCESS */
 
     pit_initialize();
 
@@ -0,0 +1,113 @@
+#!/usr/bin/env python3
+#
+# Convert the output of the schedtrace binary, as captured from the serial
+# console (make boot > boot.log), into a Chrome trace that can be loaded in
+# chrome://tracing or https://ui.perfetto.dev
+#
+# usage: scripts/schedtrace.py boot.log > trace.json
+
+import json
+import sys
+
+SWITCH_OUT = 1
+SWITCH_IN = 2
+BLOCK = 3
+WAKEUP = 4
+TIMER = 5
+IRQ_ENTRY = 6
+IRQ_EXIT = 7
+
+REASONS = ["timeslice", "preempt", "blocked", "exit", "yield"]
+
+
+def thread_name(pid, tid):
+    if pid < 0:
+        return "none"
+    return "%d:%d" % (pid, tid)
+
+
+def parse(lines):
+    khz = 0
+    tick_per_sec = 100
+    events = []
+
+    for line in lines:
+        if "schedtrace-clock:" in line:
+            fields = line.split("schedtrace-clock:")[1].split()
+            khz, tick_per_sec = int(fields[0]), int(fields[1])
+        elif "schedtrace:" in line:
+            fields = line.split("schedtrace:")[1].split()
+            if len(fields) != 7:
+                continue
+            events.append((int(fields[0], 16),) +
+                          tuple(int(f) for f in fields[1:]))
+
+    events.sort(key=lambda e: e[0])
+
+    # Timestamps in microseconds
+    if khz:
+        scale = 1000.0 / khz
+    else:
+        scale = 1000000.0 / tick_per_sec
+
+    return [(e[0] * scale,) + e[1:] for e in events]
+
+
+def convert(events):
+    out = []
+    running = {}
+    irqs = {}
+
+    for ts, cpu, type, pid, tid, arg0, arg1 in events:
+        common = {"pid": cpu, "tid": 0, "ts": ts}
+
+        if type == SWITCH_IN:
+            running[cpu] = (ts, pid, tid)
+        elif type == SWITCH_OUT and cpu in running:
+            start, rpid, rtid = running.pop(cpu)
+            out.append(dict(common, ph="X", ts=start, dur=ts - start,
+                            name=thread_name(rpid, rtid),
+                            args={"out": REASONS[arg0]
+                                  if arg0 < len(REASONS) else arg0}))
+        elif type == BLOCK:
+            out.append(dict(common, ph="i", s="t", name="block",
+                            args={"thread": thread_name(pid, tid),
+                                  "event": arg0, "data": arg1}))
+        elif type == WAKEUP:
+            out.append(dict(common, ph="i", s="t", name="wakeup",
+                            args={"thread": thread_name(pid, tid),
+                                  "waker": thread_name(arg0, arg1)}))
+        elif type == TIMER:
+            out.append(dict(common, ph="i", s="t", name="timer",
+                            args={"id": arg0, "data": arg1}))
+        elif type == IRQ_ENTRY:
+            irqs[cpu] = ts
+            out.append(dict(common, tid=1, ph="B", name="irq %d" % arg0))
+        elif type == IRQ_EXIT and cpu in irqs:
+            irqs.pop(cpu)
+            out.append(dict(common, tid=1, ph="E", name="irq %d" % arg0))
+
+    for cpu in set(e[1] for e in events):
+        out.append({"ph": "M", "pid": cpu, "name": "process_name",
+                    "args": {"name": "cpu %d" % cpu}})
+        out.append({"ph": "M", "pid": cpu, "tid": 0, "name": "thread_name",
+                    "args": {"name": "threads"}})
+        out.append({"ph": "M", "pid": cpu, "tid": 1, "name": "thread_name",
+                    "args": {"name": "interrupts"}})
+
+    return out
+
+
+def main():
+    if len(sys.argv) > 1:
+        with open(sys.argv[1], errors="replace") as f:
+            lines = f.readlines()
+    else:
+        lines = sys.stdin.readlines()
+
+    json.dump({"traceEvents": convert(parse(lines)),
+               "displayTimeUnit": "ns"}, sys.stdout)
+
+
+if __name__ == "__main__":
+    main()
@@ -14,19 +14,19 @@
 
 # define INIT_CONF_PATH "/etc/init_conf"
 
-int mount_devfs(void)
+static int mount_kernel_fs(const char *fs, const char *path)
 {
     int ret;
     struct stat s;
 
-    ret = stat("/dev", &s);
+    ret = stat(path, &s);
     if (ret < 0)
         return -1;
 
     if (!S_ISDIR(s.st_mode))
         return -1;
 
-    return mount("devfs", "", "/dev");
+    return mount(fs, "", path);
 }
 
 int main(void)
@@ -46,7 +46,7 @@ int main(void)
             usleep(500);
     } while (ret < 0);
 
-    ret = mount_devfs();
+    ret = mount_kernel_fs("devfs", "/dev");
     if (ret < 0) {
         uprint("Init: Failed to mount devfs");
         return 1;
@@ -54,6 +54,12 @@ int main(void)
 
     uprint("Init: devfs mounted with success on /dev");
 
+    /* The system can run without procfs, it is only used for inspection */
+    if (mount_kernel_fs("procfs", "/proc") < 0)
+        uprint("Init: Failed to mount procfs");
+    else
+        uprint("Init: procfs mounted with success on /proc");
+
     config = init_conf_create();
     if (!config) {
         uprint("Init: Not enough memory");
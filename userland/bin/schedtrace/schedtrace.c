@@ -0,0 +1,83 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <zos/info.h>
+#include <zos/print.h>
+#include <zos/sched.h>
+
+# define TRACE_DEVICE "/dev/schedtrace"
+# define TRACE_BATCH 64
+
+/*
+ * Drain the scheduler trace on the kernel console (the serial port under
+ * qemu), one line per event. scripts/schedtrace.py turns the log into a
+ * Chrome trace
+ */
+
+static struct sched_trace_event events[TRACE_BATCH];
+
+static char *put_hex(char *s, uint32_t v, int digits)
+{
+    static const char hex[] = "0123456789abcdef";
+
+    for (int i = digits - 1; i >= 0; --i)
+        *s++ = hex[(v >> (i * 4)) & 0xF];
+
+    return s;
+}
+
+static void print_event(const struct sched_trace_event *ev)
+{
+    char line[96];
+    char *s = line;
+
+    strcpy(s, "schedtrace: ");
+    s += strlen(s);
+
+    s = put_hex(s, ev->tsc >> 32, 8);
+    s = put_hex(s, ev->tsc, 8);
+
+    sprintf(s, " %d %d %d %d %d %d", ev->cpu, ev->type, ev->pid, ev->tid,
+            ev->arg0, ev->arg1);
+
+    uprint(line);
+}
+
+int main(void)
+{
+    char line[64];
+    int fd;
+    int ret;
+    int count = 0;
+
+    fd = open(TRACE_DEVICE, O_RDONLY, 0);
+    if (fd < 0) {
+        fprintf(stderr, "schedtrace: cannot open %s\n", TRACE_DEVICE);
+        return 1;
+    }
+
+    /* Timestamps are TSC cycles, or ticks if the frequency is 0 */
+    sprintf(line, "schedtrace-clock: %d %d", zos_info()->clock_khz,
+            zos_info()->tick_per_sec);
+    uprint(line);
+
+    while ((ret = read(fd, events, sizeof (events))) > 0) {
+        int n = ret / sizeof (struct sched_trace_event);
+
+        for (int i = 0; i < n; ++i)
+            print_event(&events[i]);
+
+        count += n;
+    }
+
+    uprint("schedtrace-end");
+
+    close(fd);
+
+    printf("schedtrace: %d events dumped on the console\n", count);
+
+    return 0;
+}
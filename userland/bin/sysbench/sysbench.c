@@ -0,0 +1,78 @@
+#include <stdio.h>
+#include <stdint.h>
+
+#include <arch/syscall.h>
+
+# define ITERATIONS 1000
+# define ROUNDS 20
+
+static uint32_t rdtsc(void)
+{
+    uint32_t low, high;
+
+    __asm__ __volatile__ ("rdtsc" : "=a" (low), "=d" (high));
+
+    return low;
+}
+
+/*
+ * Return the best average number of cycles of a getpid() over ROUNDS rounds
+ * of ITERATIONS calls
+ */
+static uint32_t bench_int(void)
+{
+    uint32_t best = 0xFFFFFFFF;
+
+    for (int r = 0; r < ROUNDS; ++r) {
+        uint32_t start = rdtsc();
+        uint32_t cycles;
+        int ret;
+
+        for (int i = 0; i < ITERATIONS; ++i)
+            SYSCALL0_INT(SYS_GETPID, ret);
+
+        (void)ret;
+
+        cycles = (rdtsc() - start) / ITERATIONS;
+        if (cycles < best)
+            best = cycles;
+    }
+
+    return best;
+}
+
+static uint32_t bench_sysenter(void)
+{
+    uint32_t best = 0xFFFFFFFF;
+
+    for (int r = 0; r < ROUNDS; ++r) {
+        uint32_t start = rdtsc();
+        uint32_t cycles;
+        int ret;
+
+        for (int i = 0; i < ITERATIONS; ++i)
+            SYSCALL0_SYSENTER(SYS_GETPID, ret);
+
+        (void)ret;
+
+        cycles = (rdtsc() - start) / ITERATIONS;
+        if (cycles < best)
+            best = cycles;
+    }
+
+    return best;
+}
+
+int main(void)
+{
+    printf("int $0x80: %u cycles per syscall\n", bench_int());
+
+    if (!__libc_sysenter) {
+        printf("sysenter: not supported by this cpu\n");
+        return 0;
+    }
+
+    printf("sysenter:  %u cycles per syscall\n", bench_sysenter());
+
+    return 0;
+}
@@ -0,0 +1,183 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <zos/sched.h>
+
+/* Maximum number of cpus shown */
+# define TOP_MAX_CPU 8
+
+struct snapshot {
+    int threads;
+    struct sched_thread_info info[SCHED_STATS_MAX];
+
+    int cpus;
+    struct sched_cpu_stats cpu[TOP_MAX_CPU];
+};
+
+static struct snapshot snapshots[2];
+
+/* Index of the threads of the current snapshot, sorted by cpu usage */
+static int order[SCHED_STATS_MAX];
+static uint32_t cpu_usage[SCHED_STATS_MAX];
+
+static void usage(void)
+{
+    fprintf(stderr, "top [ITERATIONS]\n");
+}
+
+static int take_snapshot(struct snapshot *s)
+{
+    s->threads = thread_stats(s->info, SCHED_STATS_MAX);
+    s->cpus = cpu_stats(s->cpu, TOP_MAX_CPU);
+
+    return s->threads < 0 || s->cpus < 0 ? -1 : 0;
+}
+
+static const struct sched_thread_info *
+find_thread(const struct snapshot *s, const struct sched_thread_info *t)
+{
+    for (int i = 0; i < s->threads; ++i) {
+        if (s->info[i].pid == t->pid && s->info[i].tid == t->tid)
+            return &s->info[i];
+    }
+
+    return NULL;
+}
+
+/*
+ * Print s right aligned in a field of width characters
+ */
+static void print_field(const char *s, int width)
+{
+    for (int len = strlen(s); len < width; ++len)
+        putchar(' ');
+
+    printf("%s", s);
+}
+
+static void print_int(int value, int width)
+{
+    char buf[16];
+
+    sprintf(buf, "%d", value);
+    print_field(buf, width);
+}
+
+static uint32_t percent(uint32_t part, uint32_t total)
+{
+    return total ? part * 100 / total : 0;
+}
+
+static void print_cpus(const struct snapshot *old, const struct snapshot *s)
+{
+    for (int i = 0; i < s->cpus; ++i) {
+        uint32_t user = s->cpu[i].user_ticks - old->cpu[i].user_ticks;
+        uint32_t kernel = s->cpu[i].kernel_ticks - old->cpu[i].kernel_ticks;
+        uint32_t idle = s->cpu[i].idle_ticks - old->cpu[i].idle_ticks;
+        uint32_t total = user + kernel + idle;
+
+        printf("cpu%d: %d%% user, %d%% system, %d%% idle, %d switches\n", i,
+               percent(user, total), percent(kernel, total),
+               percent(idle, total),
+               s->cpu[i].switches - old->cpu[i].switches);
+    }
+}
+
+static void print_threads(const struct snapshot *old, const struct snapshot *s,
+                          uint32_t total)
+{
+    static const char states[] = "?RBZ";
+
+    for (int i = 0; i < s->threads; ++i) {
+        const struct sched_thread_info *t = &s->info[i];
+        const struct sched_thread_info *prev = find_thread(old, t);
+        int j = i;
+
+        cpu_usage[i] = t->stats.user_ticks + t->stats.kernel_ticks;
+        if (prev)
+            cpu_usage[i] -= prev->stats.user_ticks + prev->stats.kernel_ticks;
+
+        /* Insertion sort, highest usage first */
+        for (; j > 0 && cpu_usage[order[j - 1]] < cpu_usage[i]; --j)
+            order[j] = order[j - 1];
+        order[j] = i;
+    }
+
+    printf("  PID  TID NAME             S CPU%%  USER   SYS  VCSW IVCSW\n");
+
+    for (int i = 0; i < s->threads; ++i) {
+        const struct sched_thread_info *t = &s->info[order[i]];
+        char state[2] = { states[t->state & 3], '\0' };
+
+        print_int(t->pid, 5);
+        print_int(t->tid, 5);
+        printf(" %s", t->name);
+        for (int len = strlen(t->name); len < SCHED_STATS_NAME_MAX; ++len)
+            putchar(' ');
+        printf(" %s", state);
+        print_int(percent(cpu_usage[order[i]], total), 5);
+        print_int(t->stats.user_ticks, 6);
+        print_int(t->stats.kernel_ticks, 6);
+        print_int(t->stats.voluntary, 6);
+        print_int(t->stats.involuntary, 6);
+        putchar('\n');
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    int iterations = 1;
+    int cur = 0;
+
+    if (argc > 2) {
+        usage();
+        return 1;
+    }
+
+    if (argc == 2) {
+        iterations = 0;
+
+        for (const char *s = argv[1]; *s; ++s) {
+            if (*s < '0' || *s > '9') {
+                usage();
+                return 1;
+            }
+
+            iterations = iterations * 10 + *s - '0';
+        }
+    }
+
+    if (take_snapshot(&snapshots[cur]) < 0) {
+        fprintf(stderr, "top: cannot read scheduler statistics\n");
+        return 1;
+    }
+
+    for (int n = 0; n < iterations; ++n) {
+        const struct snapshot *old = &snapshots[cur];
+        const struct snapshot *s;
+        uint32_t total = 0;
+
+        sleep(1);
+
+        cur = !cur;
+        if (take_snapshot(&snapshots[cur]) < 0)
+            return 1;
+
+        s = &snapshots[cur];
+
+        for (int i = 0; i < s->cpus; ++i)
+            total += (s->cpu[i].user_ticks - old->cpu[i].user_ticks) +
+                     (s->cpu[i].kernel_ticks - old->cpu[i].kernel_ticks) +
+                     (s->cpu[i].idle_ticks - old->cpu[i].idle_ticks);
+
+        print_cpus(old, s);
+        print_threads(old, s, total);
+
+        if (n + 1 < iterations)
+            putchar('\n');
+    }
+
+    return 0;
+}
@@ -3,6 +3,7 @@
 #include <fiu/fiu.h>
 
 #include "file.h"
+#include "fs.h"
 #include "inode_cache.h"
 
 # define MIN3(a, b, c) (a < b ? (a < c ? a : c) : (b < c ? b : c))
@@ -164,6 +165,98 @@ end:
     return ret;
 }
 
+/*
+ * The cookie is the offset of the next entry in the directory, each block is
+ * walked once however many calls the listing takes
+ */
+int ext2fs_getdents(struct fiu_instance *fi, struct req_getdents *req,
+                    uint32_t *cookie)
+{
+    int ret = 0;
+    int n = 0;
+    void *block = NULL;
+    uint32_t off = req->cookie;
+    uint32_t next;
+    uint32_t data_block;
+    size_t rec_size;
+    struct ext2fs *ext2 = (void *)fi->private;
+    struct ext2_inode *inode;
+    struct ext2_dirent *ext2_dir;
+    struct dirent_plus *rec;
+    struct req_stat stat_req;
+
+    if (req->flags & GETDENTS_STAT)
+        rec_size = sizeof (struct dirent_plus);
+    else
+        rec_size = sizeof (struct dirent);
+
+    inode = ext2_icache_request(ext2, req->inode);
+    if (!inode)
+        return -1;
+
+    stat_req.uid = req->uid;
+    stat_req.gid = req->gid;
+
+    while (n < req->count && off < inode->lower_size) {
+        if (!block) {
+            ret = inode_block_data(ext2, inode, off, &data_block);
+            if (ret < 0)
+                break;
+
+            block = fiu_cache_request(ext2->fi, data_block);
+            if (!block) {
+                ret = -1;
+                break;
+            }
+        }
+
+        ext2_dir = (void *)((uintptr_t)block + off % ext2->block_size);
+
+        /* A corrupted entry would make the walk loop forever */
+        if (ext2_dir->size < sizeof (struct ext2_dirent)) {
+            ret = -1;
+            break;
+        }
+
+        /* Entries of removed files are kept with a null inode */
+        if (ext2_dir->inode) {
+            rec = (void *)((char *)req->data + n * rec_size);
+
+            rec->d.d_ino = ext2_dir->inode;
+
+            memcpy(rec->d.d_name, ext2_dir + 1, ext2_dir->name_size_low);
+            rec->d.d_name[ext2_dir->name_size_low] = 0;
+
+            if (req->flags & GETDENTS_STAT) {
+                stat_req.inode = ext2_dir->inode;
+
+                if (ext2fs_stat(fi, &stat_req, &rec->st) < 0)
+                    memset(&rec->st, 0, sizeof (struct stat));
+            }
+
+            ++n;
+        }
+
+        next = off + ext2_dir->size;
+
+        if (next / ext2->block_size != off / ext2->block_size) {
+            fiu_cache_release(fi, data_block);
+            block = NULL;
+        }
+
+        off = next;
+    }
+
+    if (block)
+        fiu_cache_release(fi, data_block);
+
+    ext2_icache_release(ext2, req->inode);
+
+    *cookie = off;
+
+    return n ? n : ret;
+}
+
 int ext2fs_close(struct fiu_instance *fi, struct req_close *req)
 {
     (void)fi;
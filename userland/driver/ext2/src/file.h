@@ -22,6 +22,12 @@ int ext2fs_read(struct fiu_instance *fi, struct req_rdwr *req, size_t *size);
 int ext2fs_getdirent(struct fiu_instance *fi, struct req_getdirent *req,
                      struct dirent *dirent);
 
+/**
+ *  \brief  Perform a getdents(), the cookie is an offset in the directory
+ */
+int ext2fs_getdents(struct fiu_instance *fi, struct req_getdents *req,
+                    uint32_t *cookie);
+
 /**
  *  \brief  Perform a close()
  */
@@ -16,6 +16,7 @@ static struct fiu_ops ext2_ops = {
     .open = ext2fs_open,
     .read = ext2fs_read,
     .getdirent = ext2fs_getdirent,
+    .getdents = ext2fs_getdents,
     .close = ext2fs_close,
 };
 
@@ -27,6 +28,9 @@ struct fiu_fs ext2_fs = {
     .name = "ext2",
     .super_ops = &ext2_super_ops,
     .ops = &ext2_ops,
+    /* Read only, the inodes and the files never change */
+    .stat_lease = VFS_LEASE_INFINITE,
+    .cache_data = 1,
 };
 
 int main(int argc, char *argv[])
@@ -1,7 +1,7 @@
 #ifndef KBD_H
 # define KBD_H
 
-# include <sys/spinlock.h>
+# include <thread.h>
 
 # include <driver/driver.h>
 
@@ -12,7 +12,7 @@ struct kbd {
 
     struct req_rdwr req;
 
-    spinlock_t lock;
+    mutex_t lock;
 
     struct driver driver;
 };
@@ -7,6 +7,7 @@
 #include <zos/interrupt.h>
 #include <zos/device.h>
 #include <zos/print.h>
+#include <zos/sched.h>
 
 #include <buffer.h>
 
@@ -30,6 +31,10 @@ void interrupt_thread(int argc, void *argv[])
         return;
     }
 
+    /* Key presses must not wait behind cpu bound threads */
+    if (sched_setpolicy(SCHED_SELF, SCHED_FIFO, 50) < 0)
+        uprint("Unable to make the keyboard thread realtime");
+
     uprint("Keyboard driver is now ready to receive interrupts");
 
     for (;;) {
@@ -48,7 +53,7 @@ void interrupt_thread(int argc, void *argv[])
         if (event.code == KEY_RESERVED)
             continue;
 
-        spinlock_lock(&kbd->lock);
+        mutex_lock(&kbd->lock);
 
         buffer_push(&event);
 
@@ -69,6 +74,6 @@ void interrupt_thread(int argc, void *argv[])
             kbd->slave = -1;
         }
 
-        spinlock_unlock(&kbd->lock);
+        mutex_unlock(&kbd->lock);
     }
 }
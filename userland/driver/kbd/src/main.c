@@ -21,7 +21,7 @@ static int kbd_open(struct driver *driver, struct req_open *request,
 
     *inode = 0;
 
-    spinlock_init(&kbd->lock);
+    mutex_init(&kbd->lock);
 
     if (kbd->opened)
         /* XXX: EBUSY */
@@ -43,10 +43,10 @@ static int kbd_read(struct driver *driver, struct req_rdwr *msg,
     if (msg->size < sizeof (struct input_event))
         return -1;
 
-    spinlock_lock(&kbd->lock);
+    mutex_lock(&kbd->lock);
 
     if (kbd->slave >= 0) {
-        spinlock_unlock(&kbd->lock);
+        mutex_unlock(&kbd->lock);
         /* TODO: EIO */
         return -1;
     }
@@ -55,7 +55,7 @@ static int kbd_read(struct driver *driver, struct req_rdwr *msg,
         memcpy(&kbd->req, msg, sizeof (struct req_rdwr));
         kbd->slave = msg->hdr.slave_id;
 
-        spinlock_unlock(&kbd->lock);
+        mutex_unlock(&kbd->lock);
 
         return DRV_NORESPONSE;
     }
@@ -66,7 +66,7 @@ static int kbd_read(struct driver *driver, struct req_rdwr *msg,
 
     *size_read = sizeof (struct input_event);
 
-    spinlock_unlock(&kbd->lock);
+    mutex_unlock(&kbd->lock);
 
     return 0;
 }
@@ -95,7 +95,7 @@ int main(void)
 
     kbd.opened = 0;
     kbd.slave = -1;
-    spinlock_init(&kbd.lock);
+    mutex_init(&kbd.lock);
 
     if (driver_create("kbd", 0444, &kbd_ops, &kbd.driver) < 0)
     {
@@ -6,6 +6,7 @@
 
 #include <zos/print.h>
 #include <zos/device.h>
+#include <zos/poll.h>
 
 #include "tty.h"
 
@@ -62,7 +63,7 @@ static int tty_read(struct driver *driver, struct req_rdwr *req,
     int ret = 0;
     struct tty *tty = driver->private;
 
-    spinlock_lock(&tty->input.lock);
+    mutex_lock(&tty->input.lock);
 
     if (tty->req.slave_id >= 0) {
         /* TODO: EIO */
@@ -77,7 +78,7 @@ static int tty_read(struct driver *driver, struct req_rdwr *req,
         ret = DRV_NORESPONSE;
     }
 
-    spinlock_unlock(&tty->input.lock);
+    mutex_unlock(&tty->input.lock);
 
     return ret;
 }
@@ -102,53 +103,104 @@ static struct driver_ops tty_ops = {
     .write = tty_write,
 };
 
-static void tty_input_thread(int argc, void *argv[])
+/*
+ * Read what the tty controller has, it does not block since the controller
+ * announced it
+ */
+static void tty_input(struct tty *tty)
 {
-    (void)argc;
-
     int ret;
-    struct tty *tty = argv[0];
 
-    for (;;) {
-        if (tty->input.size == tty->input.max_size) {
-            char *tmp = realloc(tty->input.buffer, tty->input.max_size * 2);
+    if (tty->input.size == tty->input.max_size) {
+        char *tmp = realloc(tty->input.buffer, tty->input.max_size * 2);
 
-            if (!tmp)
-                continue;
+        if (!tmp)
+            return;
 
-            tty->input.buffer = tmp;
-            tty->input.max_size *= 2;
-        }
+        tty->input.buffer = tmp;
+        tty->input.max_size *= 2;
+    }
 
-        ret = read(tty->tty_ctrl_fd_r, tty->input.buffer + tty->input.size,
-                  tty->input.max_size - tty->input.size);
-        if (ret < 0)
-            continue;
+    ret = read(tty->tty_ctrl_fd_r, tty->input.buffer + tty->input.size,
+               tty->input.max_size - tty->input.size);
+    if (ret < 0)
+        return;
 
-        for (int i = 0; i < ret; ++i) {
-            if (tty->input.buffer[tty->input.size] == '\n')
-                ++tty->input.nb_line;
-        }
+    for (int i = 0; i < ret; ++i) {
+        if (tty->input.buffer[tty->input.size + i] == '\n')
+            ++tty->input.nb_line;
+    }
 
-        tty->input.size += ret;
+    tty->input.size += ret;
 
-        spinlock_lock(&tty->input.lock);
+    mutex_lock(&tty->input.lock);
 
-        if (tty->req.slave_id >= 0 && tty->input.nb_line > 0) {
-            struct resp_rdwr resp;
+    if (tty->req.slave_id >= 0 && tty->input.nb_line > 0) {
+        struct resp_rdwr resp;
 
-            resp.hdr.slave_id = tty->req.slave_id;
-            resp.ret = 0;
-            resp.size = tty_flush_buffer(tty, tty->req.req.data,
-                                         tty->req.req.size);
+        resp.hdr.slave_id = tty->req.slave_id;
+        resp.ret = 0;
+        resp.size = tty_flush_buffer(tty, tty->req.req.data,
+                                     tty->req.req.size);
 
-            write(tty->driver.channel_fd, &resp, sizeof (resp));
+        write(tty->driver.channel_fd, &resp, sizeof (resp));
 
-            tty->req.slave_id = -1;
-        }
+        tty->req.slave_id = -1;
+    }
+
+    mutex_unlock(&tty->input.lock);
+}
+
+/*
+ * A single thread serves the tty0 device and reads the tty controller, both
+ * are watched by a poll set
+ */
+static int tty_poll_loop(struct tty *tty)
+{
+    int fd;
+    int n;
+    struct poll_event event;
+    struct poll_event events[2];
+
+    fd = poll_create();
+    if (fd < 0)
+        return fd;
 
-        spinlock_unlock(&tty->input.lock);
+    event.events = POLLIN;
+    event.data = &tty->driver;
+
+    n = poll_ctl(fd, POLL_ADD, POLL_SRC_FD, tty->driver.channel_fd, &event);
+    if (n < 0)
+        goto end;
+
+    event.data = tty;
+
+    n = poll_ctl(fd, POLL_ADD, POLL_SRC_FD, tty->tty_ctrl_fd_r, &event);
+    if (n < 0)
+        goto end;
+
+    while (tty->driver.running) {
+        n = poll_wait(fd, events, 2, 1);
+        if (n < 0)
+            break;
+
+        for (int i = 0; i < n; ++i) {
+            if (events[i].events & POLLHUP) {
+                tty->driver.running = 0;
+                break;
+            }
+
+            if (events[i].data == tty)
+                tty_input(tty);
+            else
+                driver_handle(&tty->driver);
+        }
     }
+
+end:
+    close(fd);
+
+    return n < 0 ? n : 0;
 }
 
 int main(void)
@@ -188,7 +240,7 @@ int main(void)
 
     tty.req.slave_id = -1;
 
-    spinlock_init(&tty.input.lock);
+    mutex_init(&tty.input.lock);
 
     uprint("tty: Now attached to tty device");
 
@@ -198,15 +250,9 @@ int main(void)
         return 1;
     }
 
-    ret = thread_create(tty_input_thread, 1, &tty);
-    if (ret < 0) {
-        uprint("tty: Fail to spwan input thread");
-        return 1;
-    }
-
     uprint("tty: tty0 device is now ready");
 
     tty.driver.private = &tty;
 
-    return driver_loop(&tty.driver);
+    return tty_poll_loop(&tty) < 0;
 }
@@ -1,7 +1,7 @@
 #ifndef TTY_H
 # define TTY_H
 
-# include <sys/spinlock.h>
+# include <thread.h>
 
 # include <driver/driver.h>
 
@@ -23,7 +23,7 @@ struct tty {
         int max_size;
         int nb_line;
 
-        spinlock_t lock;
+        mutex_t lock;
     } input;
 
     struct driver driver;
@@ -2,6 +2,7 @@
 #include <string.h>
 
 #include <zos/print.h>
+#include <zos/poll.h>
 
 #include "tty_ctrl.h"
 
@@ -34,7 +35,7 @@ static int tty_ctrl_read(struct driver *driver, struct req_rdwr *req,
     int ret = 0;
     struct tty_ctrl *ctrl = driver->private;
 
-    spinlock_lock(&ctrl->input.lock);
+    mutex_lock(&ctrl->input.lock);
 
     if (ctrl->input.size) {
         *size = 0;
@@ -45,6 +46,9 @@ static int tty_ctrl_read(struct driver *driver, struct req_rdwr *req,
             --req->size;
             ++(*size);
         }
+
+        if (!ctrl->input.size)
+            driver_ready(driver, 0);
     } else if (ctrl->slaves[ctrl->nb_slave].slave_id >= 0) {
         /* TODO: EIO */
         ret = -1;
@@ -53,12 +57,10 @@ static int tty_ctrl_read(struct driver *driver, struct req_rdwr *req,
         memcpy(&ctrl->slaves[ctrl->nb_slave].req, req,
                sizeof (struct req_rdwr));
 
-        spinlock_unlock(&ctrl->input.lock);
-
         ret = DRV_NORESPONSE;
     }
 
-    spinlock_unlock(&ctrl->input.lock);
+    mutex_unlock(&ctrl->input.lock);
 
     return ret;
 }
@@ -100,6 +102,11 @@ int tty_ctrl_driver(struct tty_ctrl *ctrl)
 
     ctrl->driver.private = ctrl;
 
+    /* Keys may have been typed before the device existed */
+    mutex_lock(&ctrl->input.lock);
+    driver_ready(&ctrl->driver, ctrl->input.size ? POLLIN : 0);
+    mutex_unlock(&ctrl->input.lock);
+
     uprint("tty_ctrl: tty device is now ready");
 
     return driver_loop(&ctrl->driver);
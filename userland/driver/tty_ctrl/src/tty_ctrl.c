@@ -9,6 +9,7 @@
 #include <zos/input.h>
 #include <zos/print.h>
 #include <zos/device.h>
+#include <zos/poll.h>
 
 #include "tty_ctrl.h"
 #include "keymap.h"
@@ -29,6 +30,9 @@ struct tty_ctrl *tty_ctrl_create(void)
 
     ctrl->slaves = NULL;
 
+    /* The readiness is only announced once the device exists */
+    ctrl->driver.channel_fd = -1;
+
     return ctrl;
 }
 
@@ -138,11 +142,11 @@ char tty_ctrl_input_pop(struct tty_ctrl *ctrl)
 
 static void tty_ctrl_input_push(struct tty_ctrl *ctrl, char c)
 {
-    spinlock_lock(&ctrl->input.lock);
+    mutex_lock(&ctrl->input.lock);
 
     /* TODO: Remove oldest char and replace it by the new one */
     if (ctrl->input.size == TTY_INPUT_BUFFER_SIZE) {
-        spinlock_unlock(&ctrl->input.lock);
+        mutex_unlock(&ctrl->input.lock);
         return;
     }
 
@@ -153,7 +157,10 @@ static void tty_ctrl_input_push(struct tty_ctrl *ctrl, char c)
 
     ++ctrl->input.size;
 
-    spinlock_unlock(&ctrl->input.lock);
+    if (ctrl->input.size == 1)
+        driver_ready(&ctrl->driver, POLLIN);
+
+    mutex_unlock(&ctrl->input.lock);
 
     write(ctrl->video_fd, &c, 1);
 }
@@ -202,7 +209,7 @@ static void tty_ctrl_input_thread(int argc, void *argv[])
             }
         }
 
-        spinlock_lock(&ctrl->input.lock);
+        mutex_lock(&ctrl->input.lock);
 
         if (ctrl->slaves[ctrl->nb_slave].slave_id >= 0) {
             struct resp_rdwr resp;
@@ -222,9 +229,12 @@ static void tty_ctrl_input_thread(int argc, void *argv[])
             write(ctrl->driver.channel_fd, &resp, sizeof (resp));
 
             ctrl->slaves[ctrl->nb_slave].slave_id = -1;
+
+            if (!ctrl->input.size)
+                driver_ready(&ctrl->driver, 0);
         }
 
-        spinlock_unlock(&ctrl->input.lock);
+        mutex_unlock(&ctrl->input.lock);
     }
 }
 
@@ -237,7 +247,7 @@ static int init_input_thread(struct tty_ctrl *ctrl)
     ctrl->input.size = 0;
     ctrl->input.shift = 0;
     ctrl->input.ctrl = 0;
-    spinlock_init(&ctrl->input.lock);
+    mutex_init(&ctrl->input.lock);
 
     tid = thread_create(tty_ctrl_input_thread, 1, ctrl);
     if (tid < 0)
@@ -2,7 +2,7 @@
 # define TTY_CTRL_H
 
 # include <sys/types.h>
-# include <sys/spinlock.h>
+# include <thread.h>
 
 # include <driver/driver.h>
 
@@ -48,7 +48,7 @@ struct tty_ctrl {
         int shift;
         int ctrl;
 
-        spinlock_t lock;
+        mutex_t lock;
     } input;
 };
 
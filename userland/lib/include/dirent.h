@@ -1,28 +1,56 @@
 #ifndef LIBC_DIRENT_H
 # define LIBC_DIRENT_H
 
+# include <stdint.h>
+
 # include <sys/types.h>
+# include <sys/stat.h>
 
 # define NAME_MAX 256
 
 # define DIR_OK 1
 # define DIR_END 0
 
+/* Flag of getdents(), the entries are struct dirent_plus */
+# define GETDENTS_STAT (1 << 0)
+
+/* Number of entries read by readdir() per system call */
+# define DIR_BATCH 16
+
 struct dirent {
     ino_t d_ino;
 
     char d_name[NAME_MAX];
 };
 
+/* st.st_ino is 0 if the attributes of the entry could not be read */
+struct dirent_plus {
+    struct dirent d;
+    struct stat st;
+};
+
 typedef struct {
     int fd;
 
-    struct dirent dp;
+    /* Entries read and not returned yet */
+    struct dirent dp[DIR_BATCH];
+
+    int pos;
+    int count;
 
-    int index;
+    /* Where the next getdents() resumes */
+    uint32_t cookie;
 } DIR;
 
 int getdirent(int fd, struct dirent *d, int index);
+
+/*
+ * Read the entries of the directory fd from *cookie, 0 for the first one,
+ * in buf of size bytes. The entries are struct dirent_plus if flags has
+ * GETDENTS_STAT. *cookie is updated for the next call. Return the number of
+ * entries read, 0 at the end of the directory
+ */
+int getdents(int fd, void *buf, size_t size, uint32_t *cookie, int flags);
 DIR *opendir(const char *dirname);
 struct dirent *readdir(DIR *d);
 int closedir(DIR *d);
@@ -35,4 +35,17 @@ int driver_create(const char *dev_name, int perm, struct driver_ops *dev_ops,
 
 int driver_loop(struct driver *driver);
 
+/*
+ * Serve the requests queued on the channel of the driver and send their
+ * replies, for drivers that wait on a poll set with other sources rather
+ * than in driver_loop(). It only blocks if no request is queued
+ */
+int driver_handle(struct driver *driver);
+
+/*
+ * Announce the poll events of the device (POLLIN when a read would not
+ * block) to the processes polling it, until the next announce
+ */
+int driver_ready(struct driver *driver, uint32_t events);
+
 #endif /* !DRIVER_DRIVER_H */
@@ -3,7 +3,7 @@
 
 # include <stdint.h>
 
-# include <sys/spinlock.h>
+# include <thread.h>
 
 struct fiu_instance;
 
@@ -28,7 +28,7 @@ struct fiu_cache {
     struct fiu_block *blocks_head;
     struct fiu_block *blocks_tail;
 
-    spinlock_t cache_lock;
+    mutex_t cache_lock;
 
     cache_fetch_t fetch;
     cache_flush_t flush;
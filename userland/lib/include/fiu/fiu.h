@@ -19,6 +19,8 @@ struct fiu_ops {
     int (*read)(struct fiu_instance *, struct req_rdwr *, size_t *);
     int (*getdirent)(struct fiu_instance *, struct req_getdirent*,
                      struct dirent *);
+    int (*getdents)(struct fiu_instance *, struct req_getdents *,
+                    uint32_t *);
     int (*close)(struct fiu_instance *, struct req_close *);
 };
 
@@ -80,6 +82,19 @@ struct fiu_fs {
      *  \brief  Capabilities of the file system
      */
     vop_t cap;
+
+    /**
+     *  \brief  Milliseconds during which the kernel may reuse the result of
+     *          a stat, VFS_LEASE_INFINITE if the file system invalidates it
+     *          with fiu_invalidate() when an inode changes
+     */
+    uint32_t stat_lease;
+
+    /**
+     *  \brief  Set if the kernel may cache the content of the files, the
+     *          file system calls fiu_invalidate_data() when it changes
+     */
+    int cache_data;
 };
 
 struct fiu_fs_super_ops {
@@ -89,6 +104,32 @@ struct fiu_fs_super_ops {
 int fiu_slave_main(struct fiu_instance *fi, const char *device,
                    uint16_t slave_id);
 
+/**
+ *  \brief  Make the kernel forget the lookups, attributes and content it
+ *          cached for an instance
+ *
+ *  \param  fi      The instance
+ *  \param  inode   The inode that changed, its attributes, its content and
+ *                  the lookups resolving to it or going through it are
+ *                  forgotten with the failed ones. 0 forgets everything
+ *
+ *  \return 0: Everything went well
+ */
+int fiu_invalidate(struct fiu_instance *fi, ino_t inode);
+
+/**
+ *  \brief  Make the kernel forget the content of a file it cached
+ *
+ *  \param  fi      The instance
+ *  \param  inode   The file
+ *  \param  off     Offset of the first byte that changed
+ *  \param  size    Number of bytes that changed, 0 up to the end of the file
+ *
+ *  \return 0: Everything went well
+ */
+int fiu_invalidate_data(struct fiu_instance *fi, ino_t inode, uint64_t off,
+                        uint64_t size);
+
 /**
  *  \brief  Main function to operate a master file system
  *
@@ -36,58 +36,103 @@
 # define SYS_CHANNEL_OPEN 33
 # define SYS_FS_REGISTER 34
 # define SYS_FS_UNREGISTER 35
+# define SYS_FUTEX_WAIT 36
+# define SYS_FUTEX_WAKE 37
+# define SYS_LOCKSTAT_DUMP 38
+# define SYS_SCHED_SETATTR 39
+# define SYS_SCHED_GETATTR 40
+# define SYS_THREAD_STATS 41
+# define SYS_CPU_STATS 42
+# define SYS_CHANNEL_REPLY_WAIT 43
+# define SYS_CHANNEL_REPLY_WAIT_BATCH 44
+# define SYS_POLL_CREATE 45
+# define SYS_POLL_CTL 46
+# define SYS_POLL_WAIT 47
+# define SYS_AIO_SETUP 48
+# define SYS_AIO_ENTER 49
+# define SYS_GETDENTS 50
 
-# define SYSCALL0(num, ret)                                 \
+/* Set at startup when the cpu supports sysenter (see arch/i386/sysenter.c) */
+extern int __libc_sysenter;
+
+/*
+ * Legacy entry: software interrupt
+ */
+# define SYSCALL_ENTRY_INT                                  \
+                         "int $0x80\n"
+
+/*
+ * Fast entry: the kernel returns to the address in edi with the stack
+ * pointer in ebp, and clobbers ecx and edx (sysexit)
+ */
+# define SYSCALL_ENTRY_SYSENTER                             \
+                         "push %%ebp\n"                     \
+                         "mov %%esp, %%ebp\n"               \
+                         "mov $1f, %%edi\n"                 \
+                         "sysenter\n"                       \
+                         "1:\n"                             \
+                         "pop %%ebp\n"
+
+# define SYSCALL_ENTRY                                      \
+                         "cmpl $0, __libc_sysenter\n"       \
+                         "je 2f\n"                          \
+                         SYSCALL_ENTRY_SYSENTER             \
+                         "jmp 3f\n"                         \
+                         "2:\n"                             \
+                         SYSCALL_ENTRY_INT                  \
+                         "3:\n"
+
+# define __SYSCALL0(entry, num, ret)                        \
     __asm__ __volatile__("mov %1, %%eax\n"                  \
-                         "int $0x80\n"                      \
+                         entry                              \
                          "mov %%eax, %0\n"                  \
                          : "=r" (ret)                       \
                          : "i" (num)                        \
-                         : "memory");
+                         : "memory", "edi", "edx", "ecx");
 
-# define SYSCALL1(num, arg1, ret)                           \
+# define __SYSCALL1(entry, num, arg1, ret)                  \
     __asm__ __volatile__("mov %2, %%ebx\n"                  \
                          "mov %1, %%eax\n"                  \
-                         "int $0x80\n"                      \
+                         entry                              \
                          "mov %%eax, %0\n"                  \
                          : "=r" (ret)                       \
                          : "i" (num),                       \
                            "g" (arg1)                       \
-                         : "memory", "ebx");
+                         : "memory", "edi", "edx", "ecx", "ebx");
 
-# define SYSCALL2(num, arg1, arg2, ret)                     \
+# define __SYSCALL2(entry, num, arg1, arg2, ret)            \
     __asm__ __volatile__("mov %3, %%ecx\n"                  \
                          "mov %2, %%ebx\n"                  \
                          "mov %1, %%eax\n"                  \
-                         "int $0x80\n"                      \
+                         entry                              \
                          "mov %%eax, %0\n"                  \
                          : "=r" (ret)                       \
                          : "i" (num),                       \
                            "g" (arg1),                      \
                            "g" (arg2)                       \
-                         : "memory", "ecx", "ebx");
+                         : "memory", "edi", "edx", "ecx", "ebx");
 
-# define SYSCALL3(num, arg1, arg2, arg3, ret)               \
+# define __SYSCALL3(entry, num, arg1, arg2, arg3, ret)      \
     __asm__ __volatile__("mov %4, %%edx\n"                  \
                          "mov %3, %%ecx\n"                  \
                          "mov %2, %%ebx\n"                  \
                          "mov %1, %%eax\n"                  \
-                         "int $0x80\n"                      \
+                         entry                              \
                          "mov %%eax, %0\n"                  \
                          : "=r" (ret)                       \
                          : "i" (num),                       \
                            "g" (arg1),                      \
                            "g" (arg2),                      \
                            "g" (arg3)                       \
-                         : "memory", "edx", "ecx", "ebx");
+                         : "memory", "edi", "edx", "ecx", "ebx");
 
-# define SYSCALL4(num, arg1, arg2, arg3, arg4, ret)         \
+# define __SYSCALL4(entry, num, arg1, arg2, arg3, arg4, ret) \
     __asm__ __volatile__("mov %5, %%esi\n"                  \
                          "mov %4, %%edx\n"                  \
                          "mov %3, %%ecx\n"                  \
                          "mov %2, %%ebx\n"                  \
                          "mov %1, %%eax\n"                  \
-                         "int $0x80\n"                      \
+                         entry                              \
                          "mov %%eax, %0\n"                  \
                          : "=r" (ret)                       \
                          : "i" (num),                       \
@@ -95,8 +140,31 @@
                            "g" (arg2),                      \
                            "g" (arg3),                      \
                            "g" (arg4)                       \
-                         : "memory", "esi", "edx", "ecx", "ebx");
+                         : "memory", "edi", "esi", "edx", "ecx", "ebx");
+
+# define SYSCALL0(num, ret)                                 \
+    __SYSCALL0(SYSCALL_ENTRY, num, ret)
+
+# define SYSCALL1(num, arg1, ret)                           \
+    __SYSCALL1(SYSCALL_ENTRY, num, arg1, ret)
+
+# define SYSCALL2(num, arg1, arg2, ret)                     \
+    __SYSCALL2(SYSCALL_ENTRY, num, arg1, arg2, ret)
+
+# define SYSCALL3(num, arg1, arg2, arg3, ret)               \
+    __SYSCALL3(SYSCALL_ENTRY, num, arg1, arg2, arg3, ret)
+
+# define SYSCALL4(num, arg1, arg2, arg3, arg4, ret)         \
+    __SYSCALL4(SYSCALL_ENTRY, num, arg1, arg2, arg3, arg4, ret)
+
+/* Force one entry path, used to compare them */
+# define SYSCALL0_INT(num, ret)                             \
+    __SYSCALL0(SYSCALL_ENTRY_INT, num, ret)
+
+# define SYSCALL0_SYSENTER(num, ret)                        \
+    __SYSCALL0(SYSCALL_ENTRY_SYSENTER, num, ret)
 
+/* edi is needed for the fifth argument, always use the interrupt */
 # define SYSCALL5(num, arg1, arg2, arg3, arg4, arg5, ret)   \
     __asm__ __volatile__("mov %6, %%edi\n"                  \
                          "mov %5, %%esi\n"                  \
@@ -0,0 +1,45 @@
+#ifndef ARCH_I386_ATOMIC_H
+# define ARCH_I386_ATOMIC_H
+
+/*
+ * Store val in *ptr and return the previous value
+ */
+static inline int atomic_xchg(volatile int *ptr, int val)
+{
+    __asm__ __volatile__ ("lock xchg %0, %1\n"
+                          : "+r" (val), "+m" (*ptr)
+                          :
+                          : "memory");
+
+    return val;
+}
+
+/*
+ * Store new in *ptr if it contains old. Return the previous value
+ */
+static inline int atomic_cmpxchg(volatile int *ptr, int old, int new)
+{
+    int prev;
+
+    __asm__ __volatile__ ("lock cmpxchg %2, %1\n"
+                          : "=a" (prev), "+m" (*ptr)
+                          : "r" (new), "0" (old)
+                          : "memory");
+
+    return prev;
+}
+
+/*
+ * Add val to *ptr and return the previous value
+ */
+static inline int atomic_add(volatile int *ptr, int val)
+{
+    __asm__ __volatile__ ("lock xadd %0, %1\n"
+                          : "+r" (val), "+m" (*ptr)
+                          :
+                          : "memory");
+
+    return val;
+}
+
+#endif /* !ARCH_I386_ATOMIC_H */
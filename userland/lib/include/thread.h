@@ -1,9 +1,42 @@
 #ifndef LIBC_THREAD_H
 # define LIBC_THREAD_H
 
+# include <stdint.h>
+
 typedef void (*thread_callback_t)(int argc, void *argv[]);
 
 void thread_exit(void);
 int thread_create(thread_callback_t entry, int argc, ...);
 
+/*
+ * Mutex blocking in the kernel (futex) when it is contended
+ *
+ * state: 0 unlocked, 1 locked, 2 locked with (possible) waiters
+ */
+typedef struct {
+    volatile int state;
+} mutex_t;
+
+# define MUTEX_INIT { 0 }
+
+void mutex_init(mutex_t *mutex);
+void mutex_lock(mutex_t *mutex);
+int mutex_trylock(mutex_t *mutex);
+void mutex_unlock(mutex_t *mutex);
+
+/*
+ * Condition variable, the sequence number is bumped on every signal
+ */
+typedef struct {
+    volatile int seq;
+} cond_t;
+
+# define COND_INIT { 0 }
+
+void cond_init(cond_t *cond);
+void cond_wait(cond_t *cond, mutex_t *mutex);
+int cond_timedwait(cond_t *cond, mutex_t *mutex, size_t timeout);
+void cond_signal(cond_t *cond);
+void cond_broadcast(cond_t *cond);
+
 #endif /* !LIBC_THREAD_H */
@@ -0,0 +1,92 @@
+#ifndef LIBC_ZOS_AIO_H
+# define LIBC_ZOS_AIO_H
+
+# include <stdint.h>
+
+# include <sys/types.h>
+
+/* Operations, they take the same arguments as their synchronous version */
+# define AIO_OP_NOP 0
+# define AIO_OP_OPEN 1
+# define AIO_OP_CLOSE 2
+# define AIO_OP_READ 3
+# define AIO_OP_WRITE 4
+# define AIO_OP_STAT 5
+# define AIO_OP_FSTAT 6
+# define AIO_OP_GETDIRENT 7
+
+# define AIO_SQ_ENTRIES 64
+# define AIO_CQ_ENTRIES 128
+
+struct aio_sqe {
+    int op;
+
+    int fd;
+
+    const char *path;
+
+    void *buf;
+
+    size_t size;
+
+    /* Open flags, or index of the entry for AIO_OP_GETDIRENT */
+    int flags;
+
+    mode_t mode;
+
+    /* Given back untouched in the completion */
+    void *data;
+};
+
+struct aio_cqe {
+    void *data;
+
+    /* What the operation returned */
+    int res;
+};
+
+/*
+ * Memory shared with the kernel. The indexes are free running, the entry of
+ * an index i is at i % ENTRIES. The process owns sq_tail and cq_head, the
+ * kernel owns sq_head and cq_tail
+ */
+struct aio_ring {
+    volatile uint32_t sq_head;
+    volatile uint32_t sq_tail;
+    volatile uint32_t cq_head;
+    volatile uint32_t cq_tail;
+
+    struct aio_sqe sq[AIO_SQ_ENTRIES];
+
+    struct aio_cqe cq[AIO_CQ_ENTRIES];
+};
+
+/*
+ * Create the rings of the process and start the kernel threads that execute
+ * its requests. A process has at most one set of rings
+ */
+int aio_setup(struct aio_ring **ring);
+
+/*
+ * Submit up to to_submit queued entries, then wait until min_complete
+ * completions are available or nothing is in flight anymore. Return the
+ * number of entries submitted, fewer are taken when the completion queue
+ * could overflow. Requests in flight are not ordered, even on the same fd
+ */
+int aio_enter(int to_submit, int min_complete);
+
+/*
+ * Next free submission entry, NULL if the queue is full. It is only given to
+ * the kernel by aio_sqe_push()
+ */
+struct aio_sqe *aio_sqe_get(struct aio_ring *ring);
+void aio_sqe_push(struct aio_ring *ring);
+
+/*
+ * Oldest completion, NULL if there is none. It stays valid until
+ * aio_cqe_pop() is called
+ */
+struct aio_cqe *aio_cqe_get(struct aio_ring *ring);
+void aio_cqe_pop(struct aio_ring *ring);
+
+#endif /* !LIBC_ZOS_AIO_H */
@@ -0,0 +1,22 @@
+#ifndef LIBC_ZOS_FUTEX_H
+# define LIBC_ZOS_FUTEX_H
+
+# include <stdint.h>
+
+/* Returned by futex_wait() when the word does not contain the value */
+# define FUTEX_EAGAIN (-11)
+
+/* Returned by futex_wait() when the timeout expired */
+# define FUTEX_ETIMEDOUT (-110)
+
+/*
+ * Block while *addr == val, at most timeout milliseconds (0: no timeout)
+ */
+int futex_wait(volatile int *addr, int val, size_t timeout);
+
+/*
+ * Wake up to count threads blocked on addr, return the number woken up
+ */
+int futex_wake(volatile int *addr, int count);
+
+#endif /* !LIBC_ZOS_FUTEX_H */
@@ -0,0 +1,44 @@
+#ifndef LIBC_ZOS_INFO_H
+# define LIBC_ZOS_INFO_H
+
+# include <stdint.h>
+
+/* Address of the read-only information page mapped by the kernel */
+# define ZOS_INFO_ADDR 0xBFFFF000
+
+/*
+ * Must be kept in sync with struct process_info of the kernel
+ */
+struct zos_info {
+    int32_t pid;
+    int32_t tid;
+    uint32_t ticks;
+    uint32_t tick_per_sec;
+    uint32_t clock_khz;
+    uint32_t clock_mult;
+    uint32_t clock_shift;
+    uint64_t clock_base;
+};
+
+static inline const volatile struct zos_info *zos_info(void)
+{
+    return (const volatile struct zos_info *)ZOS_INFO_ADDR;
+}
+
+/*
+ * Return the number of ticks since boot, without entering the kernel
+ */
+uint32_t ticks_get(void);
+
+/*
+ * Return the number of ticks per second
+ */
+uint32_t ticks_per_sec(void);
+
+/*
+ * Return a monotonic clock in nanoseconds. It relies on the cycle counter
+ * when the kernel calibrated one, and on the tick counter otherwise
+ */
+uint64_t clock_monotonic_ns(void);
+
+#endif /* !LIBC_ZOS_INFO_H */
@@ -0,0 +1,53 @@
+#ifndef LIBC_ZOS_POLL_H
+# define LIBC_ZOS_POLL_H
+
+# include <stdint.h>
+
+/* Operations of poll_ctl() */
+# define POLL_ADD 1
+# define POLL_DEL 2
+
+/*
+ * The source is a master or a slave channel fd, or a device fd whose driver
+ * announces its readiness with driver_ready()
+ */
+# define POLL_SRC_FD 0
+
+/* The source is an irq registered by the calling thread */
+# define POLL_SRC_IRQ 1
+
+/* A message can be read, the device has data, or the irq fired */
+# define POLLIN (1 << 0)
+
+/* The source is gone */
+# define POLLHUP (1 << 1)
+
+/* Report a source once per notification instead of as long as it is ready */
+# define POLLET (1 << 31)
+
+/* Maximum number of events returned by poll_wait() */
+# define POLL_MAX_EVENTS 32
+
+struct poll_event {
+    uint32_t events;
+    void *data;
+};
+
+/*
+ * Create a set of watched sources, return its fd
+ */
+int poll_create(void);
+
+/*
+ * Add (POLL_ADD) or remove (POLL_DEL) a source of the set. id is a fd or an
+ * irq number depending on type, event is only used by POLL_ADD
+ */
+int poll_ctl(int fd, int op, int type, int id, struct poll_event *event);
+
+/*
+ * Fill events with up to max ready sources of the set. Wait for one if none
+ * is ready and block is set. Return the number of events filled
+ */
+int poll_wait(int fd, struct poll_event *events, int max, int block);
+
+#endif /* !LIBC_ZOS_POLL_H */
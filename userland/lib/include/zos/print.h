@@ -3,4 +3,10 @@
 
 void uprint(const char *s);
 
+/*
+ * Print the kernel lock statistics on the kernel console. Return -38
+ * (ENOSYS) if the kernel was built without CONFIG_SPINLOCK_STAT
+ */
+int lockstat_dump(void);
+
 #endif /* !ZOS_PRINT_H */
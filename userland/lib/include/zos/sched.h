@@ -0,0 +1,129 @@
+#ifndef LIBC_ZOS_SCHED_H
+# define LIBC_ZOS_SCHED_H
+
+# include <stdint.h>
+
+/* Time shared thread */
+# define SCHED_NORMAL 0
+
+/* Time shared thread that favours throughput: longer slices, no preemption */
+# define SCHED_BATCH 1
+
+/* Realtime thread, runs until it blocks or a higher priority one is ready */
+# define SCHED_FIFO 2
+
+# define SCHED_NICE_MIN (-20)
+# define SCHED_NICE_MAX 19
+
+# define SCHED_RT_PRIO_MIN 1
+# define SCHED_RT_PRIO_MAX 99
+
+/* Every cpu, bit n of an affinity mask stands for the cpu n */
+# define SCHED_AFFINITY_ALL 0xFFFFFFFF
+
+/* Designates the calling thread */
+# define SCHED_SELF (-1)
+
+struct sched_attr {
+    int policy;
+    int nice;
+    int rt_priority;
+    uint32_t affinity;
+};
+
+/*
+ * Set the scheduling attributes of the thread tid of the calling process.
+ * Lowering the nice value or entering SCHED_FIFO requires root
+ */
+int sched_setattr(int tid, const struct sched_attr *attr);
+
+/*
+ * Get the scheduling attributes of the thread tid of the calling process
+ */
+int sched_getattr(int tid, struct sched_attr *attr);
+
+/*
+ * Helpers changing a single attribute of the thread tid
+ */
+int sched_setnice(int tid, int nice);
+int sched_getnice(int tid);
+int sched_setpolicy(int tid, int policy, int rt_priority);
+int sched_setaffinity(int tid, uint32_t affinity);
+int sched_getaffinity(int tid, uint32_t *affinity);
+
+/* Scheduler events read from /dev/schedtrace */
+# define SCHED_TRACE_SWITCH_OUT 1
+# define SCHED_TRACE_SWITCH_IN 2
+# define SCHED_TRACE_BLOCK 3
+# define SCHED_TRACE_WAKEUP 4
+# define SCHED_TRACE_TIMER 5
+# define SCHED_TRACE_IRQ_ENTRY 6
+# define SCHED_TRACE_IRQ_EXIT 7
+
+/* Reasons of a context switch */
+# define SCHED_TRACE_TIMESLICE 0
+# define SCHED_TRACE_PREEMPT 1
+# define SCHED_TRACE_BLOCKED 2
+# define SCHED_TRACE_EXIT 3
+# define SCHED_TRACE_YIELD 4
+
+struct sched_trace_event {
+    uint64_t tsc;
+    uint16_t type;
+    uint16_t cpu;
+    int32_t pid;
+    int32_t tid;
+    int32_t arg0;
+    int32_t arg1;
+};
+
+# define SCHED_STATS_NAME_MAX 16
+
+/* Maximum number of entries returned by one thread_stats() call */
+# define SCHED_STATS_MAX 256
+
+/* Thread states */
+# define SCHED_THREAD_RUNNING 1
+# define SCHED_THREAD_BLOCKED 2
+# define SCHED_THREAD_ZOMBIE 3
+
+/* Times are in timer ticks, see ticks_per_sec() */
+struct sched_thread_stats {
+    uint32_t user_ticks;
+    uint32_t kernel_ticks;
+    uint32_t switches;
+    uint32_t voluntary;
+    uint32_t involuntary;
+};
+
+struct sched_cpu_stats {
+    uint32_t user_ticks;
+    uint32_t kernel_ticks;
+    uint32_t idle_ticks;
+    uint32_t switches;
+};
+
+struct sched_thread_info {
+    int32_t pid;
+    int32_t tid;
+    int32_t state;
+    int32_t cpu;
+    int32_t policy;
+    int32_t nice;
+    char name[SCHED_STATS_NAME_MAX];
+    struct sched_thread_stats stats;
+};
+
+/*
+ * Fill info with the statistics of at most count threads of the system,
+ * return the number of entries filled
+ */
+int thread_stats(struct sched_thread_info *info, int count);
+
+/*
+ * Fill stats with the statistics of at most count cpus, return the number
+ * of entries filled
+ */
+int cpu_stats(struct sched_cpu_stats *stats, int count);
+
+#endif /* !LIBC_ZOS_SCHED_H */
@@ -20,6 +20,10 @@
 # define VFS_IOCTL 11
 # define VFS_GETDIRENT 12
 # define VFS_FS_CREATE 13
+# define VFS_INVALIDATE 14
+# define VFS_INVALIDATE_DATA 15
+# define VFS_GETDENTS 16
+# define VFS_READY 17
 
 # define VFS_OPS_OPEN (1 << 0)
 # define VFS_OPS_READ (1 << 1)
@@ -34,6 +38,9 @@
 # define VFS_OPS_IOCTL (1 << 10)
 # define VFS_OPS_GETDIRENT (1 << 11)
 # define VFS_OPS_FS_CREATE (1 << 12)
+# define VFS_OPS_RING (1 << 13)
+# define VFS_OPS_CACHE (1 << 14)
+# define VFS_OPS_GETDENTS (1 << 15)
 
 struct msg_header {
     uint16_t op;
@@ -104,6 +111,9 @@ struct req_stat {
     gid_t gid;
 };
 
+/* Lease of attributes valid until the file system invalidates them */
+# define VFS_LEASE_INFINITE 0xffffffff
+
 /* Stat response */
 struct resp_stat {
     struct msg_header hdr;
@@ -111,6 +121,9 @@ struct resp_stat {
     int ret;
 
     struct stat stat;
+
+    /* Milliseconds during which the kernel may reuse the attributes */
+    uint32_t lease;
 };
 
 /* Open request */
@@ -211,6 +224,39 @@ struct resp_getdirent {
     struct dirent dirent;
 };
 
+/*
+ * Getdents request, at most count entries from cookie are written in data, as
+ * struct dirent_plus if flags has GETDENTS_STAT
+ */
+struct req_getdents {
+    struct msg_header hdr;
+
+    ino_t inode;
+
+    uid_t uid;
+    gid_t gid;
+
+    uint32_t cookie;
+
+    int count;
+
+    int flags;
+
+    void *data;
+};
+
+/* Getdents response, ret is the number of entries, 0 at the end */
+struct resp_getdents {
+    struct msg_header hdr;
+
+    int ret;
+
+    uint32_t cookie;
+
+    /* Milliseconds during which the kernel may reuse the attributes */
+    uint32_t lease;
+};
+
 /* Mount request */
 struct req_mount {
     struct msg_header hdr;
@@ -227,11 +273,67 @@ struct resp_mount {
     int ret;
 };
 
+/* Messages of a master to this slave id are handled by the kernel */
+# define CHANNEL_CONTROL_ID 0xffff
+
+/* Invalidation of the lookups, attributes and content of inode, 0 for all */
+struct req_invalidate {
+    struct msg_header hdr;
+
+    ino_t inode;
+};
+
+/* Invalidation of size bytes of inode from off, up to the end if size is 0 */
+struct req_invalidate_data {
+    struct msg_header hdr;
+
+    ino_t inode;
+
+    uint64_t off;
+
+    uint64_t size;
+};
+
+/* Readiness of a device, sent by its driver to CHANNEL_CONTROL_ID */
+struct req_ready {
+    struct msg_header hdr;
+
+    uint32_t events;
+};
+
 int open_device(const char *device_name, int flags, mode_t mode);
 
 int channel_create(const char *c_name);
 int channel_open(const char *c_name);
 
+/*
+ * Send the reply of the previous request (nothing if reply_size is 0), then
+ * wait for the next request on the master channel fd. A kernel client waiting
+ * for the reply runs right away. Return the size of the request read in buf
+ */
+int channel_reply_wait(int fd, const void *reply, size_t reply_size,
+                       void *buf, size_t size);
+
+/* Maximum number of messages of a batch */
+# define CHANNEL_BATCH_MAX 16
+
+/**
+ *  \brief  See the structure that is in the kernel
+ */
+struct channel_iovec {
+    void *buf;
+    size_t size;
+};
+
+/*
+ * Send nreply replies, then wait for requests on the master channel fd and
+ * read all those already queued, one per entry of msgs, up to nmsg. The size
+ * of each entry is updated with the size of the request read. Return the
+ * number of requests read
+ */
+int channel_reply_wait_batch(int fd, const struct channel_iovec *replies,
+                             int nreply, struct channel_iovec *msgs, int nmsg);
+
 int fs_register(const char *fs_name, int channel_fd, vop_t ops);
 int fs_unregister(const char *fs_name);
 
@@ -0,0 +1,30 @@
+#include <zos/info.h>
+
+static inline uint64_t rdtsc(void)
+{
+    uint32_t lo, hi;
+
+    __asm__ __volatile__ ("rdtsc" : "=a"(lo), "=d"(hi));
+
+    return ((uint64_t)hi << 32) | lo;
+}
+
+uint64_t clock_monotonic_ns(void)
+{
+    const volatile struct zos_info *info = zos_info();
+    uint32_t mult = info->clock_mult;
+    uint32_t shift = info->clock_shift;
+    uint64_t cycles;
+    uint32_t lo, hi;
+
+    if (!mult)
+        return (uint64_t)info->ticks * (1000000000 / info->tick_per_sec);
+
+    cycles = rdtsc() - info->clock_base;
+    lo = cycles;
+    hi = cycles >> 32;
+
+    /* Split the product to stay in 64 bits and avoid 64 bits divisions */
+    return (((uint64_t)lo * mult) >> shift) +
+           (((uint64_t)hi * mult) << (32 - shift));
+}
@@ -0,0 +1,32 @@
+#include <stdint.h>
+
+#include "../init.h"
+
+# define CPUID_EDX_SEP (1 << 11)
+
+int __libc_sysenter = 0;
+
+static int sysenter_supported(void)
+{
+    uint32_t eax, ebx, ecx, edx;
+    uint32_t family, model, stepping;
+
+    __asm__ __volatile__ ("cpuid"
+                          : "=a" (eax), "=b" (ebx), "=c" (ecx), "=d" (edx)
+                          : "a" (1));
+
+    if (!(edx & CPUID_EDX_SEP))
+        return 0;
+
+    /* Early Pentium Pro advertise SEP without implementing it */
+    family = (eax >> 8) & 0xF;
+    model = (eax >> 4) & 0xF;
+    stepping = eax & 0xF;
+
+    return !(family == 6 && model < 3 && stepping < 3);
+}
+
+void __libc_arch_init(void)
+{
+    __libc_sysenter = sysenter_supported();
+}
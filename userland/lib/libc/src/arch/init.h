@@ -0,0 +1,9 @@
+#ifndef ARCH_INIT_H
+# define ARCH_INIT_H
+
+/*
+ * Architecture dependent initialization, called before any system call
+ */
+void __libc_arch_init(void);
+
+#endif /* !ARCH_INIT_H */
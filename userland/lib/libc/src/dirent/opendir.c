@@ -26,7 +26,9 @@ DIR *opendir(const char *dirname)
     if (!S_ISDIR(s.st_mode))
         goto error_stat;
 
-    d->index = 0;
+    d->pos = 0;
+    d->count = 0;
+    d->cookie = 0;
 
     return d;
 
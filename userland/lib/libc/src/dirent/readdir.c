@@ -8,12 +8,15 @@ struct dirent *readdir(DIR *d)
     if (!d)
         return NULL;
 
-    ret = getdirent(d->fd, &d->dp, d->index);
+    if (d->pos == d->count) {
+        ret = getdents(d->fd, d->dp, sizeof (d->dp), &d->cookie, 0);
 
-    if (ret < 0 || ret == DIR_END)
-        return NULL;
+        if (ret <= 0)
+            return NULL;
 
-    ++d->index;
+        d->pos = 0;
+        d->count = ret;
+    }
 
-    return &d->dp;
+    return &d->dp[d->pos++];
 }
@@ -3,9 +3,12 @@
 
 #include "stdio/iobuffer.h"
 #include "stdlib/init.h"
+#include "arch/init.h"
 
 int __libc_init(void)
 {
+    __libc_arch_init();
+
     if (malloc_initialize() < 0)
         return -1;
 
@@ -2,7 +2,7 @@
 #include <string.h>
 
 #include <sys/mman.h>
-#include <sys/spinlock.h>
+#include <thread.h>
 
 #define PAGE_SIZE 4096
 #define MALLOC_WASTE_THRESHOLD 4
@@ -19,7 +19,7 @@ struct malloc_chunk {
 };
 
 static struct malloc_chunk *chunks;
-static spinlock_t malloc_lock;
+static mutex_t malloc_lock;
 
 static struct malloc_chunk *request_memory(size_t size)
 {
@@ -66,7 +66,7 @@ int malloc_initialize(void)
     if (!(chunks = request_memory(PAGE_SIZE)))
         return -1;
 
-    spinlock_init(&malloc_lock);
+    mutex_init(&malloc_lock);
 
     return 0;
 }
@@ -80,7 +80,7 @@ void *malloc(size_t size)
 
     size = ALIGN_UP(size, sizeof (char *));
 
-    spinlock_lock(&malloc_lock);
+    mutex_lock(&malloc_lock);
 
     tmp = chunks;
 
@@ -90,7 +90,7 @@ void *malloc(size_t size)
         {
             malloc_split_block(tmp, size);
 
-            spinlock_unlock(&malloc_lock);
+            mutex_unlock(&malloc_lock);
 
             return tmp + 1;
         }
@@ -98,13 +98,13 @@ void *malloc(size_t size)
         tmp = tmp->next;
     }
 
-    spinlock_unlock(&malloc_lock);
+    mutex_unlock(&malloc_lock);
 
     /* We need a new allocation */
     if (!(tmp = request_memory(size)))
         return NULL;
 
-    spinlock_lock(&malloc_lock);
+    mutex_lock(&malloc_lock);
 
     tmp->next = chunks;
     chunks->prev = tmp;
@@ -113,7 +113,7 @@ void *malloc(size_t size)
 
     malloc_split_block(chunks, size);
 
-    spinlock_unlock(&malloc_lock);
+    mutex_unlock(&malloc_lock);
 
     return chunks + 1;
 }
@@ -150,9 +150,9 @@ void free(void *ptr)
 
     tmp = (void *)((char *)ptr - sizeof (struct malloc_chunk));
 
-    spinlock_lock(&malloc_lock);
+    mutex_lock(&malloc_lock);
 
     tmp->free = 1;
 
-    spinlock_unlock(&malloc_lock);
+    mutex_unlock(&malloc_lock);
 }
@@ -0,0 +1,12 @@
+#include <zos/aio.h>
+
+#include <arch/syscall.h>
+
+int aio_enter(int to_submit, int min_complete)
+{
+    int ret;
+
+    SYSCALL2(SYS_AIO_ENTER, to_submit, min_complete, ret);
+
+    return ret;
+}
@@ -0,0 +1,38 @@
+#include <stdlib.h>
+
+#include <zos/aio.h>
+
+/* The entries must be written or read before the index is updated */
+#define aio_barrier() __asm__ __volatile__("" : : : "memory")
+
+struct aio_sqe *aio_sqe_get(struct aio_ring *ring)
+{
+    if (ring->sq_tail - ring->sq_head >= AIO_SQ_ENTRIES)
+        return NULL;
+
+    return &ring->sq[ring->sq_tail & (AIO_SQ_ENTRIES - 1)];
+}
+
+void aio_sqe_push(struct aio_ring *ring)
+{
+    aio_barrier();
+
+    ++ring->sq_tail;
+}
+
+struct aio_cqe *aio_cqe_get(struct aio_ring *ring)
+{
+    if (ring->cq_head == ring->cq_tail)
+        return NULL;
+
+    aio_barrier();
+
+    return &ring->cq[ring->cq_head & (AIO_CQ_ENTRIES - 1)];
+}
+
+void aio_cqe_pop(struct aio_ring *ring)
+{
+    aio_barrier();
+
+    ++ring->cq_head;
+}
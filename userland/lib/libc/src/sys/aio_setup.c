@@ -0,0 +1,12 @@
+#include <zos/aio.h>
+
+#include <arch/syscall.h>
+
+int aio_setup(struct aio_ring **ring)
+{
+    int ret;
+
+    SYSCALL1(SYS_AIO_SETUP, ring, ret);
+
+    return ret;
+}
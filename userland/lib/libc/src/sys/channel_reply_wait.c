@@ -0,0 +1,13 @@
+#include <zos/vfs.h>
+
+#include <arch/syscall.h>
+
+int channel_reply_wait(int fd, const void *reply, size_t reply_size,
+                       void *buf, size_t size)
+{
+    int ret;
+
+    SYSCALL5(SYS_CHANNEL_REPLY_WAIT, fd, reply, reply_size, buf, size, ret);
+
+    return ret;
+}
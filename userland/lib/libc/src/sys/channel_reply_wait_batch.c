@@ -0,0 +1,14 @@
+#include <zos/vfs.h>
+
+#include <arch/syscall.h>
+
+int channel_reply_wait_batch(int fd, const struct channel_iovec *replies,
+                             int nreply, struct channel_iovec *msgs, int nmsg)
+{
+    int ret;
+
+    SYSCALL5(SYS_CHANNEL_REPLY_WAIT_BATCH, fd, replies, nreply, msgs, nmsg,
+             ret);
+
+    return ret;
+}
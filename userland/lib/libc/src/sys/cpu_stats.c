@@ -0,0 +1,12 @@
+#include <zos/sched.h>
+
+#include <arch/syscall.h>
+
+int cpu_stats(struct sched_cpu_stats *stats, int count)
+{
+    int ret;
+
+    SYSCALL2(SYS_CPU_STATS, stats, count, ret);
+
+    return ret;
+}
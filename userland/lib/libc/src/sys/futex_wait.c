@@ -0,0 +1,12 @@
+#include <zos/futex.h>
+
+#include <arch/syscall.h>
+
+int futex_wait(volatile int *addr, int val, size_t timeout)
+{
+    int ret;
+
+    SYSCALL3(SYS_FUTEX_WAIT, addr, val, timeout, ret);
+
+    return ret;
+}
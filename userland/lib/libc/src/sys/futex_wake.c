@@ -0,0 +1,12 @@
+#include <zos/futex.h>
+
+#include <arch/syscall.h>
+
+int futex_wake(volatile int *addr, int count)
+{
+    int ret;
+
+    SYSCALL2(SYS_FUTEX_WAKE, addr, count, ret);
+
+    return ret;
+}
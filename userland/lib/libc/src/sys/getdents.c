@@ -0,0 +1,12 @@
+#include <dirent.h>
+
+#include <arch/syscall.h>
+
+int getdents(int fd, void *buf, size_t size, uint32_t *cookie, int flags)
+{
+    int ret;
+
+    SYSCALL5(SYS_GETDENTS, fd, buf, size, cookie, flags, ret);
+
+    return ret;
+}
@@ -1,12 +1,8 @@
 #include <unistd.h>
 
-#include <arch/syscall.h>
+#include <zos/info.h>
 
 pid_t getpid(void)
 {
-    pid_t pid;
-
-    SYSCALL0(SYS_GETPID, pid);
-
-    return pid;
+    return zos_info()->pid;
 }
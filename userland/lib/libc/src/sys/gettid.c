@@ -1,12 +1,8 @@
 #include <unistd.h>
 
-#include <arch/syscall.h>
+#include <zos/info.h>
 
 pid_t gettid(void)
 {
-    pid_t tid;
-
-    SYSCALL0(SYS_GETTID, tid);
-
-    return tid;
+    return zos_info()->tid;
 }
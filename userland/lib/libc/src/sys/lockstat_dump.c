@@ -0,0 +1,12 @@
+#include <zos/print.h>
+
+#include <arch/syscall.h>
+
+int lockstat_dump(void)
+{
+    int ret;
+
+    SYSCALL0(SYS_LOCKSTAT_DUMP, ret);
+
+    return ret;
+}
@@ -0,0 +1,12 @@
+#include <zos/poll.h>
+
+#include <arch/syscall.h>
+
+int poll_create(void)
+{
+    int ret;
+
+    SYSCALL0(SYS_POLL_CREATE, ret);
+
+    return ret;
+}
@@ -0,0 +1,12 @@
+#include <zos/poll.h>
+
+#include <arch/syscall.h>
+
+int poll_ctl(int fd, int op, int type, int id, struct poll_event *event)
+{
+    int ret;
+
+    SYSCALL5(SYS_POLL_CTL, fd, op, type, id, event, ret);
+
+    return ret;
+}
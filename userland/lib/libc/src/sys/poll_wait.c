@@ -0,0 +1,12 @@
+#include <zos/poll.h>
+
+#include <arch/syscall.h>
+
+int poll_wait(int fd, struct poll_event *events, int max, int block)
+{
+    int ret;
+
+    SYSCALL4(SYS_POLL_WAIT, fd, events, max, block, ret);
+
+    return ret;
+}
@@ -0,0 +1,65 @@
+#include <zos/sched.h>
+
+int sched_setnice(int tid, int nice)
+{
+    struct sched_attr attr;
+    int ret;
+
+    if ((ret = sched_getattr(tid, &attr)) < 0)
+        return ret;
+
+    attr.nice = nice;
+
+    return sched_setattr(tid, &attr);
+}
+
+int sched_getnice(int tid)
+{
+    struct sched_attr attr;
+    int ret;
+
+    if ((ret = sched_getattr(tid, &attr)) < 0)
+        return ret;
+
+    return attr.nice;
+}
+
+int sched_setpolicy(int tid, int policy, int rt_priority)
+{
+    struct sched_attr attr;
+    int ret;
+
+    if ((ret = sched_getattr(tid, &attr)) < 0)
+        return ret;
+
+    attr.policy = policy;
+    attr.rt_priority = rt_priority;
+
+    return sched_setattr(tid, &attr);
+}
+
+int sched_setaffinity(int tid, uint32_t affinity)
+{
+    struct sched_attr attr;
+    int ret;
+
+    if ((ret = sched_getattr(tid, &attr)) < 0)
+        return ret;
+
+    attr.affinity = affinity;
+
+    return sched_setattr(tid, &attr);
+}
+
+int sched_getaffinity(int tid, uint32_t *affinity)
+{
+    struct sched_attr attr;
+    int ret;
+
+    if ((ret = sched_getattr(tid, &attr)) < 0)
+        return ret;
+
+    *affinity = attr.affinity;
+
+    return 0;
+}
@@ -0,0 +1,12 @@
+#include <zos/sched.h>
+
+#include <arch/syscall.h>
+
+int sched_setattr(int tid, const struct sched_attr *attr)
+{
+    int ret;
+
+    SYSCALL2(SYS_SCHED_SETATTR, tid, attr, ret);
+
+    return ret;
+}
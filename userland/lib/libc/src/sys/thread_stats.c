@@ -0,0 +1,12 @@
+#include <zos/sched.h>
+
+#include <arch/syscall.h>
+
+int thread_stats(struct sched_thread_info *info, int count)
+{
+    int ret;
+
+    SYSCALL2(SYS_THREAD_STATS, info, count, ret);
+
+    return ret;
+}
@@ -0,0 +1,11 @@
+#include <zos/info.h>
+
+uint32_t ticks_get(void)
+{
+    return zos_info()->ticks;
+}
+
+uint32_t ticks_per_sec(void)
+{
+    return zos_info()->tick_per_sec;
+}
@@ -0,0 +1,49 @@
+#include <thread.h>
+
+#include <zos/futex.h>
+
+#include <sys/atomic.h>
+
+# define COND_WAKE_ALL 0x7FFFFFFF
+
+void cond_init(cond_t *cond)
+{
+    cond->seq = 0;
+}
+
+void cond_wait(cond_t *cond, mutex_t *mutex)
+{
+    cond_timedwait(cond, mutex, 0);
+}
+
+int cond_timedwait(cond_t *cond, mutex_t *mutex, size_t timeout)
+{
+    int ret;
+    int seq = cond->seq;
+
+    mutex_unlock(mutex);
+
+    /* A signal sent after the unlock changes seq, so it cannot be lost */
+    ret = futex_wait(&cond->seq, seq, timeout);
+
+    mutex_lock(mutex);
+
+    if (ret == FUTEX_ETIMEDOUT)
+        return -1;
+
+    return 0;
+}
+
+void cond_signal(cond_t *cond)
+{
+    atomic_add(&cond->seq, 1);
+
+    futex_wake(&cond->seq, 1);
+}
+
+void cond_broadcast(cond_t *cond)
+{
+    atomic_add(&cond->seq, 1);
+
+    futex_wake(&cond->seq, COND_WAKE_ALL);
+}
@@ -0,0 +1,51 @@
+#include <thread.h>
+
+#include <zos/futex.h>
+
+#include <sys/atomic.h>
+
+# define MUTEX_UNLOCKED 0
+# define MUTEX_LOCKED 1
+# define MUTEX_CONTENDED 2
+
+void mutex_init(mutex_t *mutex)
+{
+    mutex->state = MUTEX_UNLOCKED;
+}
+
+void mutex_lock(mutex_t *mutex)
+{
+    int state;
+
+    /* Fast path: no syscall when the mutex is free */
+    state = atomic_cmpxchg(&mutex->state, MUTEX_UNLOCKED, MUTEX_LOCKED);
+    if (state == MUTEX_UNLOCKED)
+        return;
+
+    /*
+     * Mark the mutex as contended so that the owner wakes us up when it
+     * unlocks it, then sleep until we manage to take it
+     */
+    if (state != MUTEX_CONTENDED)
+        state = atomic_xchg(&mutex->state, MUTEX_CONTENDED);
+
+    while (state != MUTEX_UNLOCKED) {
+        futex_wait(&mutex->state, MUTEX_CONTENDED, 0);
+        state = atomic_xchg(&mutex->state, MUTEX_CONTENDED);
+    }
+}
+
+int mutex_trylock(mutex_t *mutex)
+{
+    if (atomic_cmpxchg(&mutex->state, MUTEX_UNLOCKED, MUTEX_LOCKED) !=
+        MUTEX_UNLOCKED)
+        return -1;
+
+    return 0;
+}
+
+void mutex_unlock(mutex_t *mutex)
+{
+    if (atomic_xchg(&mutex->state, MUTEX_UNLOCKED) == MUTEX_CONTENDED)
+        futex_wake(&mutex->state, 1);
+}
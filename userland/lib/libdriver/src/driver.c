@@ -46,6 +46,10 @@ int driver_create(const char *dev_name, int perm, struct driver_ops *dev_ops,
     if (dev_ops->ioctl != NULL)
         result->ops |= VFS_OPS_IOCTL;
 
+    /* Payloads are only accessed through req->data, a ring is transparent */
+    if (result->ops & (VFS_OPS_READ | VFS_OPS_WRITE))
+        result->ops |= VFS_OPS_RING;
+
     result->dev_name = malloc(strlen(dev_name) + 1);
     if (!result->dev_name)
         /* XXX: ENOMEM */
@@ -71,80 +75,69 @@ int driver_create(const char *dev_name, int perm, struct driver_ops *dev_ops,
     return 0;
 }
 
-static void dispatch(struct driver *driver, char *buf)
+/* Every reply a driver can send */
+union driver_resp {
+    struct resp_open open;
+    struct resp_rdwr rdwr;
+    struct resp_close close;
+    struct resp_ioctl ioctl;
+};
+
+/*
+ * Handle a request, return the size of the reply stored in resp or 0 when
+ * the driver answers later
+ */
+static size_t dispatch(struct driver *driver, char *buf,
+                       union driver_resp *resp)
 {
     struct msg_header *hdr = (void *) buf;
 
     switch (hdr->op)
     {
         case VFS_OPEN:
-            {
-                struct resp_open resp;
-
-                resp.ret = driver->dev_ops->open(driver, (void *)buf,
-                                                 &resp.inode);
-                if (resp.ret == DRV_NORESPONSE)
-                    break;
+            resp->open.ret = driver->dev_ops->open(driver, (void *)buf,
+                                                   &resp->open.inode);
+            if (resp->open.ret == DRV_NORESPONSE)
+                return 0;
 
-                resp.hdr.slave_id = hdr->slave_id;
+            resp->open.hdr.slave_id = hdr->slave_id;
 
-                write(driver->channel_fd, &resp, sizeof (resp));
-            }
-            break;
+            return sizeof (resp->open);
         case VFS_READ:
-            {
-                struct resp_rdwr resp;
-
-                resp.ret = driver->dev_ops->read(driver, (void *)buf,
-                                                 &resp.size);
-                if (resp.ret == DRV_NORESPONSE)
-                    break;
+            resp->rdwr.ret = driver->dev_ops->read(driver, (void *)buf,
+                                                   &resp->rdwr.size);
+            if (resp->rdwr.ret == DRV_NORESPONSE)
+                return 0;
 
-                resp.hdr.slave_id = hdr->slave_id;
+            resp->rdwr.hdr.slave_id = hdr->slave_id;
 
-                write(driver->channel_fd, &resp, sizeof (resp));
-            }
-            break;
+            return sizeof (resp->rdwr);
         case VFS_WRITE:
-            {
-                struct resp_rdwr resp;
-
-                resp.ret = driver->dev_ops->write(driver, (void *)buf,
-                                                  &resp.size);
-                if (resp.ret == DRV_NORESPONSE)
-                    break;
+            resp->rdwr.ret = driver->dev_ops->write(driver, (void *)buf,
+                                                    &resp->rdwr.size);
+            if (resp->rdwr.ret == DRV_NORESPONSE)
+                return 0;
 
-                resp.hdr.slave_id = hdr->slave_id;
+            resp->rdwr.hdr.slave_id = hdr->slave_id;
 
-                write(driver->channel_fd, &resp, sizeof (resp));
-            }
-            break;
+            return sizeof (resp->rdwr);
         case VFS_CLOSE:
-            {
-                struct resp_close resp;
+            resp->close.ret = driver->dev_ops->close(driver, (void *)buf);
+            if (resp->close.ret == DRV_NORESPONSE)
+                return 0;
 
-                resp.ret = driver->dev_ops->close(driver, (void *)buf);
-                if (resp.ret == DRV_NORESPONSE)
-                    break;
+            resp->close.hdr.slave_id = hdr->slave_id;
 
-                resp.hdr.slave_id = hdr->slave_id;
-
-                write(driver->channel_fd, &resp, sizeof (resp));
-            }
-            break;
+            return sizeof (resp->close);
         case VFS_IOCTL:
-            {
-                struct resp_ioctl resp;
+            resp->ioctl.ret = driver->dev_ops->ioctl(driver, (void *)buf,
+                                                     &resp->ioctl);
+            if (resp->ioctl.ret == DRV_NORESPONSE)
+                return 0;
 
-                resp.ret = driver->dev_ops->ioctl(driver, (void *)buf, &resp);
-                if (resp.ret == DRV_NORESPONSE)
-                    break;
+            resp->ioctl.hdr.slave_id = hdr->slave_id;
 
-                resp.hdr.slave_id = hdr->slave_id;
-
-                write(driver->channel_fd, &resp, sizeof (resp));
-            }
-            break;
+            return sizeof (resp->ioctl);
         default:
             {
                 char tmp[100];
@@ -153,31 +146,103 @@ static void dispatch(struct driver *driver, char *buf)
 
                 uprint(tmp);
             }
-            break;
+            return 0;
     }
 }
 
+/* Number of requests handled per system call by driver_loop() */
+#define DRIVER_BATCH 8
+
+#define DRIVER_REQ_SIZE 255
+
 int driver_loop(struct driver *driver)
 {
     int ret;
-    char *buf = malloc(255);
+    int nreply = 0;
+    union driver_resp resp[DRIVER_BATCH];
+    struct channel_iovec replies[DRIVER_BATCH];
+    struct channel_iovec msgs[DRIVER_BATCH];
+    char *buf = malloc(DRIVER_BATCH * DRIVER_REQ_SIZE);
 
     if (!buf)
         return 1;
 
     while (driver->running)
     {
-        ret = read(driver->channel_fd, buf, 255);
+        for (int i = 0; i < DRIVER_BATCH; ++i) {
+            msgs[i].buf = buf + i * DRIVER_REQ_SIZE;
+            msgs[i].size = DRIVER_REQ_SIZE;
+        }
+
+        /*
+         * Reply to the previous requests and take all the pending ones at
+         * once
+         */
+        ret = channel_reply_wait_batch(driver->channel_fd, replies, nreply,
+                                       msgs, DRIVER_BATCH);
+        nreply = 0;
         if (ret < 0) {
             uprint("Unexpected error in driver_loop()");
             driver->running = 0;
             continue;
         }
 
-        dispatch(driver, buf);
+        for (int i = 0; i < ret; ++i) {
+            size_t size = dispatch(driver, msgs[i].buf, &resp[nreply]);
+
+            if (!size)
+                continue;
+
+            replies[nreply].buf = &resp[nreply];
+            replies[nreply].size = size;
+            ++nreply;
+        }
     }
 
     free(buf);
 
     return 0;
 }
+
+int driver_handle(struct driver *driver)
+{
+    int ret;
+    size_t size;
+    union driver_resp resp;
+    struct channel_iovec msgs[DRIVER_BATCH];
+    char buf[DRIVER_BATCH * DRIVER_REQ_SIZE];
+
+    for (int i = 0; i < DRIVER_BATCH; ++i) {
+        msgs[i].buf = buf + i * DRIVER_REQ_SIZE;
+        msgs[i].size = DRIVER_REQ_SIZE;
+    }
+
+    ret = channel_reply_wait_batch(driver->channel_fd, NULL, 0, msgs,
+                                   DRIVER_BATCH);
+    if (ret < 0)
+        return ret;
+
+    for (int i = 0; i < ret; ++i) {
+        size = dispatch(driver, msgs[i].buf, &resp);
+        if (size)
+            write(driver->channel_fd, &resp, size);
+    }
+
+    return 0;
+}
+
+int driver_ready(struct driver *driver, uint32_t events)
+{
+    int ret;
+    struct req_ready req;
+
+    req.hdr.op = VFS_READY;
+    req.hdr.slave_id = CHANNEL_CONTROL_ID;
+    req.events = events;
+
+    ret = write(driver->channel_fd, &req, sizeof (req));
+    if (ret < 0)
+        return ret;
+
+    return 0;
+}
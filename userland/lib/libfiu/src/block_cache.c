@@ -33,7 +33,7 @@ int fiu_cache_initialize(struct fiu_instance *fi, size_t cache_size,
 
     fi->block_cache->blocks_tail = NULL;
 
-    spinlock_init(&fi->block_cache->cache_lock);
+    mutex_init(&fi->block_cache->cache_lock);
 
     block = fi->block_cache->blocks_head;
 
@@ -58,14 +58,14 @@ void *fiu_cache_request(struct fiu_instance *fi, uint32_t block)
     struct fiu_block *free = NULL;
     struct fiu_block *fblock;
 
-    spinlock_lock(&fi->block_cache->cache_lock);
+    mutex_lock(&fi->block_cache->cache_lock);
 
     fblock = fi->block_cache->blocks_head;
 
     for (size_t i = 0; i < fi->block_cache->cache_size; ++i) {
         if (fblock->block_num == block) {
             ++fblock->ref_count;
-            spinlock_unlock(&fi->block_cache->cache_lock);
+            mutex_unlock(&fi->block_cache->cache_lock);
             return fblock->block;
         }
 
@@ -76,19 +76,19 @@ void *fiu_cache_request(struct fiu_instance *fi, uint32_t block)
     }
 
     if (!free) {
-        spinlock_unlock(&fi->block_cache->cache_lock);
+        mutex_unlock(&fi->block_cache->cache_lock);
         return NULL;
     }
 
     if (fi->block_cache->fetch(fi, free->block, block) < 0) {
-        spinlock_unlock(&fi->block_cache->cache_lock);
+        mutex_unlock(&fi->block_cache->cache_lock);
         return NULL;
     }
 
     free->block_num = block;
     free->ref_count = 1;
 
-    spinlock_unlock(&fi->block_cache->cache_lock);
+    mutex_unlock(&fi->block_cache->cache_lock);
 
     return free->block;
 }
@@ -119,7 +119,7 @@ void fiu_cache_release(struct fiu_instance *fi, uint32_t block)
 {
     struct fiu_block *fblock;
 
-    spinlock_lock(&fi->block_cache->cache_lock);
+    mutex_lock(&fi->block_cache->cache_lock);
 
     fblock = fi->block_cache->blocks_head;
 
@@ -130,7 +130,7 @@ void fiu_cache_release(struct fiu_instance *fi, uint32_t block)
             if (fblock->ref_count == 0)
                 fiu_cache_put_back(fi, fblock);
 
-            spinlock_unlock(&fi->block_cache->cache_lock);
+            mutex_unlock(&fi->block_cache->cache_lock);
 
             return;
         }
@@ -138,5 +138,5 @@ void fiu_cache_release(struct fiu_instance *fi, uint32_t block)
         fblock = fblock->next;
     }
 
-    spinlock_unlock(&fi->block_cache->cache_lock);
+    mutex_unlock(&fi->block_cache->cache_lock);
 }
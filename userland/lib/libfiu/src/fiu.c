@@ -13,6 +13,9 @@
 
 #define BUF_SIZE 256
 
+/* Number of requests handled per system call by the slave loop */
+#define FIU_BATCH 8
+
 static int fiu_capabilities(struct fiu_fs *fs)
 {
     /* Lookup/Create/Open/Close are mandatory operations */
@@ -29,12 +32,20 @@ static int fiu_capabilities(struct fiu_fs *fs)
     if (fs->ops->mount)
         fs->cap |= VFS_OPS_MOUNT;
 
+    /* Payloads are only accessed through req->data, a ring is transparent */
     if (fs->ops->read)
-        fs->cap |= VFS_OPS_READ;
+        fs->cap |= VFS_OPS_READ | VFS_OPS_RING;
 
     if (fs->ops->getdirent)
         fs->cap |= VFS_OPS_GETDIRENT;
 
+    /* Without a native getdents, it is emulated with getdirent */
+    if (fs->ops->getdents || fs->ops->getdirent)
+        fs->cap |= VFS_OPS_GETDENTS;
+
+    if (fs->ops->read && fs->cache_data)
+        fs->cap |= VFS_OPS_CACHE;
+
     return 0;
 }
 
@@ -46,89 +57,142 @@ void fiu_help(const char *bin_name, FILE *output)
     fprintf(output, "  -d / --daemon : Daemonize the master file system\n");
 }
 
-static void fiu_dispatch(struct fiu_instance *fi, void *buf)
+/* Every reply of a file system instance */
+union fiu_resp {
+    struct resp_lookup lookup;
+    struct resp_stat stat;
+    struct resp_mount mount;
+    struct resp_open open;
+    struct resp_rdwr rdwr;
+    struct resp_getdirent getdirent;
+    struct resp_getdents getdents;
+    struct resp_close close;
+};
+
+/*
+ * Getdents for a driver that only knows getdirent, the cookie is the index of
+ * the next entry
+ */
+static int fiu_getdents_from_getdirent(struct fiu_instance *fi,
+                                       struct req_getdents *req,
+                                       uint32_t *cookie)
 {
-    struct msg_header *hdr = buf;
+    int ret;
+    int n;
+    size_t rec_size;
+    struct dirent_plus *rec;
+    struct req_getdirent dirent_req;
+    struct req_stat stat_req;
+    struct fiu_ops *ops = fi->parent->ops;
 
-    switch (hdr->op) {
-        case VFS_LOOKUP:
-            {
-                struct resp_lookup resp;
+    if (req->flags & GETDENTS_STAT)
+        rec_size = sizeof (struct dirent_plus);
+    else
+        rec_size = sizeof (struct dirent);
 
-                resp.ret = fi->parent->ops->lookup(fi, (void *)buf, &resp);
+    dirent_req.hdr = req->hdr;
+    dirent_req.inode = req->inode;
 
-                resp.hdr.slave_id = hdr->slave_id;
+    stat_req.hdr = req->hdr;
+    stat_req.uid = req->uid;
+    stat_req.gid = req->gid;
 
-                write(fi->channel_fd, &resp, sizeof (resp));
-            }
-            break;
-        case VFS_STAT:
-            {
-                struct resp_stat resp;
+    for (n = 0; n < req->count; ++n) {
+        rec = (void *)((char *)req->data + n * rec_size);
 
-                resp.ret = fi->parent->ops->stat(fi, (void *)buf, &resp.stat);
+        dirent_req.index = *cookie;
 
-                resp.hdr.slave_id = hdr->slave_id;
+        ret = ops->getdirent(fi, &dirent_req, &rec->d);
+        if (ret < 0)
+            return n ? n : ret;
 
-                write(fi->channel_fd, &resp, sizeof (resp));
-            }
+        if (ret == DIR_END)
             break;
-        case VFS_MOUNT:
-            {
-                struct resp_mount resp;
 
-                resp.ret = fi->parent->ops->mount(fi, (void *)buf);
+        ++*cookie;
 
-                resp.hdr.slave_id = hdr->slave_id;
+        if (!(req->flags & GETDENTS_STAT))
+            continue;
 
-                write(fi->channel_fd, &resp, sizeof (resp));
-            }
-            break;
-        case VFS_OPEN:
-            {
-                struct resp_open resp;
+        stat_req.inode = rec->d.d_ino;
 
-                resp.ret = fi->parent->ops->open(fi, (void *)buf, &resp);
+        if (!ops->stat || ops->stat(fi, &stat_req, &rec->st) < 0)
+            memset(&rec->st, 0, sizeof (struct stat));
+    }
 
-                resp.hdr.slave_id = hdr->slave_id;
+    return n;
+}
 
-                write(fi->channel_fd, &resp, sizeof (resp));
-            }
-            break;
-        case VFS_READ:
-            {
-                struct resp_rdwr resp;
+/*
+ * Handle a request, return the size of the reply stored in resp
+ */
+static size_t fiu_dispatch(struct fiu_instance *fi, void *buf,
+                           union fiu_resp *resp)
+{
+    struct msg_header *hdr = buf;
 
-                resp.ret = fi->parent->ops->read(fi, (void *)buf, &resp.size);
+    switch (hdr->op) {
+        case VFS_LOOKUP:
+            resp->lookup.ret = fi->parent->ops->lookup(fi, (void *)buf,
+                                                       &resp->lookup);
+            resp->lookup.hdr.slave_id = hdr->slave_id;
 
-                resp.hdr.slave_id = hdr->slave_id;
+            return sizeof (resp->lookup);
+        case VFS_STAT:
+            resp->stat.ret = fi->parent->ops->stat(fi, (void *)buf,
+                                                   &resp->stat.stat);
+            resp->stat.lease = fi->parent->stat_lease;
+            resp->stat.hdr.slave_id = hdr->slave_id;
 
-                write(fi->channel_fd, &resp, sizeof (resp));
-            }
-            break;
-        case VFS_GETDIRENT:
-            {
-                struct resp_getdirent resp;
+            return sizeof (resp->stat);
+        case VFS_MOUNT:
+            resp->mount.ret = fi->parent->ops->mount(fi, (void *)buf);
+            resp->mount.hdr.slave_id = hdr->slave_id;
 
-                resp.ret = fi->parent->ops->getdirent(fi, (void *)buf,
-                                                      &resp.dirent);
+            return sizeof (resp->mount);
+        case VFS_OPEN:
+            resp->open.ret = fi->parent->ops->open(fi, (void *)buf,
+                                                   &resp->open);
+            resp->open.hdr.slave_id = hdr->slave_id;
 
-                resp.hdr.slave_id = hdr->slave_id;
+            return sizeof (resp->open);
+        case VFS_READ:
+            resp->rdwr.ret = fi->parent->ops->read(fi, (void *)buf,
+                                                   &resp->rdwr.size);
+            resp->rdwr.hdr.slave_id = hdr->slave_id;
 
-                write(fi->channel_fd, &resp, sizeof (resp));
-            }
-            break;
-        case VFS_CLOSE:
-            {
-                struct resp_close resp;
+            return sizeof (resp->rdwr);
+        case VFS_GETDIRENT:
+            resp->getdirent.ret =
+                fi->parent->ops->getdirent(fi, (void *)buf,
+                                           &resp->getdirent.dirent);
+            resp->getdirent.hdr.slave_id = hdr->slave_id;
 
-                resp.ret = fi->parent->ops->close(fi, (void *)buf);
+            return sizeof (resp->getdirent);
+        case VFS_GETDENTS:
+            {
+                struct req_getdents *req = (void *)buf;
+
+                resp->getdents.cookie = req->cookie;
+
+                if (fi->parent->ops->getdents)
+                    resp->getdents.ret =
+                        fi->parent->ops->getdents(fi, req,
+                                                  &resp->getdents.cookie);
+                else
+                    resp->getdents.ret =
+                        fiu_getdents_from_getdirent(fi, req,
+                                                    &resp->getdents.cookie);
+            }
+            resp->getdents.lease = fi->parent->stat_lease;
+            resp->getdents.hdr.slave_id = hdr->slave_id;
 
-                resp.hdr.slave_id = hdr->slave_id;
+            return sizeof (resp->getdents);
+        case VFS_CLOSE:
+            resp->close.ret = fi->parent->ops->close(fi, (void *)buf);
+            resp->close.hdr.slave_id = hdr->slave_id;
 
-                write(fi->channel_fd, &resp, sizeof (resp));
-            }
-            break;
+            return sizeof (resp->close);
         default:
             {
                 char tmp[100];
@@ -138,27 +202,57 @@ static void fiu_dispatch(struct fiu_instance *fi, void *buf)
 
                 uprint(tmp);
             }
-            break;
+            return 0;
     }
 }
 
 static int fiu_slave_loop(struct fiu_instance *fi)
 {
     int ret;
+    int nreply = 0;
     char *buf;
+    union fiu_resp *resp;
+    struct channel_iovec replies[FIU_BATCH];
+    struct channel_iovec msgs[FIU_BATCH];
 
-    buf = malloc(BUF_SIZE);
+    buf = malloc(FIU_BATCH * BUF_SIZE);
     if (!buf)
         return -1;
 
+    resp = malloc(FIU_BATCH * sizeof (union fiu_resp));
+    if (!resp) {
+        free(buf);
+        return -1;
+    }
+
     for (;;) {
-        ret = read(fi->channel_fd, buf, BUF_SIZE);
+        for (int i = 0; i < FIU_BATCH; ++i) {
+            msgs[i].buf = buf + i * BUF_SIZE;
+            msgs[i].size = BUF_SIZE;
+        }
+
+        /*
+         * Reply to the previous requests and take all the pending ones at
+         * once
+         */
+        ret = channel_reply_wait_batch(fi->channel_fd, replies, nreply, msgs,
+                                       FIU_BATCH);
+        nreply = 0;
         if (ret < 0) {
             uprint("FIU: Slave loop: Read error");
             continue;
         }
 
-        fiu_dispatch(fi, buf);
+        for (int i = 0; i < ret; ++i) {
+            size_t size = fiu_dispatch(fi, msgs[i].buf, &resp[nreply]);
+
+            if (!size)
+                continue;
+
+            replies[nreply].buf = &resp[nreply];
+            replies[nreply].size = size;
+            ++nreply;
+        }
     }
 
     exit(4);
@@ -205,6 +299,41 @@ int fiu_slave_main(struct fiu_instance *fi, const char *device,
     return fiu_slave_loop(fi);
 }
 
+int fiu_invalidate(struct fiu_instance *fi, ino_t inode)
+{
+    int ret;
+    struct req_invalidate req;
+
+    req.hdr.op = VFS_INVALIDATE;
+    req.hdr.slave_id = CHANNEL_CONTROL_ID;
+    req.inode = inode;
+
+    ret = write(fi->channel_fd, &req, sizeof (req));
+    if (ret < 0)
+        return ret;
+
+    return 0;
+}
+
+int fiu_invalidate_data(struct fiu_instance *fi, ino_t inode, uint64_t off,
+                        uint64_t size)
+{
+    int ret;
+    struct req_invalidate_data req;
+
+    req.hdr.op = VFS_INVALIDATE_DATA;
+    req.hdr.slave_id = CHANNEL_CONTROL_ID;
+    req.inode = inode;
+    req.off = off;
+    req.size = size;
+
+    ret = write(fi->channel_fd, &req, sizeof (req));
+    if (ret < 0)
+        return ret;
+
+    return 0;
+}
+
 static int fiu_master_loop(struct fiu_fs *fs)
 {
     int ret;